@@ -0,0 +1,199 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "trie.h"
+
+/*
+ * Aho-Corasick automaton compiled from a Trie with trie_build_matcher().
+ *
+ * Each trie node becomes a state with a full row of TRIE_ALPHABET
+ * transitions, with failure links already folded in, so scanning costs one
+ * table load per input byte and never backtracks. With a 26-letter alphabet
+ * a dense row (104 bytes) is smaller than the TrieNode it replaces, so every
+ * state gets one rather than only the hot ones.
+ *
+ * Text is folded with trie_idx(): letters match case-insensitively and any
+ * other byte returns the automaton to its start state, so a pattern only
+ * matches inside a run of letters. Matching is streamed through an AcStream
+ * that carries the state and absolute offset across chunks.
+ */
+
+typedef struct AcMatcher {
+    int32_t (*next)[TRIE_ALPHABET];
+    int32_t *output;    /* first state on the failure chain ending a pattern, or -1 */
+    int32_t *dict;      /* for pattern states: the next such state down the chain */
+    uint32_t *depth;    /* pattern length of each state */
+    void **value;
+    size_t nstates;
+    size_t npatterns;
+    int8_t byte_map[256];
+} AcMatcher;
+
+typedef struct AcStream {
+    const AcMatcher *m;
+    int32_t state;
+    size_t offset;      /* bytes consumed so far */
+} AcStream;
+
+/*
+ * Called for every occurrence; `start` is the absolute offset of its first
+ * byte in the stream. Return false to stop scanning.
+ */
+typedef bool (*ac_match_fn)(size_t start, size_t len, void *value, void *user);
+
+static inline void ac_matcher_destroy(AcMatcher *m) {
+    if (!m) return;
+    free(m->next);
+    free(m->output);
+    free(m->dict);
+    free(m->depth);
+    free(m->value);
+    free(m);
+}
+
+/* Builds the automaton for every word in `t`. The trie is not modified. */
+static inline AcMatcher *trie_build_matcher(const Trie *t) {
+    if (!t) return NULL;
+
+    /* Breadth-first numbering; BFS order is also the order failure links need. */
+    size_t cap = 1024, n = 0;
+    const TrieNode **nodes = (const TrieNode **)malloc(cap * sizeof(*nodes));
+    if (!nodes) return NULL;
+    nodes[n++] = t->root;
+    for (size_t i = 0; i < n; ++i) {
+        for (int c = 0; c < TRIE_ALPHABET; ++c) {
+            if (!nodes[i]->child[c]) continue;
+            if (n == cap) {
+                cap *= 2;
+                const TrieNode **grown = (const TrieNode **)realloc(nodes, cap * sizeof(*nodes));
+                if (!grown) { free(nodes); return NULL; }
+                nodes = grown;
+            }
+            nodes[n++] = nodes[i]->child[c];
+        }
+    }
+
+    AcMatcher *m = (AcMatcher *)calloc(1, sizeof(AcMatcher));
+    int32_t *fail = (int32_t *)malloc(n * sizeof(int32_t));
+    if (!m || !fail) goto fail;
+    m->nstates = n;
+    m->next = (int32_t (*)[TRIE_ALPHABET])malloc(n * sizeof(*m->next));
+    m->output = (int32_t *)malloc(n * sizeof(int32_t));
+    m->dict = (int32_t *)malloc(n * sizeof(int32_t));
+    m->depth = (uint32_t *)malloc(n * sizeof(uint32_t));
+    m->value = (void **)malloc(n * sizeof(void *));
+    if (!m->next || !m->output || !m->dict || !m->depth || !m->value) goto fail;
+    for (int b = 0; b < 256; ++b) m->byte_map[b] = (int8_t)trie_idx((char)b);
+
+    /* Children of state i were appended consecutively, so ids follow. */
+    m->depth[0] = 0;
+    for (size_t i = 0, id = 1; i < n; ++i) {
+        const TrieNode *node = nodes[i];
+        m->value[i] = node->terminal ? node->value : NULL;
+        m->npatterns += node->terminal;
+        for (int c = 0; c < TRIE_ALPHABET; ++c) {
+            if (node->child[c]) {
+                m->depth[id] = m->depth[i] + 1;
+                m->next[i][c] = (int32_t)id++;
+            } else {
+                m->next[i][c] = -1;
+            }
+        }
+    }
+
+    /* The empty word is never reported. */
+    fail[0] = 0;
+    m->output[0] = -1;
+    m->dict[0] = -1;
+    for (int c = 0; c < TRIE_ALPHABET; ++c) {
+        int32_t s = m->next[0][c];
+        if (s < 0) m->next[0][c] = 0;
+        else fail[s] = 0;
+    }
+    for (size_t i = 1; i < n; ++i) {
+        /* fail[i] is final here: it was set while processing i's parent. */
+        int32_t f = fail[i];
+        int32_t below = m->output[f];
+        m->dict[i] = below;
+        m->output[i] = nodes[i]->terminal ? (int32_t)i : below;
+        for (int c = 0; c < TRIE_ALPHABET; ++c) {
+            int32_t s = m->next[i][c];
+            if (s < 0) m->next[i][c] = m->next[f][c];
+            else fail[s] = m->next[f][c];
+        }
+    }
+    free(fail);
+    free(nodes);
+    return m;
+
+fail:
+    free(fail);
+    free(nodes);
+    ac_matcher_destroy(m);
+    return NULL;
+}
+
+static inline void ac_stream_init(AcStream *s, const AcMatcher *m) {
+    s->m = m;
+    s->state = 0;
+    s->offset = 0;
+}
+
+/*
+ * Feeds the next chunk of the stream. A match that straddles the previous
+ * chunk is reported here with its original start offset. Returns false if
+ * the callback stopped the scan.
+ */
+static inline bool ac_stream_match(AcStream *s, const void *buf, size_t len,
+                                   ac_match_fn cb, void *user) {
+    const AcMatcher *m = s->m;
+    const unsigned char *p = (const unsigned char *)buf;
+    int32_t state = s->state;
+    for (size_t i = 0; i < len; ++i) {
+        int c = m->byte_map[p[i]];
+        state = c < 0 ? 0 : m->next[state][c];
+        for (int32_t o = m->output[state]; o >= 0; o = m->dict[o]) {
+            size_t end = s->offset + i + 1;
+            if (cb && !cb(end - m->depth[o], m->depth[o], m->value[o], user)) {
+                s->state = state;
+                s->offset += i + 1;
+                return false;
+            }
+        }
+    }
+    s->state = state;
+    s->offset += len;
+    return true;
+}
+
+#endif
@@ -0,0 +1,801 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef ART_H
+#define ART_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Adaptive Radix Tree (Leis et al.) keyed by arbitrary byte strings with an
+ * explicit length, so embedded NULs, digits and UTF-8 are all distinct keys.
+ *
+ * Inner nodes come in four sizes (4, 16, 48 and 256 children) and grow or
+ * shrink as children are added and removed. A key that is the only one below
+ * some point is stored as a single leaf instead of a chain of nodes (lazy
+ * expansion), and runs of bytes shared by a whole subtree are kept as a node
+ * prefix (path compression). Only the first ART_MAX_PREFIX prefix bytes are
+ * stored; lookups skip the rest and verify against the leaf.
+ *
+ * A key that ends exactly where an inner node begins branching is kept in that
+ * node's `leaf` slot, so "ab" and "abc" can both be stored.
+ */
+
+#ifndef ART_MAX_PREFIX
+#define ART_MAX_PREFIX 10
+#endif
+
+typedef void (*art_free_fn)(void *p);
+
+/* Called in key order; return false to stop the scan. */
+typedef bool (*art_visit_fn)(const unsigned char *key, size_t len, void *value, void *user);
+
+enum { ART_NODE4, ART_NODE16, ART_NODE48, ART_NODE256 };
+
+typedef struct ArtLeaf {
+    void *value;
+    size_t len;
+    unsigned char key[];
+} ArtLeaf;
+
+typedef struct ArtNode {
+    uint8_t type;
+    uint16_t num_children;
+    uint32_t partial_len;               /* full prefix length, may exceed ART_MAX_PREFIX */
+    unsigned char partial[ART_MAX_PREFIX];
+    ArtLeaf *leaf;                      /* key ending at this node, if any */
+} ArtNode;
+
+typedef struct ArtNode4 {
+    ArtNode n;
+    unsigned char keys[4];
+    void *children[4];
+} ArtNode4;
+
+typedef struct ArtNode16 {
+    ArtNode n;
+    unsigned char keys[16];
+    void *children[16];
+} ArtNode16;
+
+typedef struct ArtNode48 {
+    ArtNode n;
+    unsigned char index[256];           /* slot + 1, or 0 if absent */
+    void *children[48];
+} ArtNode48;
+
+typedef struct ArtNode256 {
+    ArtNode n;
+    void *children[256];
+} ArtNode256;
+
+typedef struct ArtTree {
+    void *root;                         /* ArtNode* or tagged ArtLeaf* */
+    art_free_fn free_value;
+    size_t size;
+} ArtTree;
+
+/* Child slots hold either an inner node or a leaf tagged in the low bit. */
+#define ART_IS_LEAF(p)   (((uintptr_t)(p)) & 1)
+#define ART_LEAF(p)      ((ArtLeaf *)((uintptr_t)(p) & ~(uintptr_t)1))
+#define ART_TAG_LEAF(l)  ((void *)((uintptr_t)(l) | 1))
+
+#define ART_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+static inline ArtLeaf *art_new_leaf(const unsigned char *key, size_t len, void *value) {
+    ArtLeaf *l = (ArtLeaf *)malloc(sizeof(ArtLeaf) + len);
+    if (!l) return NULL;
+    l->value = value;
+    l->len = len;
+    if (len) memcpy(l->key, key, len);
+    return l;
+}
+
+static inline bool art_leaf_matches(const ArtLeaf *l, const unsigned char *key, size_t len) {
+    return l->len == len && memcmp(l->key, key, len) == 0;
+}
+
+static inline ArtNode *art_new_node(uint8_t type) {
+    size_t size;
+    switch (type) {
+    case ART_NODE4:  size = sizeof(ArtNode4); break;
+    case ART_NODE16: size = sizeof(ArtNode16); break;
+    case ART_NODE48: size = sizeof(ArtNode48); break;
+    default:         size = sizeof(ArtNode256); break;
+    }
+    ArtNode *n = (ArtNode *)calloc(1, size);
+    if (n) n->type = type;
+    return n;
+}
+
+static inline void art_copy_header(ArtNode *dst, const ArtNode *src) {
+    dst->num_children = src->num_children;
+    dst->partial_len = src->partial_len;
+    dst->leaf = src->leaf;
+    memcpy(dst->partial, src->partial, ART_MIN((size_t)ART_MAX_PREFIX, (size_t)src->partial_len));
+}
+
+static inline ArtTree *art_create(art_free_fn free_value) {
+    ArtTree *t = (ArtTree *)malloc(sizeof(ArtTree));
+    if (!t) return NULL;
+    t->root = NULL;
+    t->free_value = free_value;
+    t->size = 0;
+    return t;
+}
+
+static inline void art_free_leaf(ArtTree *t, ArtLeaf *l) {
+    if (!l) return;
+    if (t->free_value) t->free_value(l->value);
+    free(l);
+}
+
+/* Next child of `n` in key order from position *pos on, or NULL when done. */
+static inline void *art_next_child(const ArtNode *n, int *pos) {
+    switch (n->type) {
+    case ART_NODE4:
+        return *pos < n->num_children ? ((const ArtNode4 *)n)->children[(*pos)++] : NULL;
+    case ART_NODE16:
+        return *pos < n->num_children ? ((const ArtNode16 *)n)->children[(*pos)++] : NULL;
+    case ART_NODE48: {
+        const ArtNode48 *q = (const ArtNode48 *)n;
+        while (*pos < 256) {
+            int i = (*pos)++;
+            if (q->index[i]) return q->children[q->index[i] - 1];
+        }
+        return NULL;
+    }
+    default:
+        while (*pos < 256) {
+            void *c = ((const ArtNode256 *)n)->children[(*pos)++];
+            if (c) return c;
+        }
+        return NULL;
+    }
+}
+
+/*
+ * Frees the subtree at `p` without recursion or allocation: a pending inner
+ * node's own leaf is freed as soon as it is queued, and its `leaf` slot then
+ * links the queue.
+ */
+static inline void art_free_node(ArtTree *t, void *p) {
+    if (!p) return;
+    if (ART_IS_LEAF(p)) {
+        art_free_leaf(t, ART_LEAF(p));
+        return;
+    }
+    ArtNode *queue = (ArtNode *)p;
+    art_free_leaf(t, queue->leaf);
+    queue->leaf = NULL;
+    while (queue) {
+        ArtNode *n = queue;
+        queue = (ArtNode *)n->leaf;
+        int pos = 0;
+        void *c;
+        while ((c = art_next_child(n, &pos))) {
+            if (ART_IS_LEAF(c)) {
+                art_free_leaf(t, ART_LEAF(c));
+                continue;
+            }
+            ArtNode *cn = (ArtNode *)c;
+            art_free_leaf(t, cn->leaf);
+            cn->leaf = (ArtLeaf *)queue;
+            queue = cn;
+        }
+        free(n);
+    }
+}
+
+static inline void art_destroy(ArtTree *t) {
+    if (!t) return;
+    art_free_node(t, t->root);
+    free(t);
+}
+
+static inline size_t art_size(const ArtTree *t) { return t ? t->size : 0; }
+
+// =======================================
+// Node search and growth
+// =======================================
+
+/* Returns the slot holding the child for byte `c`, or NULL. */
+static inline void **art_find_child(ArtNode *n, unsigned char c) {
+    switch (n->type) {
+    case ART_NODE4: {
+        ArtNode4 *p = (ArtNode4 *)n;
+        for (int i = 0; i < n->num_children; ++i) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+        return NULL;
+    }
+    case ART_NODE16: {
+        ArtNode16 *p = (ArtNode16 *)n;
+#ifdef __SSE2__
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+                                     _mm_loadu_si128((const __m128i *)p->keys));
+        unsigned mask = (unsigned)_mm_movemask_epi8(cmp) & ((1u << n->num_children) - 1);
+        return mask ? &p->children[__builtin_ctz(mask)] : NULL;
+#else
+        for (int i = 0; i < n->num_children; ++i) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+        return NULL;
+#endif
+    }
+    case ART_NODE48: {
+        ArtNode48 *p = (ArtNode48 *)n;
+        int idx = p->index[c];
+        return idx ? &p->children[idx - 1] : NULL;
+    }
+    default: {
+        ArtNode256 *p = (ArtNode256 *)n;
+        return p->children[c] ? &p->children[c] : NULL;
+    }
+    }
+}
+
+/* Inserts into a sorted key/child array with room for one more entry. */
+static inline void art_sorted_insert(unsigned char *keys, void **children, int count,
+                                     unsigned char c, void *child) {
+    int pos = 0;
+    while (pos < count && keys[pos] < c) pos++;
+    memmove(keys + pos + 1, keys + pos, (size_t)(count - pos));
+    memmove(children + pos + 1, children + pos, (size_t)(count - pos) * sizeof(void *));
+    keys[pos] = c;
+    children[pos] = child;
+}
+
+/*
+ * Adds `child` under byte `c` to the node at *ref, replacing it with the
+ * next larger node type when it is full. Returns false if that allocation
+ * fails.
+ */
+static inline bool art_add_child(void **ref, unsigned char c, void *child) {
+    ArtNode *n = (ArtNode *)*ref;
+    switch (n->type) {
+    case ART_NODE4: {
+        ArtNode4 *p = (ArtNode4 *)n;
+        if (n->num_children < 4) {
+            art_sorted_insert(p->keys, p->children, n->num_children, c, child);
+            n->num_children++;
+            return true;
+        }
+        ArtNode16 *g = (ArtNode16 *)art_new_node(ART_NODE16);
+        if (!g) return false;
+        art_copy_header(&g->n, n);
+        memcpy(g->keys, p->keys, 4);
+        memcpy(g->children, p->children, 4 * sizeof(void *));
+        *ref = g;
+        free(n);
+        return art_add_child(ref, c, child);
+    }
+    case ART_NODE16: {
+        ArtNode16 *p = (ArtNode16 *)n;
+        if (n->num_children < 16) {
+            art_sorted_insert(p->keys, p->children, n->num_children, c, child);
+            n->num_children++;
+            return true;
+        }
+        ArtNode48 *g = (ArtNode48 *)art_new_node(ART_NODE48);
+        if (!g) return false;
+        art_copy_header(&g->n, n);
+        memcpy(g->children, p->children, 16 * sizeof(void *));
+        for (int i = 0; i < 16; ++i) g->index[p->keys[i]] = (unsigned char)(i + 1);
+        *ref = g;
+        free(n);
+        return art_add_child(ref, c, child);
+    }
+    case ART_NODE48: {
+        ArtNode48 *p = (ArtNode48 *)n;
+        if (n->num_children < 48) {
+            int slot = 0;
+            while (p->children[slot]) slot++;
+            p->children[slot] = child;
+            p->index[c] = (unsigned char)(slot + 1);
+            n->num_children++;
+            return true;
+        }
+        ArtNode256 *g = (ArtNode256 *)art_new_node(ART_NODE256);
+        if (!g) return false;
+        art_copy_header(&g->n, n);
+        for (int i = 0; i < 256; ++i) {
+            if (p->index[i]) g->children[i] = p->children[p->index[i] - 1];
+        }
+        *ref = g;
+        free(n);
+        return art_add_child(ref, c, child);
+    }
+    default: {
+        ArtNode256 *p = (ArtNode256 *)n;
+        p->children[c] = child;
+        n->num_children++;
+        return true;
+    }
+    }
+}
+
+/* Leftmost leaf below `p`; every leaf in a subtree carries its full prefix. */
+static inline ArtLeaf *art_minimum(const void *p) {
+    while (p && !ART_IS_LEAF(p)) {
+        const ArtNode *n = (const ArtNode *)p;
+        if (n->leaf) return n->leaf;
+        switch (n->type) {
+        case ART_NODE4:  p = ((const ArtNode4 *)n)->children[0]; break;
+        case ART_NODE16: p = ((const ArtNode16 *)n)->children[0]; break;
+        case ART_NODE48: {
+            const ArtNode48 *q = (const ArtNode48 *)n;
+            int i = 0;
+            while (!q->index[i]) i++;
+            p = q->children[q->index[i] - 1];
+            break;
+        }
+        default: {
+            const ArtNode256 *q = (const ArtNode256 *)n;
+            int i = 0;
+            while (!q->children[i]) i++;
+            p = q->children[i];
+            break;
+        }
+        }
+    }
+    return p ? ART_LEAF(p) : NULL;
+}
+
+/* Number of stored prefix bytes of `n` that match key[depth..]. */
+static inline size_t art_check_prefix(const ArtNode *n, const unsigned char *key, size_t len,
+                                      size_t depth) {
+    size_t max = ART_MIN(ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len), len - depth);
+    size_t i = 0;
+    while (i < max && n->partial[i] == key[depth + i]) i++;
+    return i;
+}
+
+/*
+ * Index of the first byte where key[depth..] leaves the full prefix of `n`,
+ * capped at the remaining key length. Bytes past ART_MAX_PREFIX are read
+ * from a leaf of the subtree.
+ */
+static inline size_t art_prefix_mismatch(const ArtNode *n, const unsigned char *key, size_t len,
+                                         size_t depth) {
+    size_t i = art_check_prefix(n, key, len, depth);
+    if (i < ART_MAX_PREFIX || n->partial_len <= ART_MAX_PREFIX) return i;
+    const ArtLeaf *l = art_minimum(n);
+    size_t max = ART_MIN((size_t)n->partial_len, len - depth);
+    while (i < max && l->key[depth + i] == key[depth + i]) i++;
+    return i;
+}
+
+// =======================================
+// Lookup, insert and remove
+// =======================================
+
+static inline ArtLeaf *art_search(const ArtTree *t, const unsigned char *key, size_t len) {
+    void *p = t->root;
+    size_t depth = 0;
+    while (p) {
+        if (ART_IS_LEAF(p)) {
+            ArtLeaf *l = ART_LEAF(p);
+            return art_leaf_matches(l, key, len) ? l : NULL;
+        }
+        ArtNode *n = (ArtNode *)p;
+        if (n->partial_len) {
+            if (depth + n->partial_len > len) return NULL;
+            if (art_check_prefix(n, key, len, depth) !=
+                ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len)) {
+                return NULL;
+            }
+            depth += n->partial_len;
+        }
+        if (depth == len) {
+            return (n->leaf && art_leaf_matches(n->leaf, key, len)) ? n->leaf : NULL;
+        }
+        void **child = art_find_child(n, key[depth]);
+        p = child ? *child : NULL;
+        depth++;
+    }
+    return NULL;
+}
+
+static inline void *art_get(const ArtTree *t, const void *key, size_t len) {
+    if (!t || (!key && len)) return NULL;
+    ArtLeaf *l = art_search(t, (const unsigned char *)key, len);
+    return l ? l->value : NULL;
+}
+
+static inline bool art_contains(const ArtTree *t, const void *key, size_t len) {
+    if (!t || (!key && len)) return false;
+    return art_search(t, (const unsigned char *)key, len) != NULL;
+}
+
+/*
+ * Inserts or replaces. Returns true if the key was new, false if an existing
+ * value was replaced (the old value is passed to free_value) or on allocation
+ * failure, mirroring trie_insert().
+ */
+static inline bool art_insert(ArtTree *t, const void *key_ptr, size_t len, void *value) {
+    if (!t || (!key_ptr && len)) return false;
+    const unsigned char *key = (const unsigned char *)key_ptr;
+    void **ref = &t->root;
+    size_t depth = 0;
+    for (;;) {
+        void *p = *ref;
+        if (!p) {
+            ArtLeaf *l = art_new_leaf(key, len, value);
+            if (!l) return false;
+            *ref = ART_TAG_LEAF(l);
+            t->size++;
+            return true;
+        }
+
+        if (ART_IS_LEAF(p)) {
+            ArtLeaf *old = ART_LEAF(p);
+            if (art_leaf_matches(old, key, len)) {
+                if (t->free_value) t->free_value(old->value);
+                old->value = value;
+                return false;
+            }
+            /* Lazy expansion: split the leaf at the first differing byte. */
+            size_t limit = ART_MIN(old->len, len) - depth;
+            size_t lcp = 0;
+            while (lcp < limit && old->key[depth + lcp] == key[depth + lcp]) lcp++;
+            ArtNode *n = art_new_node(ART_NODE4);
+            ArtLeaf *l = art_new_leaf(key, len, value);
+            if (!n || !l) { free(n); free(l); return false; }
+            n->partial_len = (uint32_t)lcp;
+            memcpy(n->partial, key + depth, ART_MIN((size_t)ART_MAX_PREFIX, lcp));
+            depth += lcp;
+            void *np = n;
+            if (old->len == depth) n->leaf = old;
+            else art_add_child(&np, old->key[depth], p);
+            if (len == depth) n->leaf = l;
+            else art_add_child(&np, key[depth], ART_TAG_LEAF(l));
+            *ref = n;
+            t->size++;
+            return true;
+        }
+
+        ArtNode *n = (ArtNode *)p;
+        if (n->partial_len) {
+            size_t diff = art_prefix_mismatch(n, key, len, depth);
+            if (diff < n->partial_len) {
+                /* The key leaves the compressed path: split it above `n`. */
+                ArtNode *top = art_new_node(ART_NODE4);
+                ArtLeaf *l = art_new_leaf(key, len, value);
+                if (!top || !l) { free(top); free(l); return false; }
+                top->partial_len = (uint32_t)diff;
+                memcpy(top->partial, n->partial, ART_MIN((size_t)ART_MAX_PREFIX, diff));
+                void *tp = top;
+                if (n->partial_len <= ART_MAX_PREFIX) {
+                    art_add_child(&tp, n->partial[diff], n);
+                    n->partial_len -= (uint32_t)(diff + 1);
+                    memmove(n->partial, n->partial + diff + 1,
+                            ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len));
+                } else {
+                    const ArtLeaf *m = art_minimum(n);
+                    art_add_child(&tp, m->key[depth + diff], n);
+                    n->partial_len -= (uint32_t)(diff + 1);
+                    memcpy(n->partial, m->key + depth + diff + 1,
+                           ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len));
+                }
+                if (len == depth + diff) top->leaf = l;
+                else art_add_child(&tp, key[depth + diff], ART_TAG_LEAF(l));
+                *ref = top;
+                t->size++;
+                return true;
+            }
+            depth += n->partial_len;
+        }
+
+        if (depth == len) {
+            if (n->leaf) {
+                if (t->free_value) t->free_value(n->leaf->value);
+                n->leaf->value = value;
+                return false;
+            }
+            n->leaf = art_new_leaf(key, len, value);
+            if (!n->leaf) return false;
+            t->size++;
+            return true;
+        }
+
+        void **child = art_find_child(n, key[depth]);
+        if (child) {
+            ref = child;
+            depth++;
+            continue;
+        }
+        ArtLeaf *l = art_new_leaf(key, len, value);
+        if (!l) return false;
+        if (!art_add_child(ref, key[depth], ART_TAG_LEAF(l))) {
+            free(l);
+            return false;
+        }
+        t->size++;
+        return true;
+    }
+}
+
+/* Drops the child under byte `c` from the node at *ref (no shrinking). */
+static inline void art_remove_child(ArtNode *n, unsigned char c, void **slot) {
+    switch (n->type) {
+    case ART_NODE4: {
+        ArtNode4 *p = (ArtNode4 *)n;
+        int pos = (int)(slot - p->children);
+        memmove(p->keys + pos, p->keys + pos + 1, (size_t)(n->num_children - 1 - pos));
+        memmove(p->children + pos, p->children + pos + 1,
+                (size_t)(n->num_children - 1 - pos) * sizeof(void *));
+        break;
+    }
+    case ART_NODE16: {
+        ArtNode16 *p = (ArtNode16 *)n;
+        int pos = (int)(slot - p->children);
+        memmove(p->keys + pos, p->keys + pos + 1, (size_t)(n->num_children - 1 - pos));
+        memmove(p->children + pos, p->children + pos + 1,
+                (size_t)(n->num_children - 1 - pos) * sizeof(void *));
+        break;
+    }
+    case ART_NODE48: {
+        ArtNode48 *p = (ArtNode48 *)n;
+        p->children[p->index[c] - 1] = NULL;
+        p->index[c] = 0;
+        break;
+    }
+    default:
+        ((ArtNode256 *)n)->children[c] = NULL;
+        break;
+    }
+    n->num_children--;
+}
+
+/*
+ * Restores the node invariants at *ref after a removal: a node left with
+ * only its own leaf becomes that leaf, a Node4 with one child and no leaf is
+ * merged into the child, and underfull nodes shrink to the next size down.
+ */
+static inline void art_compact(void **ref) {
+    ArtNode *n = (ArtNode *)*ref;
+    if (n->num_children == 0) {
+        *ref = n->leaf ? ART_TAG_LEAF(n->leaf) : NULL;
+        free(n);
+        return;
+    }
+    switch (n->type) {
+    case ART_NODE4: {
+        if (n->num_children != 1 || n->leaf) return;
+        ArtNode4 *p = (ArtNode4 *)n;
+        void *child = p->children[0];
+        if (!ART_IS_LEAF(child)) {
+            /* Prefix becomes n's prefix + the branch byte + child's prefix. */
+            ArtNode *c = (ArtNode *)child;
+            unsigned char buf[ART_MAX_PREFIX];
+            size_t used = ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len);
+            memcpy(buf, n->partial, used);
+            if (used < ART_MAX_PREFIX) buf[used++] = p->keys[0];
+            size_t take = ART_MIN((size_t)ART_MAX_PREFIX - used,
+                                  ART_MIN((size_t)ART_MAX_PREFIX, (size_t)c->partial_len));
+            memcpy(buf + used, c->partial, take);
+            used += take;
+            c->partial_len += n->partial_len + 1;
+            memcpy(c->partial, buf, used);
+        }
+        *ref = child;
+        free(n);
+        return;
+    }
+    case ART_NODE16: {
+        if (n->num_children > 3) return;
+        ArtNode16 *p = (ArtNode16 *)n;
+        ArtNode4 *s = (ArtNode4 *)art_new_node(ART_NODE4);
+        if (!s) return;
+        art_copy_header(&s->n, n);
+        memcpy(s->keys, p->keys, n->num_children);
+        memcpy(s->children, p->children, n->num_children * sizeof(void *));
+        *ref = s;
+        free(n);
+        art_compact(ref);
+        return;
+    }
+    case ART_NODE48: {
+        if (n->num_children > 12) return;
+        ArtNode48 *p = (ArtNode48 *)n;
+        ArtNode16 *s = (ArtNode16 *)art_new_node(ART_NODE16);
+        if (!s) return;
+        art_copy_header(&s->n, n);
+        int j = 0;
+        for (int i = 0; i < 256; ++i) {
+            if (!p->index[i]) continue;
+            s->keys[j] = (unsigned char)i;
+            s->children[j++] = p->children[p->index[i] - 1];
+        }
+        *ref = s;
+        free(n);
+        return;
+    }
+    default: {
+        if (n->num_children > 37) return;
+        ArtNode256 *p = (ArtNode256 *)n;
+        ArtNode48 *s = (ArtNode48 *)art_new_node(ART_NODE48);
+        if (!s) return;
+        art_copy_header(&s->n, n);
+        int j = 0;
+        for (int i = 0; i < 256; ++i) {
+            if (!p->children[i]) continue;
+            s->children[j] = p->children[i];
+            s->index[i] = (unsigned char)(++j);
+        }
+        *ref = s;
+        free(n);
+        return;
+    }
+    }
+}
+
+static inline bool art_remove(ArtTree *t, const void *key_ptr, size_t len) {
+    if (!t || !t->root || (!key_ptr && len)) return false;
+    const unsigned char *key = (const unsigned char *)key_ptr;
+    if (ART_IS_LEAF(t->root)) {
+        ArtLeaf *l = ART_LEAF(t->root);
+        if (!art_leaf_matches(l, key, len)) return false;
+        art_free_leaf(t, l);
+        t->root = NULL;
+        t->size--;
+        return true;
+    }
+
+    void **ref = &t->root;
+    size_t depth = 0;
+    for (;;) {
+        ArtNode *n = (ArtNode *)*ref;
+        if (n->partial_len) {
+            if (depth + n->partial_len > len) return false;
+            if (art_check_prefix(n, key, len, depth) !=
+                ART_MIN((size_t)ART_MAX_PREFIX, (size_t)n->partial_len)) {
+                return false;
+            }
+            depth += n->partial_len;
+        }
+        if (depth == len) {
+            ArtLeaf *l = n->leaf;
+            if (!l || !art_leaf_matches(l, key, len)) return false;
+            n->leaf = NULL;
+            art_free_leaf(t, l);
+            t->size--;
+            art_compact(ref);
+            return true;
+        }
+        void **child = art_find_child(n, key[depth]);
+        if (!child) return false;
+        if (ART_IS_LEAF(*child)) {
+            ArtLeaf *l = ART_LEAF(*child);
+            if (!art_leaf_matches(l, key, len)) return false;
+            art_remove_child(n, key[depth], child);
+            art_free_leaf(t, l);
+            t->size--;
+            art_compact(ref);
+            return true;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+// =======================================
+// Ordered iteration
+// =======================================
+
+#ifndef ART_ITER_FRAMES
+#define ART_ITER_FRAMES 64
+#endif
+
+typedef struct ArtFrame {
+    const ArtNode *n;
+    int pos;                            /* art_next_child() position */
+} ArtFrame;
+
+/*
+ * In-order walk of the subtree at `p` with an explicit stack, one frame per
+ * inner node on the current path. Returns false if `visit` stopped the walk,
+ * or if the stack could not grow past its first ART_ITER_FRAMES frames.
+ */
+static inline bool art_iterate(const void *p, art_visit_fn visit, void *user) {
+    ArtFrame local[ART_ITER_FRAMES];
+    ArtFrame *stack = local;
+    size_t cap = ART_ITER_FRAMES, top = 0;
+    bool ok = true;
+    for (;;) {
+        if (p && ART_IS_LEAF(p)) {
+            const ArtLeaf *l = ART_LEAF(p);
+            if (!(ok = visit(l->key, l->len, l->value, user))) break;
+        } else if (p) {
+            const ArtNode *n = (const ArtNode *)p;
+            if (n->leaf && !(ok = visit(n->leaf->key, n->leaf->len, n->leaf->value, user))) break;
+            if (top == cap) {
+                ArtFrame *grown = (ArtFrame *)malloc(cap * 2 * sizeof(ArtFrame));
+                if (!(ok = grown != NULL)) break;
+                memcpy(grown, stack, cap * sizeof(ArtFrame));
+                if (stack != local) free(stack);
+                stack = grown;
+                cap *= 2;
+            }
+            stack[top].n = n;
+            stack[top++].pos = 0;
+        }
+        if (!top) break;
+        p = art_next_child(stack[top - 1].n, &stack[top - 1].pos);
+        if (!p) top--;
+    }
+    if (stack != local) free(stack);
+    return ok;
+}
+
+/* Visits every key in lexicographic byte order. */
+static inline void art_foreach(const ArtTree *t, art_visit_fn visit, void *user) {
+    if (t && visit) art_iterate(t->root, visit, user);
+}
+
+/* Visits, in order, every key that starts with prefix[0..len). */
+static inline void art_prefix_scan(const ArtTree *t, const void *prefix_ptr, size_t len,
+                                   art_visit_fn visit, void *user) {
+    if (!t || !visit || (!prefix_ptr && len)) return;
+    const unsigned char *prefix = (const unsigned char *)prefix_ptr;
+    const void *p = t->root;
+    size_t depth = 0;
+    while (p) {
+        if (ART_IS_LEAF(p)) {
+            const ArtLeaf *l = ART_LEAF(p);
+            if (l->len >= len && memcmp(l->key, prefix, len) == 0) {
+                visit(l->key, l->len, l->value, user);
+            }
+            return;
+        }
+        if (depth == len) {
+            art_iterate(p, visit, user);
+            return;
+        }
+        ArtNode *n = (ArtNode *)p;
+        if (n->partial_len) {
+            size_t diff = art_prefix_mismatch(n, prefix, len, depth);
+            if (depth + diff == len) {
+                art_iterate(p, visit, user);
+                return;
+            }
+            if (diff < n->partial_len) return;
+            depth += n->partial_len;
+        }
+        void **child = art_find_child(n, prefix[depth]);
+        p = child ? *child : NULL;
+        depth++;
+    }
+}
+
+#endif
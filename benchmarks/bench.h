@@ -0,0 +1,257 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+ * Minimal benchmark harness.
+ *
+ * Every measured section is wrapped in bench_start()/bench_stop() and reported
+ * as time per operation. When run with --perf (or BENCH_PERF=1) on Linux, the
+ * harness also reads hardware counters through perf_event_open and reports
+ * them per operation. Counters that cannot be opened (no PMU, VM, or
+ * perf_event_paranoid too strict) are shown as "-" and the run continues with
+ * wall-clock numbers only.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef enum {
+    BENCH_CYCLES,
+    BENCH_INSTRUCTIONS,
+    BENCH_L1D_MISSES,
+    BENCH_LLC_MISSES,
+    BENCH_BRANCH_MISSES,
+    BENCH_DTLB_MISSES,
+    BENCH_NCOUNTERS
+} bench_counter_id;
+
+static const char *const bench_counter_names[BENCH_NCOUNTERS] = {
+    "cyc/op", "ins/op", "L1d-miss/op", "LLC-miss/op", "br-miss/op", "dTLB-miss/op"
+};
+
+typedef struct {
+    bool perf;
+    const char *filter;
+    int fd[BENCH_NCOUNTERS];
+    bool header_printed;
+} BenchState;
+
+typedef struct {
+    const char *name;
+    uint64_t t0;
+    bool active;
+} BenchSection;
+
+static BenchState bench_state = {
+    false, NULL, {-1, -1, -1, -1, -1, -1}, false
+};
+
+static volatile uintptr_t bench_sink;
+
+/* Keeps the compiler from discarding results computed inside a section. */
+static inline void bench_consume(uintptr_t v) { bench_sink += v; }
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift64*, good enough to generate shuffled benchmark inputs. */
+static inline uint64_t bench_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+#ifdef __linux__
+static inline int bench_perf_open(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;           /* also count threads spawned by a section */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static inline uint64_t bench_cache_event(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+static inline void bench_perf_setup(void) {
+    BenchState *s = &bench_state;
+    s->fd[BENCH_CYCLES] = bench_perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    s->fd[BENCH_INSTRUCTIONS] = bench_perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    s->fd[BENCH_L1D_MISSES] = bench_perf_open(PERF_TYPE_HW_CACHE,
+        bench_cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                          PERF_COUNT_HW_CACHE_RESULT_MISS));
+    s->fd[BENCH_LLC_MISSES] = bench_perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    s->fd[BENCH_BRANCH_MISSES] = bench_perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    s->fd[BENCH_DTLB_MISSES] = bench_perf_open(PERF_TYPE_HW_CACHE,
+        bench_cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                          PERF_COUNT_HW_CACHE_RESULT_MISS));
+
+    int opened = 0;
+    for (int i = 0; i < BENCH_NCOUNTERS; ++i) opened += s->fd[i] >= 0;
+    if (opened == 0) {
+        fprintf(stderr, "bench: hardware counters unavailable "
+                        "(check /proc/sys/kernel/perf_event_paranoid), "
+                        "reporting wall clock only\n");
+        s->perf = false;
+    } else if (opened < BENCH_NCOUNTERS) {
+        fprintf(stderr, "bench: %d of %d hardware counters unavailable\n",
+                BENCH_NCOUNTERS - opened, BENCH_NCOUNTERS);
+    }
+}
+
+/* Returns the counter value scaled for multiplexing, or -1 if unavailable. */
+static inline double bench_perf_read(int fd) {
+    uint64_t buf[3];
+    if (fd < 0 || read(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) return -1.0;
+    if (buf[2] == 0) return -1.0;
+    double v = (double)buf[0];
+    if (buf[2] < buf[1]) v *= (double)buf[1] / (double)buf[2];
+    return v;
+}
+#endif
+
+static inline void bench_shutdown(void) {
+#ifdef __linux__
+    for (int i = 0; i < BENCH_NCOUNTERS; ++i) {
+        if (bench_state.fd[i] >= 0) close(bench_state.fd[i]);
+        bench_state.fd[i] = -1;
+    }
+#endif
+}
+
+/*
+ * Parses the harness options: --perf enables hardware counters and any other
+ * argument is used as a substring filter on section names.
+ */
+static inline void bench_init(int argc, char **argv) {
+    const char *env = getenv("BENCH_PERF");
+    if (env && *env && strcmp(env, "0") != 0) bench_state.perf = true;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--perf") == 0) bench_state.perf = true;
+        else bench_state.filter = argv[i];
+    }
+#ifdef __linux__
+    if (bench_state.perf) bench_perf_setup();
+#else
+    if (bench_state.perf) {
+        fprintf(stderr, "bench: hardware counters need Linux perf_event_open\n");
+        bench_state.perf = false;
+    }
+#endif
+    atexit(bench_shutdown);
+}
+
+static inline bool bench_enabled(const char *name) {
+    return !bench_state.filter || strstr(name, bench_state.filter) != NULL;
+}
+
+static inline void bench_print_header(void) {
+    if (bench_state.header_printed) return;
+    bench_state.header_printed = true;
+    printf("%-40s %12s %10s", "benchmark", "ops", "ns/op");
+    if (bench_state.perf) {
+        for (int i = 0; i < BENCH_NCOUNTERS; ++i) printf(" %12s", bench_counter_names[i]);
+        printf(" %6s", "IPC");
+    }
+    printf("\n");
+}
+
+static inline void bench_start(BenchSection *s, const char *name) {
+    s->name = name;
+    s->t0 = 0;
+    s->active = bench_enabled(name);
+    if (!s->active) return;
+#ifdef __linux__
+    if (bench_state.perf) {
+        for (int i = 0; i < BENCH_NCOUNTERS; ++i) {
+            int fd = bench_state.fd[i];
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+    s->t0 = bench_now_ns();
+}
+
+/* Ends a section that performed `ops` operations and prints one result row. */
+static inline void bench_stop(BenchSection *s, size_t ops) {
+    if (!s->active) return;
+    uint64_t elapsed = bench_now_ns() - s->t0;
+    double counters[BENCH_NCOUNTERS];
+    for (int i = 0; i < BENCH_NCOUNTERS; ++i) counters[i] = -1.0;
+#ifdef __linux__
+    if (bench_state.perf) {
+        for (int i = 0; i < BENCH_NCOUNTERS; ++i) {
+            if (bench_state.fd[i] >= 0) ioctl(bench_state.fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int i = 0; i < BENCH_NCOUNTERS; ++i) counters[i] = bench_perf_read(bench_state.fd[i]);
+    }
+#endif
+    if (ops == 0) ops = 1;
+    bench_print_header();
+    printf("%-40s %12zu %10.2f", s->name, ops, (double)elapsed / (double)ops);
+    if (bench_state.perf) {
+        for (int i = 0; i < BENCH_NCOUNTERS; ++i) {
+            if (counters[i] < 0) printf(" %12s", "-");
+            else printf(" %12.3f", counters[i] / (double)ops);
+        }
+        if (counters[BENCH_CYCLES] > 0 && counters[BENCH_INSTRUCTIONS] >= 0) {
+            printf(" %6.2f", counters[BENCH_INSTRUCTIONS] / counters[BENCH_CYCLES]);
+        } else {
+            printf(" %6s", "-");
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+    s->active = false;
+}
+
+#endif
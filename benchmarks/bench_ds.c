@@ -0,0 +1,236 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "../ds.h"
+#include "../unrolled_list.h"
+#include "../skip_list.h"
+#include "bench.h"
+
+#define BENCH_N       100000
+#define BENCH_LOOKUPS 1000000
+#define BENCH_LIST_N  10000
+#define BENCH_SCAN_N  1000000
+#define BENCH_SCANS   20
+
+static int cmp_uint(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)a, y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static void shuffle(uintptr_t *keys, size_t n, uint64_t *seed) {
+    for (size_t i = n; i > 1; --i) {
+        size_t j = (size_t)(bench_rand(seed) % i);
+        uintptr_t tmp = keys[i - 1]; keys[i - 1] = keys[j]; keys[j] = tmp;
+    }
+}
+
+static void bench_hashmap(void) {
+    Hashmap *map = hashmap_create(BENCH_N);
+    char (*names)[16] = malloc(BENCH_N * sizeof(*names));
+    if (!map || !names) { free(names); if (map) hashmap_destroy(map); return; }
+    for (size_t i = 0; i < BENCH_N; ++i) {
+        snprintf(names[i], sizeof(names[i]), "key%zu", i);
+        hashmap_insert(map, names[i], (void *)(i + 1));
+    }
+
+    uint64_t seed = 42;
+    BenchSection s;
+    bench_start(&s, "hashmap_get/hit");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)hashmap_get(map, names[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "hashmap_get/miss");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        char miss[16];
+        snprintf(miss, sizeof(miss), "nokey%zu", (size_t)(bench_rand(&seed) % BENCH_N));
+        bench_consume((uintptr_t)hashmap_get(map, miss));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    free(names);
+    hashmap_destroy(map);
+}
+
+static void bench_bst(void) {
+    uintptr_t *keys = malloc(BENCH_N * sizeof(*keys));
+    BST *t = bst_create(cmp_uint, NULL, NULL);
+    if (!keys || !t) { free(keys); bst_destroy(t); return; }
+    uint64_t seed = 7;
+    for (size_t i = 0; i < BENCH_N; ++i) keys[i] = i + 1;
+    shuffle(keys, BENCH_N, &seed);
+
+    BenchSection s;
+    bench_start(&s, "bst_insert/random");
+    for (size_t i = 0; i < BENCH_N; ++i) bst_insert(t, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+    bench_start(&s, "bst_get/random");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bst_get(t, (void *)keys[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bst_destroy(t);
+    free(keys);
+}
+
+static void bench_list(void) {
+    Node *head = NULL;
+    for (int i = BENCH_LIST_N; i > 0; --i) insertAtHead(&head, i);
+
+    uint64_t seed = 3;
+    size_t lookups = BENCH_LOOKUPS / 100;
+    BenchSection s;
+    bench_start(&s, "list_search/random");
+    for (size_t i = 0; i < lookups; ++i) {
+        bench_consume((uintptr_t)search(head, (int)(bench_rand(&seed) % BENCH_LIST_N) + 1));
+    }
+    bench_stop(&s, lookups);
+
+    freeList(head);
+
+    bench_start(&s, "insertAtTail/build");
+    head = NULL;
+    for (int i = 0; i < BENCH_LIST_N; ++i) insertAtTail(&head, i);
+    bench_stop(&s, BENCH_LIST_N);
+    freeList(head);
+
+    LinkedList list;
+    list_init(&list, false);
+    bench_start(&s, "list_push_back/build");
+    for (int i = 0; i < BENCH_LIST_N; ++i) list_push_back(&list, i);
+    bench_stop(&s, BENCH_LIST_N);
+    list_destroy(&list);
+}
+
+/* Full-length scans for a value that is not present. */
+static void bench_scan(void) {
+    Node *head = NULL;
+    UnrolledList ul;
+    unrolled_list_init(&ul);
+    for (int i = 0; i < BENCH_SCAN_N; ++i) {
+        insertAtHead(&head, i);
+        unrolled_list_push_back(&ul, i);
+    }
+
+    BenchSection s;
+    bench_start(&s, "scan/node_list");
+    for (int r = 0; r < BENCH_SCANS; ++r) bench_consume((uintptr_t)search(head, -1 - r));
+    bench_stop(&s, (size_t)BENCH_SCANS * BENCH_SCAN_N);
+
+    bench_start(&s, "scan/unrolled_list");
+    for (int r = 0; r < BENCH_SCANS; ++r) bench_consume(unrolled_list_find(&ul, -1 - r, NULL));
+    bench_stop(&s, (size_t)BENCH_SCANS * BENCH_SCAN_N);
+
+    freeList(head);
+    unrolled_list_destroy(&ul);
+}
+
+/* Lookups in a sorted set of BENCH_LIST_N keys. */
+static void bench_ordered_set(void) {
+    LinkedList list;
+    SkipList *sl = skiplist_create();
+    if (!sl) return;
+    list_init(&list, false);
+    for (int i = 0; i < BENCH_LIST_N; ++i) {
+        list_push_back(&list, 2 * i);
+        skiplist_insert(sl, 2 * i);
+    }
+
+    uint64_t seed = 11;
+    size_t lookups = BENCH_LOOKUPS / 100;
+    BenchSection s;
+    bench_start(&s, "ordered_set/list_search");
+    for (size_t i = 0; i < lookups; ++i) {
+        bench_consume((uintptr_t)list_find(&list, (int)(bench_rand(&seed) % (2 * BENCH_LIST_N))));
+    }
+    bench_stop(&s, lookups);
+
+    bench_start(&s, "ordered_set/skiplist_contains");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume(skiplist_contains(sl, (int)(bench_rand(&seed) % (2 * BENCH_LIST_N))));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    list_destroy(&list);
+    skiplist_destroy(sl);
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Sorting a 1M-element list in place vs copying it out to qsort and rebuilding. */
+static void bench_list_sort(void) {
+    int *values = malloc(BENCH_SCAN_N * sizeof(int));
+    if (!values) return;
+    uint64_t seed = 5;
+    for (size_t i = 0; i < BENCH_SCAN_N; ++i) values[i] = (int)(bench_rand(&seed) >> 33);
+
+    LinkedList list;
+    BenchSection s;
+    bench_start(&s, "list_build/push_back");
+    list_init(&list, false);
+    for (size_t i = 0; i < BENCH_SCAN_N; ++i) list_push_back(&list, values[i]);
+    bench_stop(&s, BENCH_SCAN_N);
+    list_destroy(&list);
+
+    bench_start(&s, "list_build/from_array");
+    list_from_array(&list, values, BENCH_SCAN_N, false);
+    bench_stop(&s, BENCH_SCAN_N);
+
+    bench_start(&s, "list_sort/qsort_rebuild");
+    LinkedList copy;
+    size_t n = 0;
+    int *tmp = malloc(list.size * sizeof(int));
+    if (tmp) {
+        for (Node *cur = list.head; cur; cur = cur->next) tmp[n++] = cur->data;
+        qsort(tmp, n, sizeof(int), cmp_int);
+        list_from_array(&copy, tmp, n, false);
+        free(tmp);
+        list_destroy(&copy);
+    }
+    bench_stop(&s, BENCH_SCAN_N);
+
+    bench_start(&s, "list_sort/merge_sort");
+    list_sort(&list);
+    bench_stop(&s, BENCH_SCAN_N);
+
+    list_destroy(&list);
+    free(values);
+}
+
+int main(int argc, char **argv) {
+    bench_init(argc, argv);
+    bench_hashmap();
+    bench_bst();
+    bench_list();
+    bench_scan();
+    bench_ordered_set();
+    bench_list_sort();
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <pthread.h>
+#include "../linked_list.h"
+#include "../lf_queue.h"
+#include "bench.h"
+
+/*
+ * Enqueue/dequeue throughput at 1..32 threads. For the MPMC variants every
+ * thread runs enqueue+dequeue pairs; the MPSC run uses one consumer and the
+ * remaining threads as producers.
+ */
+
+#define QUEUE_OPS (1 << 20)
+#define MAX_THREADS 32
+
+typedef struct {
+    LinkedList list;
+    pthread_mutex_t lock;
+} MutexQueue;
+
+typedef struct {
+    int kind;
+    int nthreads;
+    size_t iters;
+    MutexQueue *mq;
+    LFQueue *lfq;
+    MPSCQueue *mpsc;
+} QueueArgs;
+
+enum { KIND_MUTEX, KIND_LFQ, KIND_MPSC_PRODUCER };
+
+static void *pair_worker(void *arg) {
+    QueueArgs *a = (QueueArgs *)arg;
+    int v = 0;
+    if (a->kind == KIND_MUTEX) {
+        for (size_t i = 0; i < a->iters; ++i) {
+            pthread_mutex_lock(&a->mq->lock);
+            list_push_back(&a->mq->list, (int)i);
+            pthread_mutex_unlock(&a->mq->lock);
+            pthread_mutex_lock(&a->mq->lock);
+            list_pop_front(&a->mq->list, &v);
+            pthread_mutex_unlock(&a->mq->lock);
+            bench_consume((uintptr_t)v);
+        }
+    } else if (a->kind == KIND_LFQ) {
+        EpochThread *th = lfq_register(a->lfq);
+        for (size_t i = 0; i < a->iters; ++i) {
+            lfq_enqueue(a->lfq, th, (int)i);
+            if (lfq_dequeue(a->lfq, th, &v)) bench_consume((uintptr_t)v);
+        }
+        lfq_unregister(th);
+    } else {
+        EpochThread *th = mpscq_register(a->mpsc);
+        for (size_t i = 0; i < a->iters; ++i) mpscq_enqueue(a->mpsc, th, (int)i);
+        mpscq_unregister(th);
+    }
+    return NULL;
+}
+
+static void run_threads(QueueArgs *a, int nthreads) {
+    pthread_t tid[MAX_THREADS];
+    for (int i = 0; i < nthreads; ++i) pthread_create(&tid[i], NULL, pair_worker, a);
+    for (int i = 0; i < nthreads; ++i) pthread_join(tid[i], NULL);
+}
+
+static void bench_mutex(int nthreads) {
+    char name[64];
+    snprintf(name, sizeof(name), "queue/mutex_list/t=%d", nthreads);
+    MutexQueue mq;
+    list_init(&mq.list, false);
+    pthread_mutex_init(&mq.lock, NULL);
+    QueueArgs a = { KIND_MUTEX, nthreads, QUEUE_OPS / (size_t)nthreads, &mq, NULL, NULL };
+
+    BenchSection s;
+    bench_start(&s, name);
+    run_threads(&a, nthreads);
+    bench_stop(&s, 2 * a.iters * (size_t)nthreads);
+
+    list_destroy(&mq.list);
+    pthread_mutex_destroy(&mq.lock);
+}
+
+static void bench_lfq(int nthreads) {
+    char name[64];
+    snprintf(name, sizeof(name), "queue/lfq_mpmc/t=%d", nthreads);
+    LFQueue *q = malloc(sizeof(LFQueue));
+    if (!q || !lfq_init(q)) { free(q); return; }
+    QueueArgs a = { KIND_LFQ, nthreads, QUEUE_OPS / (size_t)nthreads, NULL, q, NULL };
+
+    BenchSection s;
+    bench_start(&s, name);
+    run_threads(&a, nthreads);
+    bench_stop(&s, 2 * a.iters * (size_t)nthreads);
+
+    lfq_destroy(q);
+    free(q);
+}
+
+static void bench_mpsc(int nthreads) {
+    char name[64];
+    snprintf(name, sizeof(name), "queue/mpsc/t=%d", nthreads);
+    MPSCQueue *q = malloc(sizeof(MPSCQueue));
+    if (!q || !mpscq_init(q)) { free(q); return; }
+    int producers = nthreads > 1 ? nthreads - 1 : 1;
+    QueueArgs a = { KIND_MPSC_PRODUCER, producers, QUEUE_OPS / (size_t)producers, NULL, NULL, q };
+    size_t total = a.iters * (size_t)producers;
+    EpochThread *th = mpscq_register(q);
+
+    BenchSection s;
+    bench_start(&s, name);
+    pthread_t tid[MAX_THREADS];
+    int v;
+    if (nthreads == 1) {
+        for (size_t i = 0; i < total; ++i) {
+            mpscq_enqueue(q, th, (int)i);
+            mpscq_dequeue(q, th, &v);
+        }
+    } else {
+        for (int i = 0; i < producers; ++i) pthread_create(&tid[i], NULL, pair_worker, &a);
+        for (size_t got = 0; got < total;) {
+            if (mpscq_dequeue(q, th, &v)) got++;
+        }
+        for (int i = 0; i < producers; ++i) pthread_join(tid[i], NULL);
+    }
+    bench_stop(&s, 2 * total);
+
+    mpscq_unregister(th);
+    mpscq_destroy(q);
+    free(q);
+}
+
+int main(int argc, char **argv) {
+    bench_init(argc, argv);
+    for (int t = 1; t <= MAX_THREADS; t *= 2) {
+        bench_mutex(t);
+        bench_lfq(t);
+        bench_mpsc(t);
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#define _GNU_SOURCE
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include "../ring_buffer.h"
+#include "bench.h"
+
+/*
+ * Producer/consumer throughput and ping-pong latency through the rings, with
+ * the two threads pinned to different CPUs when the machine has more than
+ * one. Spinning sides yield after a failed attempt so the benchmark still
+ * completes on an oversubscribed machine.
+ */
+
+#define RING_ITEMS   (1 << 22)
+#define RING_CAP     1024
+#define RING_BATCH   32
+#define PINGS        100000
+
+typedef enum { MODE_SPSC, MODE_SPSC_BATCH, MODE_MPMC } RingMode;
+
+typedef struct {
+    RingMode mode;
+    SPSCRing spsc;
+    MPMCRing mpmc;
+    int cpu;
+} RingBench;
+
+static void pin_to_cpu(int cpu) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 1) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % (int)ncpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *ring_producer(void *arg) {
+    RingBench *b = (RingBench *)arg;
+    pin_to_cpu(b->cpu);
+    int batch[RING_BATCH];
+    for (size_t i = 0; i < RING_ITEMS;) {
+        size_t done;
+        if (b->mode == MODE_SPSC_BATCH) {
+            size_t n = RING_ITEMS - i < RING_BATCH ? RING_ITEMS - i : RING_BATCH;
+            for (size_t k = 0; k < n; ++k) batch[k] = (int)(i + k);
+            done = spsc_ring_push_n(&b->spsc, batch, n);
+        } else if (b->mode == MODE_SPSC) {
+            done = spsc_ring_push(&b->spsc, (int)i);
+        } else {
+            done = mpmc_ring_push(&b->mpmc, (int)i);
+        }
+        if (done) i += done;
+        else sched_yield();
+    }
+    return NULL;
+}
+
+static void ring_consume(RingBench *b) {
+    int batch[RING_BATCH];
+    long long sum = 0;
+    for (size_t i = 0; i < RING_ITEMS;) {
+        size_t done;
+        if (b->mode == MODE_SPSC_BATCH) {
+            done = spsc_ring_pop_n(&b->spsc, batch, RING_BATCH);
+            for (size_t k = 0; k < done; ++k) sum += batch[k];
+        } else if (b->mode == MODE_SPSC) {
+            done = spsc_ring_pop(&b->spsc, batch);
+            if (done) sum += batch[0];
+        } else {
+            done = mpmc_ring_pop(&b->mpmc, batch);
+            if (done) sum += batch[0];
+        }
+        if (done) i += done;
+        else sched_yield();
+    }
+    bench_consume((uintptr_t)sum);
+}
+
+static void bench_throughput(RingMode mode, const char *name) {
+    RingBench b;
+    b.mode = mode;
+    b.cpu = 1;
+    if (!spsc_ring_init(&b.spsc, RING_CAP)) return;
+    if (!mpmc_ring_init(&b.mpmc, RING_CAP)) { spsc_ring_destroy(&b.spsc); return; }
+    pin_to_cpu(0);
+
+    BenchSection s;
+    bench_start(&s, name);
+    if (s.active) {
+        pthread_t producer;
+        pthread_create(&producer, NULL, ring_producer, &b);
+        ring_consume(&b);
+        pthread_join(producer, NULL);
+    }
+    bench_stop(&s, RING_ITEMS);
+
+    spsc_ring_destroy(&b.spsc);
+    mpmc_ring_destroy(&b.mpmc);
+}
+
+typedef struct {
+    SPSCRing ping;
+    SPSCRing pong;
+} PingPong;
+
+static void *pong_thread(void *arg) {
+    PingPong *pp = (PingPong *)arg;
+    pin_to_cpu(1);
+    int v;
+    for (int i = 0; i < PINGS; ++i) {
+        while (!spsc_ring_pop(&pp->ping, &v)) sched_yield();
+        while (!spsc_ring_push(&pp->pong, v)) sched_yield();
+    }
+    return NULL;
+}
+
+/* Reports one-way latency: half of the measured round trip. */
+static void bench_latency(void) {
+    PingPong pp;
+    if (!spsc_ring_init(&pp.ping, 64)) return;
+    if (!spsc_ring_init(&pp.pong, 64)) { spsc_ring_destroy(&pp.ping); return; }
+    pin_to_cpu(0);
+
+    BenchSection s;
+    bench_start(&s, "ring/spsc_latency_one_way");
+    if (s.active) {
+        pthread_t t;
+        pthread_create(&t, NULL, pong_thread, &pp);
+        int v;
+        for (int i = 0; i < PINGS; ++i) {
+            while (!spsc_ring_push(&pp.ping, i)) sched_yield();
+            while (!spsc_ring_pop(&pp.pong, &v)) sched_yield();
+        }
+        pthread_join(t, NULL);
+    }
+    bench_stop(&s, 2 * PINGS);
+
+    spsc_ring_destroy(&pp.ping);
+    spsc_ring_destroy(&pp.pong);
+}
+
+int main(int argc, char **argv) {
+    bench_init(argc, argv);
+    bench_throughput(MODE_SPSC, "ring/spsc_throughput");
+    bench_throughput(MODE_SPSC_BATCH, "ring/spsc_batch32_throughput");
+    bench_throughput(MODE_MPMC, "ring/mpmc_throughput");
+    bench_latency();
+    return 0;
+}
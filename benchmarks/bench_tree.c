@@ -0,0 +1,704 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "../tree.h"
+#include "../bptree.h"
+#include "../typed_tree.h"
+#include "../frozen_tree.h"
+#include "../persistent_tree.h"
+#include "../concurrent_tree.h"
+#include "../tree_join.h"
+#include "bench.h"
+
+#include <pthread.h>
+
+/*
+ * Ordered-map benchmarks. Keys are inserted in sorted, reverse-sorted and
+ * random order; the first two turn a plain BST into a linked list, so N is
+ * kept small enough for those runs to finish.
+ */
+
+#define BENCH_N 50000
+#define BENCH_SMALL_N 4096
+#define BENCH_LARGE_N 1000000
+#define BENCH_LOOKUPS 1000000
+#define BENCH_SNAPSHOTS 100
+
+static int cmp_uint(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)a, y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+DS_BST_DECLARE(UintTree, uintptr_t, uintptr_t, (a > b) - (a < b))
+
+static void shuffle(uintptr_t *keys, size_t n, uint64_t *seed) {
+    for (size_t i = n; i > 1; --i) {
+        size_t j = (size_t)(bench_rand(seed) % i);
+        uintptr_t tmp = keys[i - 1]; keys[i - 1] = keys[j]; keys[j] = tmp;
+    }
+}
+
+static void fill_keys(uintptr_t *keys, size_t n, const char *order, uint64_t *seed) {
+    for (size_t i = 0; i < n; ++i) keys[i] = i + 1;
+    if (strcmp(order, "reverse") == 0) {
+        for (size_t i = 0; i < n; ++i) keys[i] = n - i;
+    } else if (strcmp(order, "random") == 0) {
+        shuffle(keys, n, seed);
+    }
+}
+
+static void bench_order(const char *mode, bool balanced, const char *order) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%s", mode, order);
+    if (!bench_enabled(name)) return;
+    uint64_t seed = 7;
+    uintptr_t *keys = malloc(BENCH_N * sizeof(*keys));
+    BST *t = balanced ? bst_create_balanced(cmp_uint, NULL, NULL) : bst_create(cmp_uint, NULL, NULL);
+    if (!keys || !t) goto done;
+    fill_keys(keys, BENCH_N, order, &seed);
+
+    BenchSection s;
+    snprintf(name, sizeof(name), "%s_insert/%s", mode, order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) bst_insert(t, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+    snprintf(name, sizeof(name), "%s_get/%s", mode, order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) {
+        bench_consume((uintptr_t)bst_get(t, (void *)keys[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_N);
+
+    snprintf(name, sizeof(name), "%s_remove/%s", mode, order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) bst_remove(t, (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+done:
+    bst_destroy(t);
+    free(keys);
+}
+
+/* The same runs on one thread of the concurrent tree, which rebalances lazily. */
+static void bench_cbst_order(const char *order) {
+    char name[64];
+    snprintf(name, sizeof(name), "cbst/%s", order);
+    if (!bench_enabled(name)) return;
+    uint64_t seed = 7;
+    uintptr_t *keys = malloc(BENCH_N * sizeof(*keys));
+    CBST *t = cbst_create(cmp_uint, NULL, NULL);
+    if (!keys || !t) goto done;
+    fill_keys(keys, BENCH_N, order, &seed);
+    EpochThread *th = cbst_register(t);
+
+    BenchSection s;
+    snprintf(name, sizeof(name), "cbst_insert/%s", order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) cbst_insert(t, th, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+    snprintf(name, sizeof(name), "cbst_get/%s", order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) {
+        bench_consume((uintptr_t)cbst_get(t, th, (void *)keys[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_N);
+
+    snprintf(name, sizeof(name), "cbst_remove/%s", order);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_N; ++i) cbst_remove(t, th, (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+    cbst_unregister(th);
+
+done:
+    cbst_destroy(t);
+    free(keys);
+}
+
+static void count_visit(void *key, void *value, void *user) {
+    (void)key; (void)value;
+    ++*(size_t *)user;
+}
+
+/* AVL against the B+tree at a size where lookups miss in cache. */
+static void bench_bptree(void) {
+    uint64_t seed = 17;
+    uintptr_t *keys = malloc(BENCH_LARGE_N * sizeof(*keys));
+    BST *avl = bst_create_balanced(cmp_uint, NULL, NULL);
+    BPTree *bp = bptree_create(cmp_uint, NULL, NULL);
+    BPTree *bpi = bptree_create(NULL, NULL, NULL);
+    BPTree *bulk = NULL;
+    if (!keys || !avl || !bp || !bpi) goto done;
+    fill_keys(keys, BENCH_LARGE_N, "random", &seed);
+
+    BenchSection s;
+    bench_start(&s, "large/avl_insert");
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bst_insert(avl, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "large/bptree_insert");
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bptree_insert(bp, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "large/bptree_insert_intkeys");
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bptree_insert(bpi, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "large/avl_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bst_get(avl, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "large/bptree_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bptree_get(bp, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "large/bptree_get_intkeys");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bptree_get(bpi, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    size_t visited = 0;
+    bench_start(&s, "large/avl_inorder");
+    bst_inorder(avl, count_visit, &visited);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "large/bptree_inorder");
+    bptree_inorder(bpi, count_visit, &visited);
+    bench_stop(&s, BENCH_LARGE_N);
+    bench_consume(visited);
+
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) keys[i] = i + 1;
+    bench_start(&s, "large/bptree_build_sorted");
+    bulk = bptree_build_sorted(NULL, NULL, NULL, (void *const *)keys, NULL, BENCH_LARGE_N);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "large/bptree_remove_intkeys");
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bptree_remove(bpi, (void *)keys[i]);
+    bench_stop(&s, BENCH_LARGE_N);
+
+done:
+    bptree_destroy(bulk);
+    bptree_destroy(bpi);
+    bptree_destroy(bp);
+    bst_destroy(avl);
+    free(keys);
+}
+
+#define BENCH_RANGES 1000
+#define BENCH_RANGE_SPAN 100
+
+typedef struct {
+    uintptr_t lo, hi;
+    size_t hits;
+} RangeFilter;
+
+static void filter_visit(void *key, void *value, void *user) {
+    RangeFilter *f = (RangeFilter *)user;
+    (void)value;
+    f->hits += (uintptr_t)key >= f->lo && (uintptr_t)key <= f->hi;
+}
+
+/* Short range queries: a full filtered walk against bst_range(). */
+static void bench_range(void) {
+    uint64_t seed = 23;
+    uintptr_t *keys = malloc(BENCH_LARGE_N * sizeof(*keys));
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    if (!keys || !t) goto done;
+    fill_keys(keys, BENCH_LARGE_N, "random", &seed);
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bst_insert(t, (void *)keys[i], (void *)keys[i]);
+
+    BenchSection s;
+    bench_start(&s, "range/inorder_filter");
+    for (size_t i = 0; i < BENCH_RANGES / 100; ++i) {
+        RangeFilter f = { bench_rand(&seed) % BENCH_LARGE_N, 0, 0 };
+        f.hi = f.lo + BENCH_RANGE_SPAN;
+        bst_inorder(t, filter_visit, &f);
+        bench_consume(f.hits);
+    }
+    bench_stop(&s, BENCH_RANGES / 100);
+
+    bench_start(&s, "range/bst_range");
+    for (size_t i = 0; i < BENCH_RANGES; ++i) {
+        uintptr_t lo = bench_rand(&seed) % BENCH_LARGE_N;
+        bench_consume(bst_range(t, (void *)lo, (void *)(lo + BENCH_RANGE_SPAN), NULL, NULL));
+    }
+    bench_stop(&s, BENCH_RANGES);
+
+    bench_start(&s, "range/cursor_next");
+    size_t steps = 0;
+    for (BSTNode *n = bst_first(t); n; n = bst_next(n)) steps++;
+    bench_stop(&s, steps);
+    bench_consume(steps);
+
+done:
+    bst_destroy(t);
+    free(keys);
+}
+
+#define BENCH_STAT_QUERIES 1000
+
+/* Percentile lookups: walking k steps from the first node against bst_select(). */
+static void bench_stats(void) {
+    uint64_t seed = 29;
+    uintptr_t *keys = malloc(BENCH_LARGE_N * sizeof(*keys));
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    if (!keys || !t) goto done;
+    fill_keys(keys, BENCH_LARGE_N, "random", &seed);
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bst_insert(t, (void *)keys[i], (void *)keys[i]);
+
+    BenchSection s;
+    bench_start(&s, "stats/walk_to_p99");
+    for (size_t i = 0; i < BENCH_STAT_QUERIES / 100; ++i) {
+        BSTNode *n = bst_first(t);
+        for (size_t k = BENCH_LARGE_N / 100 * 99; k > 0; --k) n = bst_next(n);
+        bench_consume((uintptr_t)n->key);
+    }
+    bench_stop(&s, BENCH_STAT_QUERIES / 100);
+
+    bench_start(&s, "stats/bst_select_p99");
+    for (size_t i = 0; i < BENCH_STAT_QUERIES; ++i) {
+        bench_consume((uintptr_t)bst_select(t, BENCH_LARGE_N / 100 * 99)->key);
+    }
+    bench_stop(&s, BENCH_STAT_QUERIES);
+
+    bench_start(&s, "stats/bst_rank");
+    for (size_t i = 0; i < BENCH_STAT_QUERIES; ++i) {
+        bench_consume(bst_rank(t, (void *)(bench_rand(&seed) % BENCH_LARGE_N)));
+    }
+    bench_stop(&s, BENCH_STAT_QUERIES);
+
+    bench_start(&s, "stats/bst_count_range_10k");
+    for (size_t i = 0; i < BENCH_STAT_QUERIES; ++i) {
+        uintptr_t lo = bench_rand(&seed) % BENCH_LARGE_N;
+        bench_consume(bst_count_range(t, (void *)lo, (void *)(lo + 10000)));
+    }
+    bench_stop(&s, BENCH_STAT_QUERIES);
+
+    bench_start(&s, "stats/bst_range_10k");
+    for (size_t i = 0; i < BENCH_STAT_QUERIES / 10; ++i) {
+        uintptr_t lo = bench_rand(&seed) % BENCH_LARGE_N;
+        bench_consume(bst_range(t, (void *)lo, (void *)(lo + 10000), NULL, NULL));
+    }
+    bench_stop(&s, BENCH_STAT_QUERIES / 10);
+
+done:
+    bst_destroy(t);
+    free(keys);
+}
+
+/*
+ * Function-pointer BST against the DS_BST_DECLARE specialization, both AVL,
+ * once with a cache-resident tree and once with one that is not.
+ */
+static void bench_typed(size_t n) {
+    uint64_t seed = 31;
+    uintptr_t *keys = malloc(n * sizeof(*keys));
+    BST *avl = bst_create_balanced(cmp_uint, NULL, NULL);
+    UintTree *typed = UintTree_create();
+    if (!keys || !avl || !typed) goto done;
+    fill_keys(keys, n, "random", &seed);
+
+    BenchSection s;
+    char name[64];
+    snprintf(name, sizeof(name), "typed/bst_insert/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < n; ++i) bst_insert(avl, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, n);
+
+    snprintf(name, sizeof(name), "typed/UintTree_insert/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < n; ++i) UintTree_insert(typed, keys[i], keys[i]);
+    bench_stop(&s, n);
+
+    snprintf(name, sizeof(name), "typed/bst_get/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bst_get(avl, (void *)keys[bench_rand(&seed) % n]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    snprintf(name, sizeof(name), "typed/UintTree_get/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume(*UintTree_get(typed, keys[bench_rand(&seed) % n]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    snprintf(name, sizeof(name), "typed/bst_remove/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < n; ++i) bst_remove(avl, (void *)keys[i]);
+    bench_stop(&s, n);
+
+    snprintf(name, sizeof(name), "typed/UintTree_remove/n=%zu", n);
+    bench_start(&s, name);
+    for (size_t i = 0; i < n; ++i) UintTree_remove(typed, keys[i]);
+    bench_stop(&s, n);
+
+done:
+    UintTree_destroy(typed);
+    bst_destroy(avl);
+    free(keys);
+}
+
+/* Read-only lookups: pointer BST, B+tree and the Eytzinger copy. */
+static void bench_frozen(void) {
+    uint64_t seed = 37;
+    uintptr_t *keys = malloc(BENCH_LARGE_N * sizeof(*keys));
+    BST *avl = bst_create_balanced(cmp_uint, NULL, NULL);
+    FrozenTree *ft = NULL, *ftc = NULL;
+    if (!keys || !avl) goto done;
+    fill_keys(keys, BENCH_LARGE_N, "random", &seed);
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bst_insert(avl, (void *)keys[i], (void *)keys[i]);
+
+    BenchSection s;
+    bench_start(&s, "frozen/bst_freeze");
+    ft = bst_freeze(avl, NULL);
+    bench_stop(&s, BENCH_LARGE_N);
+    ftc = bst_freeze(avl, cmp_uint);
+    if (!ft || !ftc) goto done;
+
+    bench_start(&s, "frozen/bst_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bst_get(avl, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "frozen/frozen_tree_get_cmp");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)frozen_tree_get(ftc, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "frozen/frozen_tree_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)frozen_tree_get(ft, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    if (bench_enabled("frozen/save_load")) {
+        const char *path = "bench_tree.ftree";
+        FrozenTree *mapped = frozen_tree_save(ft, path) ? frozen_tree_load(path, NULL) : NULL;
+        if (mapped) {
+            bench_start(&s, "frozen/save_load/mapped_get");
+            for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+                bench_consume((uintptr_t)frozen_tree_get(mapped, (void *)keys[bench_rand(&seed) % BENCH_LARGE_N]));
+            }
+            bench_stop(&s, BENCH_LOOKUPS);
+        }
+        frozen_tree_destroy(mapped);
+        remove(path);
+    }
+
+done:
+    frozen_tree_destroy(ftc);
+    frozen_tree_destroy(ft);
+    bst_destroy(avl);
+    free(keys);
+}
+
+static void copy_visit(void *key, void *value, void *user) {
+    bst_insert((BST *)user, key, value);
+}
+
+/* Consistent read views: copying the whole tree vs a persistent snapshot. */
+static void bench_persist(void) {
+    uint64_t seed = 41;
+    uintptr_t *keys = malloc(BENCH_N * sizeof(*keys));
+    BST *avl = bst_create_balanced(cmp_uint, NULL, NULL);
+    PTree *pt = ptree_create(cmp_uint, NULL, NULL);
+    EpochThread *th = pt ? ptree_register(pt) : NULL;
+    if (!keys || !avl || !th) goto done;
+    fill_keys(keys, BENCH_N, "random", &seed);
+
+    BenchSection s;
+    bench_start(&s, "persist/avl_insert");
+    for (size_t i = 0; i < BENCH_N; ++i) bst_insert(avl, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+    bench_start(&s, "persist/ptree_insert");
+    for (size_t i = 0; i < BENCH_N; ++i) ptree_insert(pt, th, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+    bench_start(&s, "persist/avl_copy");
+    for (size_t i = 0; i < BENCH_SNAPSHOTS; ++i) {
+        BST *copy = bst_create_balanced(cmp_uint, NULL, NULL);
+        bst_inorder(avl, copy_visit, copy);
+        bench_consume(bst_size(copy));
+        bst_destroy(copy);
+    }
+    bench_stop(&s, BENCH_SNAPSHOTS);
+
+    bench_start(&s, "persist/ptree_snapshot");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        PTreeSnapshot *snap = ptree_snapshot(pt, th);
+        bench_consume(ptree_snapshot_size(snap));
+        ptree_snapshot_release(snap);
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "persist/avl_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)bst_get(avl, (void *)keys[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    PTreeSnapshot *snap = ptree_snapshot(pt, th);
+    bench_start(&s, "persist/ptree_snapshot_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)ptree_snapshot_get(snap, (void *)keys[bench_rand(&seed) % BENCH_N]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    /* Updates while an old version is held copy their whole path. */
+    bench_start(&s, "persist/ptree_remove_held");
+    for (size_t i = 0; i < BENCH_N; ++i) ptree_remove(pt, th, (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+    ptree_snapshot_release(snap);
+
+    bench_start(&s, "persist/avl_remove");
+    for (size_t i = 0; i < BENCH_N; ++i) bst_remove(avl, (void *)keys[i]);
+    bench_stop(&s, BENCH_N);
+
+done:
+    if (th) ptree_unregister(th);
+    ptree_destroy(pt);
+    bst_destroy(avl);
+    free(keys);
+}
+
+#define BENCH_SHARED_KEYS 100000
+#define BENCH_SHARED_OPS (1 << 21)
+#define BENCH_MAX_THREADS 8
+
+/*
+ * Mixed workload on one shared ordered map: 90% lookups, 10% inserts and
+ * removes split evenly, over random keys. The baseline is an AVL BST behind
+ * a pthread_rwlock.
+ */
+typedef struct {
+    const uintptr_t *keys;
+    size_t iters;
+    uint64_t seed;
+    CBST *ct;
+    BST *t;
+    pthread_rwlock_t *lock;
+} SharedArgs;
+
+static void *shared_worker(void *arg) {
+    SharedArgs *a = (SharedArgs *)arg;
+    EpochThread *th = a->ct ? cbst_register(a->ct) : NULL;
+    uintptr_t hits = 0;
+    for (size_t i = 0; i < a->iters; ++i) {
+        uint64_t r = bench_rand(&a->seed);
+        void *k = (void *)a->keys[(r >> 8) % BENCH_SHARED_KEYS];
+        unsigned op = (unsigned)(r % 100);
+        if (a->ct) {
+            if (op < 90) hits += cbst_get(a->ct, th, k) != NULL;
+            else if (op < 95) cbst_insert(a->ct, th, k, k);
+            else cbst_remove(a->ct, th, k);
+        } else if (op < 90) {
+            pthread_rwlock_rdlock(a->lock);
+            hits += bst_get(a->t, k) != NULL;
+            pthread_rwlock_unlock(a->lock);
+        } else {
+            pthread_rwlock_wrlock(a->lock);
+            if (op < 95) bst_insert(a->t, k, k);
+            else bst_remove(a->t, k);
+            pthread_rwlock_unlock(a->lock);
+        }
+    }
+    if (th) cbst_unregister(th);
+    bench_consume(hits);
+    return NULL;
+}
+
+static void run_shared(const char *name, SharedArgs *proto, int nthreads) {
+    pthread_t tid[BENCH_MAX_THREADS];
+    SharedArgs args[BENCH_MAX_THREADS];
+    BenchSection s;
+    bench_start(&s, name);
+    if (!s.active) return;
+    for (int i = 0; i < nthreads; ++i) {
+        args[i] = *proto;
+        args[i].iters = BENCH_SHARED_OPS / (size_t)nthreads;
+        args[i].seed = 1000 + (uint64_t)i;
+        pthread_create(&tid[i], NULL, shared_worker, &args[i]);
+    }
+    for (int i = 0; i < nthreads; ++i) pthread_join(tid[i], NULL);
+    bench_stop(&s, BENCH_SHARED_OPS);
+}
+
+static void bench_concurrent(void) {
+    uint64_t seed = 43;
+    uintptr_t *keys = malloc(BENCH_SHARED_KEYS * sizeof(*keys));
+    CBST *ct = cbst_create(cmp_uint, NULL, NULL);
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    pthread_rwlock_t lock;
+    pthread_rwlock_init(&lock, NULL);
+    if (!keys || !ct || !t) goto done;
+    fill_keys(keys, BENCH_SHARED_KEYS, "random", &seed);
+
+    EpochThread *th = cbst_register(ct);
+    for (size_t i = 0; i < BENCH_SHARED_KEYS; i += 2) {
+        cbst_insert(ct, th, (void *)keys[i], (void *)keys[i]);
+        bst_insert(t, (void *)keys[i], (void *)keys[i]);
+    }
+    cbst_unregister(th);
+
+    for (int n = 1; n <= BENCH_MAX_THREADS; n *= 2) {
+        char name[64];
+        SharedArgs rw = { keys, 0, 0, NULL, t, &lock };
+        snprintf(name, sizeof(name), "shared/avl_rwlock/t=%d", n);
+        run_shared(name, &rw, n);
+
+        SharedArgs lf = { keys, 0, 0, ct, NULL, NULL };
+        snprintf(name, sizeof(name), "shared/cbst/t=%d", n);
+        run_shared(name, &lf, n);
+    }
+
+done:
+    pthread_rwlock_destroy(&lock);
+    bst_destroy(t);
+    cbst_destroy(ct);
+    free(keys);
+}
+
+static void insert_visit(void *key, void *value, void *user) {
+    bst_insert((BST *)user, key, value);
+}
+
+typedef struct {
+    BST *probe;
+    BST *out;
+} IntersectArgs;
+
+static void intersect_visit(void *key, void *value, void *user) {
+    IntersectArgs *a = (IntersectArgs *)user;
+    if (bst_get(a->probe, key)) bst_insert(a->out, key, value);
+}
+
+static void remove_visit(void *key, void *value, void *user) {
+    (void)value;
+    bst_remove((BST *)user, key);
+}
+
+/* a holds multiples of 2, b multiples of 3 (stride * i), so a third overlap. */
+static BST *build_stride(uintptr_t *keys, size_t n, uintptr_t stride) {
+    for (size_t i = 0; i < n; ++i) keys[i] = (i + 1) * stride;
+    return bst_build_sorted(cmp_uint, NULL, NULL, (void *const *)keys, (void *const *)keys, n);
+}
+
+/* Bulk set operations: join-based vs a get/insert/remove loop over b. */
+static void bench_setops(size_t n, size_t m) {
+    char name[64];
+    uintptr_t *keys = malloc(n * sizeof(*keys));
+    if (!keys) return;
+    static const char *const ops[] = { "union", "intersect", "difference" };
+    for (int op = 0; op < 3; ++op) {
+        BenchSection s;
+        BST *a = build_stride(keys, n, 2), *b = build_stride(keys, m, 3);
+        BST *out = bst_create_balanced(cmp_uint, NULL, NULL);
+        if (!a || !b || !out) goto next;
+        snprintf(name, sizeof(name), "setops/%s_loop/m=%zu", ops[op], m);
+        bench_start(&s, name);
+        if (op == 0) {
+            bst_inorder(b, insert_visit, a);
+        } else if (op == 1) {
+            IntersectArgs args = { a, out };
+            bst_inorder(b, intersect_visit, &args);
+        } else {
+            bst_inorder(b, remove_visit, a);
+        }
+        bench_stop(&s, m);
+        bst_destroy(a);
+        bst_destroy(b);
+
+        a = build_stride(keys, n, 2);
+        b = build_stride(keys, m, 3);
+        if (!a || !b) goto next;
+        snprintf(name, sizeof(name), "setops/bst_%s/m=%zu", ops[op], m);
+        bench_start(&s, name);
+        if (op == 0) bst_union(a, b);
+        else if (op == 1) bst_intersect(a, b);
+        else bst_difference(a, b);
+        bench_stop(&s, m);
+        bench_consume(bst_size(a));
+next:
+        bst_destroy(out);
+        bst_destroy(a);
+        bst_destroy(b);
+    }
+    free(keys);
+}
+
+static void bench_build(void) {
+    uintptr_t *keys = malloc(BENCH_LARGE_N * sizeof(*keys));
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    if (!keys || !t) goto done;
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) keys[i] = i + 1;
+
+    BenchSection s;
+    bench_start(&s, "setops/insert_sorted");
+    for (size_t i = 0; i < BENCH_LARGE_N; ++i) bst_insert(t, (void *)keys[i], (void *)keys[i]);
+    bench_stop(&s, BENCH_LARGE_N);
+
+    bench_start(&s, "setops/bst_build_sorted");
+    BST *built = bst_build_sorted(cmp_uint, NULL, NULL, (void *const *)keys, (void *const *)keys,
+                                  BENCH_LARGE_N);
+    bench_stop(&s, BENCH_LARGE_N);
+    bench_consume(bst_size(built));
+    bst_destroy(built);
+
+done:
+    bst_destroy(t);
+    free(keys);
+}
+
+int main(int argc, char **argv) {
+    bench_init(argc, argv);
+    static const char *const orders[] = { "sorted", "reverse", "random" };
+    for (int i = 0; i < 3; ++i) {
+        bench_order("bst", false, orders[i]);
+        bench_order("avl", true, orders[i]);
+        bench_cbst_order(orders[i]);
+    }
+    bench_bptree();
+    bench_range();
+    bench_stats();
+    bench_typed(BENCH_SMALL_N);
+    bench_typed(BENCH_LARGE_N);
+    bench_frozen();
+    bench_persist();
+    bench_concurrent();
+    bench_build();
+    bench_setops(BENCH_LARGE_N, BENCH_LARGE_N);
+    bench_setops(BENCH_LARGE_N, 1000);
+    return 0;
+}
@@ -0,0 +1,589 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <pthread.h>
+#include "../ds.h"
+#include "../radix_trie.h"
+#include "../art.h"
+#include "../frozen_trie.h"
+#include "../aho_corasick.h"
+#include "../concurrent_trie.h"
+#include "bench.h"
+
+#define BENCH_WORDS   200000
+#define BENCH_LOOKUPS 1000000
+#define BENCH_SCANS   10000
+
+/*
+ * URL-like keys: a handful of shared hosts and path segments followed by a
+ * random tail, so there are long single-child chains for the radix trie to
+ * collapse.
+ */
+static char **make_urls(size_t n, uint64_t *seed) {
+    static const char *const hosts[] = {
+        "httpswwwexamplecom", "httpsdocsexampleorg", "httpapiservicenet", "httpscdnstaticio"
+    };
+    static const char *const dirs[] = {
+        "articles", "products", "users", "images", "search", "assets"
+    };
+    char **words = malloc(n * sizeof(*words));
+    if (!words) return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        char buf[96];
+        int len = snprintf(buf, sizeof(buf), "%s%s%s",
+                           hosts[bench_rand(seed) % 4], dirs[bench_rand(seed) % 6],
+                           dirs[bench_rand(seed) % 6]);
+        int tail = 8 + (int)(bench_rand(seed) % 16);
+        for (int k = 0; k < tail && len < (int)sizeof(buf) - 1; ++k) {
+            buf[len++] = (char)('a' + bench_rand(seed) % 26);
+        }
+        buf[len] = '\0';
+        words[i] = strdup(buf);
+    }
+    return words;
+}
+
+static void free_words(char **words, size_t n) {
+    for (size_t i = 0; i < n; ++i) free(words[i]);
+    free(words);
+}
+
+static size_t trie_node_count(const TrieNode *n) {
+    if (!n) return 0;
+    size_t count = 1;
+    for (int i = 0; i < TRIE_ALPHABET; ++i) count += trie_node_count(n->child[i]);
+    return count;
+}
+
+static void bench_radix(void) {
+    uint64_t seed = 11;
+    char **words = make_urls(BENCH_WORDS, &seed);
+    Trie *t = trie_create(NULL);
+    RadixTrie *r = radix_trie_create(NULL);
+    if (!words || !t || !r) goto done;
+
+    BenchSection s;
+    bench_start(&s, "trie_insert/urls");
+    for (size_t i = 0; i < BENCH_WORDS; ++i) trie_insert(t, words[i], words[i]);
+    bench_stop(&s, BENCH_WORDS);
+
+    bench_start(&s, "radix_trie_insert/urls");
+    for (size_t i = 0; i < BENCH_WORDS; ++i) radix_trie_insert(r, words[i], words[i]);
+    bench_stop(&s, BENCH_WORDS);
+
+    bench_start(&s, "trie_get/urls");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)trie_get(t, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "radix_trie_get/urls");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)radix_trie_get(r, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    if (bench_enabled("memory")) {
+        size_t trie_bytes = trie_node_count(t->root) * sizeof(TrieNode);
+        size_t radix_bytes = radix_trie_memory(r);
+        printf("memory/trie %zu bytes, memory/radix_trie %zu bytes (%.1fx smaller)\n",
+               trie_bytes, radix_bytes, (double)trie_bytes / (double)radix_bytes);
+    }
+
+done:
+    radix_trie_destroy(r);
+    trie_destroy(t);
+    if (words) free_words(words, BENCH_WORDS);
+}
+
+/* Random lowercase words of 4..15 letters, so Trie sees every byte. */
+static char **make_words(size_t n, uint64_t *seed) {
+    char **words = malloc(n * sizeof(*words));
+    if (!words) return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        char buf[16];
+        int len = 4 + (int)(bench_rand(seed) % 12);
+        for (int k = 0; k < len; ++k) buf[k] = (char)('a' + bench_rand(seed) % 26);
+        buf[len] = '\0';
+        words[i] = strdup(buf);
+    }
+    return words;
+}
+
+static size_t trie_count_below(const TrieNode *n) {
+    if (!n) return 0;
+    size_t count = n->terminal;
+    for (int i = 0; i < TRIE_ALPHABET; ++i) count += trie_count_below(n->child[i]);
+    return count;
+}
+
+static size_t trie_prefix_count(const Trie *t, const char *prefix) {
+    const TrieNode *cur = t->root;
+    for (const char *p = prefix; *p && cur; ++p) cur = cur->child[trie_idx(*p)];
+    return trie_count_below(cur);
+}
+
+static bool art_count_visit(const unsigned char *key, size_t len, void *value, void *user) {
+    (void)key; (void)len; (void)value;
+    (*(size_t *)user)++;
+    return true;
+}
+
+static void bench_art(void) {
+    uint64_t seed = 23;
+    char **words = make_words(BENCH_WORDS, &seed);
+    Hashmap *map = hashmap_create(BENCH_WORDS);
+    Trie *t = trie_create(NULL);
+    ArtTree *art = art_create(NULL);
+    if (!words || !map || !t || !art) goto done;
+    for (size_t i = 0; i < BENCH_WORDS; ++i) {
+        hashmap_insert(map, words[i], words[i]);
+        trie_insert(t, words[i], words[i]);
+    }
+
+    BenchSection s;
+    bench_start(&s, "art_insert/words");
+    for (size_t i = 0; i < BENCH_WORDS; ++i) art_insert(art, words[i], strlen(words[i]), words[i]);
+    bench_stop(&s, BENCH_WORDS);
+
+    bench_start(&s, "point/hashmap_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)hashmap_get(map, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "point/trie_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)trie_get(t, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "point/art_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        const char *w = words[bench_rand(&seed) % BENCH_WORDS];
+        bench_consume((uintptr_t)art_get(art, w, strlen(w)));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    /* Three-letter prefixes match about 11 words each. */
+    char (*prefixes)[4] = malloc(BENCH_SCANS * sizeof(*prefixes));
+    if (!prefixes) goto done;
+    for (size_t i = 0; i < BENCH_SCANS; ++i) {
+        for (int k = 0; k < 3; ++k) prefixes[i][k] = (char)('a' + bench_rand(&seed) % 26);
+        prefixes[i][3] = '\0';
+    }
+
+    bench_start(&s, "prefix/hashmap_full_scan");
+    for (size_t i = 0; i < BENCH_SCANS / 100; ++i) {
+        size_t count = 0;
+        for (size_t b = 0; b < map->size; ++b) {
+            for (HashmapEntry *e = map->buckets[b]; e; e = e->next) {
+                count += strncmp(e->key, prefixes[i], 3) == 0;
+            }
+        }
+        bench_consume(count);
+    }
+    bench_stop(&s, BENCH_SCANS / 100);
+
+    bench_start(&s, "prefix/trie_walk");
+    for (size_t i = 0; i < BENCH_SCANS; ++i) bench_consume(trie_prefix_count(t, prefixes[i]));
+    bench_stop(&s, BENCH_SCANS);
+
+    bench_start(&s, "prefix/art_prefix_scan");
+    for (size_t i = 0; i < BENCH_SCANS; ++i) {
+        size_t count = 0;
+        art_prefix_scan(art, prefixes[i], 3, art_count_visit, &count);
+        bench_consume(count);
+    }
+    bench_stop(&s, BENCH_SCANS);
+    free(prefixes);
+
+done:
+    art_destroy(art);
+    trie_destroy(t);
+    if (map) hashmap_destroy(map);
+    if (words) free_words(words, BENCH_WORDS);
+}
+
+static void bench_frozen(void) {
+    uint64_t seed = 31;
+    char **words = make_words(BENCH_WORDS, &seed);
+    Trie *t = trie_create(NULL);
+    FrozenTrie *ft = NULL;
+    if (!words || !t) goto done;
+    for (size_t i = 0; i < BENCH_WORDS; ++i) trie_insert(t, words[i], words[i]);
+
+    BenchSection s;
+    bench_start(&s, "trie_freeze/words");
+    ft = trie_freeze(t);
+    bench_stop(&s, BENCH_WORDS);
+    if (!ft) goto done;
+
+    bench_start(&s, "frozen/trie_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)trie_get(t, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    bench_start(&s, "frozen/frozen_trie_get");
+    for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+        bench_consume((uintptr_t)frozen_trie_get(ft, words[bench_rand(&seed) % BENCH_WORDS]));
+    }
+    bench_stop(&s, BENCH_LOOKUPS);
+
+    if (bench_enabled("memory")) {
+        printf("memory/trie %zu bytes, memory/frozen_trie %zu bytes\n",
+               trie_node_count(t->root) * sizeof(TrieNode), ft->mem_len);
+    }
+
+done:
+    frozen_trie_destroy(ft);
+    trie_destroy(t);
+    if (words) free_words(words, BENCH_WORDS);
+}
+
+static void bench_autocomplete(void) {
+    uint64_t seed = 37;
+    char **words = make_words(BENCH_WORDS, &seed);
+    Trie *t = trie_create_ranked(NULL, 10);
+    if (!words || !t) goto done;
+
+    BenchSection s;
+    bench_start(&s, "trie_insert_scored/words");
+    for (size_t i = 0; i < BENCH_WORDS; ++i) {
+        trie_insert_scored(t, words[i], words[i], (double)(bench_rand(&seed) % 100000));
+    }
+    bench_stop(&s, BENCH_WORDS);
+
+    /* Two-letter prefixes match about 300 words each. */
+    char prefixes[64][3];
+    for (int i = 0; i < 64; ++i) {
+        prefixes[i][0] = (char)('a' + bench_rand(&seed) % 26);
+        prefixes[i][1] = (char)('a' + bench_rand(&seed) % 26);
+        prefixes[i][2] = '\0';
+    }
+
+    bench_start(&s, "autocomplete/iter_all");
+    for (size_t i = 0; i < BENCH_SCANS; ++i) {
+        TrieIter it;
+        const char *w;
+        size_t count = 0;
+        trie_iter_init(&it, t, prefixes[i % 64]);
+        while (trie_iter_next(&it, &w, NULL)) count++;
+        trie_iter_destroy(&it);
+        bench_consume(count);
+    }
+    bench_stop(&s, BENCH_SCANS);
+
+    bench_start(&s, "autocomplete/top_10");
+    for (size_t i = 0; i < BENCH_SCANS; ++i) {
+        TrieCompletion out[10];
+        bench_consume(trie_top_k(t, prefixes[i % 64], 10, out));
+    }
+    bench_stop(&s, BENCH_SCANS);
+
+done:
+    trie_destroy(t);
+    if (words) free_words(words, BENCH_WORDS);
+}
+
+#define BENCH_TEXT     (4u << 20)
+#define BENCH_KEYWORDS 5000
+
+static bool count_match(size_t start, size_t len, void *value, void *user) {
+    (void)start; (void)len; (void)value;
+    (*(size_t *)user)++;
+    return true;
+}
+
+static void bench_matcher(void) {
+    uint64_t seed = 41;
+    char **keywords = make_words(BENCH_KEYWORDS, &seed);
+    char *text = malloc(BENCH_TEXT);
+    Trie *t = trie_create(NULL);
+    AcMatcher *m = NULL;
+    if (!keywords || !text || !t) goto done;
+    for (size_t i = 0; i < BENCH_KEYWORDS; ++i) trie_insert(t, keywords[i], keywords[i]);
+    /* Letters drawn from a small alphabet so keywords actually occur. */
+    for (size_t i = 0; i < BENCH_TEXT; ++i) {
+        uint64_t r = bench_rand(&seed);
+        text[i] = (r % 8 == 0) ? ' ' : (char)('a' + (r >> 8) % 6);
+    }
+
+    BenchSection s;
+    bench_start(&s, "matcher/trie_probe_each_offset");
+    size_t found = 0;
+    for (size_t i = 0; i < BENCH_TEXT; ++i) {
+        const TrieNode *cur = t->root;
+        for (size_t j = i; j < BENCH_TEXT && cur; ++j) {
+            int id = trie_idx(text[j]);
+            if (id < 0) break;
+            cur = cur->child[id];
+            if (cur && cur->terminal) found++;
+        }
+    }
+    bench_consume(found);
+    bench_stop(&s, BENCH_TEXT);
+
+    bench_start(&s, "matcher/trie_build_matcher");
+    m = trie_build_matcher(t);
+    bench_stop(&s, BENCH_KEYWORDS);
+    if (!m) goto done;
+
+    bench_start(&s, "matcher/ac_stream_match_64k");
+    AcStream st;
+    ac_stream_init(&st, m);
+    size_t matches = 0;
+    for (size_t off = 0; off < BENCH_TEXT; off += 65536) {
+        ac_stream_match(&st, text + off, 65536, count_match, &matches);
+    }
+    bench_consume(matches);
+    bench_stop(&s, BENCH_TEXT);
+
+done:
+    ac_matcher_destroy(m);
+    trie_destroy(t);
+    free(text);
+    if (keywords) free_words(keywords, BENCH_KEYWORDS);
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void bench_bulk(void) {
+    uint64_t seed = 47;
+    char **words = make_words(BENCH_WORDS, &seed);
+    if (!words) return;
+    qsort(words, BENCH_WORDS, sizeof(*words), cmp_str);
+
+    BenchSection s;
+    bench_start(&s, "bulk/trie_insert_sorted");
+    Trie *a = trie_create(NULL);
+    for (size_t i = 0; a && i < BENCH_WORDS; ++i) trie_insert(a, words[i], words[i]);
+    bench_stop(&s, BENCH_WORDS);
+
+    bench_start(&s, "bulk/trie_build_sorted");
+    Trie *b = trie_build_sorted((const char *const *)words, (void *const *)words, BENCH_WORDS, NULL);
+    bench_stop(&s, BENCH_WORDS);
+
+    bench_start(&s, "bulk/destroy_per_node");
+    trie_destroy(a);
+    bench_stop(&s, BENCH_WORDS);
+
+    /* Time slices of 10k nodes, as a caller spreading teardown over frames would. */
+    bench_start(&s, "bulk/destroy_step_blocks");
+    size_t slices = 1;
+    while (!trie_destroy_step(b, 10000)) slices++;
+    bench_stop(&s, BENCH_WORDS);
+    bench_consume(slices);
+
+    free_words(words, BENCH_WORDS);
+}
+
+#define BENCH_DICT_WORDS 1000000
+#define BENCH_FUZZY_QUERIES 200
+
+/* Pronounceable words from a syllable set, so the dictionary shares prefixes. */
+static char **make_dictionary(size_t n, uint64_t *seed) {
+    static const char *const syl[] = {
+        "ka", "ri", "to", "men", "sa", "lo", "ve", "dar", "ni", "po", "que", "ta",
+        "bel", "mi", "ro", "su", "gan", "le", "fo", "tin", "ce", "da", "mor", "pi",
+        "stra", "ne", "vo", "li", "ber", "co", "ha", "nu"
+    };
+    char **words = malloc(n * sizeof(*words));
+    if (!words) return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        char buf[32] = "";
+        int parts = 2 + (int)(bench_rand(seed) % 4);
+        for (int k = 0; k < parts; ++k) strcat(buf, syl[bench_rand(seed) % 32]);
+        words[i] = strdup(buf);
+    }
+    return words;
+}
+
+static size_t levenshtein(const char *a, const char *b, size_t *row) {
+    size_t la = strlen(a), lb = strlen(b);
+    for (size_t j = 0; j <= lb; ++j) row[j] = j;
+    for (size_t i = 1; i <= la; ++i) {
+        size_t diag = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= lb; ++j) {
+            size_t up = row[j];
+            size_t v = diag + (a[i - 1] != b[j - 1]);
+            if (up + 1 < v) v = up + 1;
+            if (row[j - 1] + 1 < v) v = row[j - 1] + 1;
+            row[j] = v;
+            diag = up;
+        }
+    }
+    return row[lb];
+}
+
+static void bench_fuzzy(void) {
+    if (!bench_enabled("fuzzy")) return;
+    uint64_t seed = 43;
+    char **dict = make_dictionary(BENCH_DICT_WORDS, &seed);
+    Trie *t = trie_create(NULL);
+    char (*queries)[32] = malloc(BENCH_FUZZY_QUERIES * sizeof(*queries));
+    if (!dict || !t || !queries) goto done;
+    for (size_t i = 0; i < BENCH_DICT_WORDS; ++i) trie_insert(t, dict[i], NULL);
+
+    /* Dictionary words with one letter changed. */
+    for (size_t i = 0; i < BENCH_FUZZY_QUERIES; ++i) {
+        strcpy(queries[i], dict[bench_rand(&seed) % BENCH_DICT_WORDS]);
+        size_t len = strlen(queries[i]);
+        queries[i][bench_rand(&seed) % len] = (char)('a' + bench_rand(&seed) % 26);
+    }
+
+    BenchSection s;
+    size_t row[64];
+    bench_start(&s, "fuzzy/brute_force_d2");
+    for (size_t i = 0; i < BENCH_FUZZY_QUERIES / 20; ++i) {
+        size_t hits = 0;
+        for (size_t w = 0; w < BENCH_DICT_WORDS; ++w) hits += levenshtein(dict[w], queries[i], row) <= 2;
+        bench_consume(hits);
+    }
+    bench_stop(&s, BENCH_FUZZY_QUERIES / 20);
+
+    for (size_t d = 1; d <= 2; ++d) {
+        bench_start(&s, d == 1 ? "fuzzy/trie_fuzzy_search_d1" : "fuzzy/trie_fuzzy_search_d2");
+        for (size_t i = 0; i < BENCH_FUZZY_QUERIES; ++i) {
+            bench_consume(trie_fuzzy_search(t, queries[i], d, NULL, NULL));
+        }
+        bench_stop(&s, BENCH_FUZZY_QUERIES);
+    }
+
+done:
+    free(queries);
+    trie_destroy(t);
+    if (dict) free_words(dict, BENCH_DICT_WORDS);
+}
+
+#define BENCH_SHARED_OPS (1 << 21)
+#define BENCH_MAX_THREADS 8
+
+/*
+ * Read-mostly mix on one shared dictionary: 95% lookups, 5% inserts and
+ * removes split evenly. The baseline is a Trie behind a pthread_rwlock.
+ */
+typedef struct {
+    char **words;
+    size_t iters;
+    uint64_t seed;
+    CTrie *ct;
+    Trie *t;
+    pthread_rwlock_t *lock;
+} SharedArgs;
+
+static void *shared_worker(void *arg) {
+    SharedArgs *a = (SharedArgs *)arg;
+    EpochThread *th = a->ct ? ctrie_register(a->ct) : NULL;
+    uintptr_t hits = 0;
+    for (size_t i = 0; i < a->iters; ++i) {
+        uint64_t r = bench_rand(&a->seed);
+        const char *w = a->words[(r >> 8) % BENCH_WORDS];
+        unsigned op = (unsigned)(r % 100);
+        if (a->ct) {
+            if (op < 95) hits += ctrie_get(a->ct, th, w) != NULL;
+            else if (op < 98) ctrie_insert(a->ct, th, w, (void *)w);
+            else ctrie_remove(a->ct, th, w);
+        } else if (op < 95) {
+            pthread_rwlock_rdlock(a->lock);
+            hits += trie_get(a->t, w) != NULL;
+            pthread_rwlock_unlock(a->lock);
+        } else {
+            pthread_rwlock_wrlock(a->lock);
+            if (op < 98) trie_insert(a->t, w, (void *)w);
+            else trie_remove(a->t, w);
+            pthread_rwlock_unlock(a->lock);
+        }
+    }
+    if (th) ctrie_unregister(th);
+    bench_consume(hits);
+    return NULL;
+}
+
+static void run_shared(const char *name, SharedArgs *proto, int nthreads) {
+    pthread_t tid[BENCH_MAX_THREADS];
+    SharedArgs args[BENCH_MAX_THREADS];
+    BenchSection s;
+    bench_start(&s, name);
+    if (!s.active) return;
+    for (int i = 0; i < nthreads; ++i) {
+        args[i] = *proto;
+        args[i].iters = BENCH_SHARED_OPS / (size_t)nthreads;
+        args[i].seed = 1000 + (uint64_t)i;
+        pthread_create(&tid[i], NULL, shared_worker, &args[i]);
+    }
+    for (int i = 0; i < nthreads; ++i) pthread_join(tid[i], NULL);
+    bench_stop(&s, BENCH_SHARED_OPS);
+}
+
+static void bench_concurrent(void) {
+    uint64_t seed = 53;
+    char **words = make_words(BENCH_WORDS, &seed);
+    CTrie *ct = ctrie_create(NULL);
+    Trie *t = trie_create(NULL);
+    pthread_rwlock_t lock;
+    pthread_rwlock_init(&lock, NULL);
+    if (!words || !ct || !t) goto done;
+
+    EpochThread *th = ctrie_register(ct);
+    for (size_t i = 0; i < BENCH_WORDS; i += 2) {
+        ctrie_insert(ct, th, words[i], words[i]);
+        trie_insert(t, words[i], words[i]);
+    }
+    ctrie_unregister(th);
+
+    for (int n = 1; n <= BENCH_MAX_THREADS; n *= 2) {
+        char name[64];
+        SharedArgs rw = { words, 0, 0, NULL, t, &lock };
+        snprintf(name, sizeof(name), "shared/trie_rwlock/t=%d", n);
+        run_shared(name, &rw, n);
+
+        SharedArgs lf = { words, 0, 0, ct, NULL, NULL };
+        snprintf(name, sizeof(name), "shared/ctrie/t=%d", n);
+        run_shared(name, &lf, n);
+    }
+
+done:
+    pthread_rwlock_destroy(&lock);
+    trie_destroy(t);
+    ctrie_destroy(ct);
+    if (words) free_words(words, BENCH_WORDS);
+}
+
+int main(int argc, char **argv) {
+    bench_init(argc, argv);
+    bench_radix();
+    bench_art();
+    bench_frozen();
+    bench_autocomplete();
+    bench_matcher();
+    bench_bulk();
+    bench_fuzzy();
+    bench_concurrent();
+    return 0;
+}
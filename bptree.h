@@ -0,0 +1,596 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef BPTREE_H
+#define BPTREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tree.h"
+
+/*
+ * B+tree ordered map with the same operations as BST.
+ *
+ * Each node holds up to BPTREE_ORDER keys inline, so one lookup touches
+ * about log_16(n) nodes instead of log_2(n). All entries live in the leaves.
+ * Leaves are chained left to right, so bptree_inorder() and bptree_range()
+ * scan leaves in sequence and never walk back up the tree.
+ *
+ * If `cmp` is NULL, keys are uintptr_t values compared directly. A node is
+ * then searched by counting the keys that are smaller than the target. That
+ * loop has no branches or calls, so the compiler vectorizes it. With a `cmp`,
+ * each node is binary-searched through the callback.
+ *
+ * Separators in inner nodes are not copies: each one is the pointer of a key
+ * that is still stored in a leaf. Before a key is freed or replaced, any
+ * separator naming it is pointed at a live key first.
+ */
+
+#ifndef BPTREE_ORDER
+#define BPTREE_ORDER 32
+#endif
+
+#if BPTREE_ORDER < 4
+#error "BPTREE_ORDER must be at least 4"
+#endif
+
+/* Minimum keys outside the root; a merge of two minimal nodes always fits. */
+#define BPTREE_MIN_LEAF  (BPTREE_ORDER / 2)
+#define BPTREE_MIN_INNER ((BPTREE_ORDER - 1) / 2)
+#define BPTREE_MAX_HEIGHT 32
+
+typedef struct BPNode {
+    uint32_t n;                 /* number of keys */
+    bool leaf;
+    void *keys[BPTREE_ORDER];
+} BPNode;
+
+typedef struct BPLeaf {
+    BPNode hdr;
+    void *values[BPTREE_ORDER];
+    struct BPLeaf *next;
+} BPLeaf;
+
+/* keys[i] separates child[i] (smaller keys) from child[i + 1]. */
+typedef struct BPInner {
+    BPNode hdr;
+    BPNode *child[BPTREE_ORDER + 1];
+} BPInner;
+
+typedef struct BPTree {
+    BPNode *root;
+    bst_cmp_fn cmp;
+    bst_free_fn free_key;
+    bst_free_fn free_value;
+    size_t size;
+} BPTree;
+
+static inline BPLeaf *bptree_new_leaf(void) {
+    BPLeaf *l = (BPLeaf *)malloc(sizeof(BPLeaf));
+    if (!l) return NULL;
+    l->hdr.n = 0;
+    l->hdr.leaf = true;
+    l->next = NULL;
+    return l;
+}
+
+static inline BPInner *bptree_new_inner(void) {
+    BPInner *in = (BPInner *)malloc(sizeof(BPInner));
+    if (!in) return NULL;
+    in->hdr.n = 0;
+    in->hdr.leaf = false;
+    return in;
+}
+
+static inline BPTree *bptree_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
+    BPTree *t = (BPTree *)malloc(sizeof(BPTree));
+    if (!t) return NULL;
+    t->root = (BPNode *)bptree_new_leaf();
+    if (!t->root) { free(t); return NULL; }
+    t->cmp = cmp;
+    t->free_key = free_key;
+    t->free_value = free_value;
+    t->size = 0;
+    return t;
+}
+
+static inline void bptree_free_node(BPTree *t, BPNode *n) {
+    if (n->leaf) {
+        BPLeaf *l = (BPLeaf *)n;
+        for (uint32_t i = 0; i < n->n; ++i) {
+            if (t->free_key)   t->free_key(n->keys[i]);
+            if (t->free_value) t->free_value(l->values[i]);
+        }
+    } else {
+        BPInner *in = (BPInner *)n;
+        for (uint32_t i = 0; i <= n->n; ++i) bptree_free_node(t, in->child[i]);
+    }
+    free(n);
+}
+
+static inline void bptree_destroy(BPTree *t) {
+    if (!t) return;
+    bptree_free_node(t, t->root);
+    free(t);
+}
+
+static inline size_t bptree_size(const BPTree *t) { return t ? t->size : 0; }
+
+// =======================================
+// In-node search
+// =======================================
+
+/* Number of keys in `n` that are < key (or <= key when `upper`). */
+static inline uint32_t bptree_rank(const BPTree *t, const BPNode *n, const void *key, bool upper) {
+    if (!t->cmp) {
+        uintptr_t k = (uintptr_t)key;
+        uint32_t count = 0;
+        if (upper) {
+            for (uint32_t i = 0; i < n->n; ++i) count += (uintptr_t)n->keys[i] <= k;
+        } else {
+            for (uint32_t i = 0; i < n->n; ++i) count += (uintptr_t)n->keys[i] < k;
+        }
+        return count;
+    }
+    uint32_t lo = 0, hi = n->n;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        int c = t->cmp(n->keys[mid], key);
+        if (c < 0 || (upper && c == 0)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static inline bool bptree_equal(const BPTree *t, const void *a, const void *b) {
+    return t->cmp ? t->cmp(a, b) == 0 : a == b;
+}
+
+static inline BPLeaf *bptree_find_leaf(const BPTree *t, const void *key) {
+    BPNode *n = t->root;
+    while (!n->leaf) n = ((BPInner *)n)->child[bptree_rank(t, n, key, true)];
+    return (BPLeaf *)n;
+}
+
+static inline void *bptree_get(const BPTree *t, const void *key) {
+    if (!t) return NULL;
+    BPLeaf *l = bptree_find_leaf(t, key);
+    uint32_t i = bptree_rank(t, &l->hdr, key, false);
+    return i < l->hdr.n && bptree_equal(t, l->hdr.keys[i], key) ? l->values[i] : NULL;
+}
+
+static inline bool bptree_contains(const BPTree *t, const void *key) {
+    if (!t) return false;
+    BPLeaf *l = bptree_find_leaf(t, key);
+    uint32_t i = bptree_rank(t, &l->hdr, key, false);
+    return i < l->hdr.n && bptree_equal(t, l->hdr.keys[i], key);
+}
+
+/*
+ * A separator equal to a key can only sit just left of that key's search
+ * path, so that is the only place a separator pointing at `old` can be.
+ * Repoints it at `key`, which must compare the same way against the rest of
+ * the tree.
+ */
+static inline void bptree_rename_sep(BPInner *const *path, const uint32_t *slot, size_t depth,
+                                     const void *old, void *key) {
+    for (size_t d = 0; d < depth; ++d) {
+        if (slot[d] > 0 && path[d]->hdr.keys[slot[d] - 1] == old) path[d]->hdr.keys[slot[d] - 1] = key;
+    }
+}
+
+// =======================================
+// Insert
+// =======================================
+
+/*
+ * Splits the full leaf `l` into itself and the empty leaf `r` while inserting
+ * (key, value) at `pos`. The first key of `r` becomes the parent separator.
+ */
+static inline void bptree_split_leaf(BPLeaf *l, BPLeaf *r, uint32_t pos, void *key, void *value) {
+    void *keys[BPTREE_ORDER + 1], *values[BPTREE_ORDER + 1];
+    memcpy(keys, l->hdr.keys, pos * sizeof(void *));
+    memcpy(values, l->values, pos * sizeof(void *));
+    keys[pos] = key;
+    values[pos] = value;
+    memcpy(keys + pos + 1, l->hdr.keys + pos, (BPTREE_ORDER - pos) * sizeof(void *));
+    memcpy(values + pos + 1, l->values + pos, (BPTREE_ORDER - pos) * sizeof(void *));
+
+    uint32_t left = (BPTREE_ORDER + 1) / 2, right = BPTREE_ORDER + 1 - left;
+    memcpy(l->hdr.keys, keys, left * sizeof(void *));
+    memcpy(l->values, values, left * sizeof(void *));
+    memcpy(r->hdr.keys, keys + left, right * sizeof(void *));
+    memcpy(r->values, values + left, right * sizeof(void *));
+    l->hdr.n = left;
+    r->hdr.n = right;
+    r->next = l->next;
+    l->next = r;
+}
+
+/*
+ * Splits the full inner node `in` into itself and the empty node `r` while
+ * inserting separator `key` at `pos` with `child` to its right. Returns the
+ * key that moves up into the parent.
+ */
+static inline void *bptree_split_inner(BPInner *in, BPInner *r, uint32_t pos, void *key,
+                                       BPNode *child) {
+    void *keys[BPTREE_ORDER + 1];
+    BPNode *kids[BPTREE_ORDER + 2];
+    memcpy(keys, in->hdr.keys, pos * sizeof(void *));
+    keys[pos] = key;
+    memcpy(keys + pos + 1, in->hdr.keys + pos, (BPTREE_ORDER - pos) * sizeof(void *));
+    memcpy(kids, in->child, (pos + 1) * sizeof(BPNode *));
+    kids[pos + 1] = child;
+    memcpy(kids + pos + 2, in->child + pos + 1, (BPTREE_ORDER - pos) * sizeof(BPNode *));
+
+    uint32_t left = (BPTREE_ORDER + 1) / 2, right = BPTREE_ORDER - left;
+    memcpy(in->hdr.keys, keys, left * sizeof(void *));
+    memcpy(in->child, kids, (left + 1) * sizeof(BPNode *));
+    memcpy(r->hdr.keys, keys + left + 1, right * sizeof(void *));
+    memcpy(r->child, kids + left + 1, (right + 1) * sizeof(BPNode *));
+    in->hdr.n = left;
+    r->hdr.n = right;
+    return keys[left];
+}
+
+/* Same return convention as bst_insert(): true if the key was new. */
+static inline bool bptree_insert(BPTree *t, void *key, void *value) {
+    if (!t) return false;
+    BPInner *path[BPTREE_MAX_HEIGHT];
+    uint32_t slot[BPTREE_MAX_HEIGHT];
+    size_t depth = 0;
+    BPNode *n = t->root;
+    while (!n->leaf) {
+        uint32_t i = bptree_rank(t, n, key, true);
+        path[depth] = (BPInner *)n;
+        slot[depth++] = i;
+        n = ((BPInner *)n)->child[i];
+    }
+
+    BPLeaf *l = (BPLeaf *)n;
+    uint32_t pos = bptree_rank(t, n, key, false);
+    if (pos < n->n && bptree_equal(t, n->keys[pos], key)) {
+        bptree_rename_sep(path, slot, depth, n->keys[pos], key);
+        if (t->free_key)   t->free_key(n->keys[pos]);
+        if (t->free_value) t->free_value(l->values[pos]);
+        n->keys[pos] = key;
+        l->values[pos] = value;
+        return false;
+    }
+    if (n->n < BPTREE_ORDER) {
+        memmove(n->keys + pos + 1, n->keys + pos, (n->n - pos) * sizeof(void *));
+        memmove(l->values + pos + 1, l->values + pos, (n->n - pos) * sizeof(void *));
+        n->keys[pos] = key;
+        l->values[pos] = value;
+        n->n++;
+        t->size++;
+        return true;
+    }
+
+    /*
+     * The leaf splits, and so does every full ancestor above it; if they are
+     * all full the root splits too. Allocate those nodes first so that a
+     * failed malloc leaves the tree untouched.
+     */
+    size_t full = 0;
+    while (full < depth && path[depth - 1 - full]->hdr.n == BPTREE_ORDER) full++;
+    bool grow = full == depth;
+    BPLeaf *r = bptree_new_leaf();
+    BPInner *spare[BPTREE_MAX_HEIGHT + 1];
+    size_t nspare = 0;
+    bool ok = r != NULL;
+    while (ok && nspare < full + grow) {
+        spare[nspare] = bptree_new_inner();
+        ok = spare[nspare] != NULL;
+        nspare += ok;
+    }
+    if (!ok) {
+        free(r);
+        while (nspare) free(spare[--nspare]);
+        return false;
+    }
+
+    bptree_split_leaf(l, r, pos, key, value);
+    t->size++;
+    void *sep = r->hdr.keys[0];
+    BPNode *right = (BPNode *)r;
+    while (depth > 0) {
+        BPInner *p = path[--depth];
+        uint32_t i = slot[depth];
+        if (p->hdr.n < BPTREE_ORDER) {
+            memmove(p->hdr.keys + i + 1, p->hdr.keys + i, (p->hdr.n - i) * sizeof(void *));
+            memmove(p->child + i + 2, p->child + i + 1, (p->hdr.n - i) * sizeof(BPNode *));
+            p->hdr.keys[i] = sep;
+            p->child[i + 1] = right;
+            p->hdr.n++;
+            return true;
+        }
+        BPInner *pr = spare[--nspare];
+        sep = bptree_split_inner(p, pr, i, sep, right);
+        right = (BPNode *)pr;
+    }
+    BPInner *root = spare[--nspare];
+    root->hdr.n = 1;
+    root->hdr.keys[0] = sep;
+    root->child[0] = t->root;
+    root->child[1] = right;
+    t->root = (BPNode *)root;
+    return true;
+}
+
+// =======================================
+// Remove
+// =======================================
+
+/*
+ * Refills child `ci` of `p`, which just dropped below the minimum, by
+ * borrowing one entry from a sibling or merging with one. The merge takes a
+ * key out of `p`, which the caller then checks in turn.
+ */
+static inline void bptree_fix_child(BPInner *p, uint32_t ci) {
+    BPNode *n = p->child[ci];
+    BPNode *left = ci > 0 ? p->child[ci - 1] : NULL;
+    BPNode *right = ci < p->hdr.n ? p->child[ci + 1] : NULL;
+    uint32_t min = n->leaf ? BPTREE_MIN_LEAF : BPTREE_MIN_INNER;
+
+    if (left && left->n > min) {
+        memmove(n->keys + 1, n->keys, n->n * sizeof(void *));
+        if (n->leaf) {
+            BPLeaf *l = (BPLeaf *)n, *ll = (BPLeaf *)left;
+            memmove(l->values + 1, l->values, n->n * sizeof(void *));
+            n->keys[0] = left->keys[left->n - 1];
+            l->values[0] = ll->values[left->n - 1];
+            p->hdr.keys[ci - 1] = n->keys[0];
+        } else {
+            BPInner *in = (BPInner *)n, *li = (BPInner *)left;
+            memmove(in->child + 1, in->child, (n->n + 1) * sizeof(BPNode *));
+            n->keys[0] = p->hdr.keys[ci - 1];
+            in->child[0] = li->child[left->n];
+            p->hdr.keys[ci - 1] = left->keys[left->n - 1];
+        }
+        n->n++;
+        left->n--;
+        return;
+    }
+    if (right && right->n > min) {
+        if (n->leaf) {
+            BPLeaf *l = (BPLeaf *)n, *rl = (BPLeaf *)right;
+            n->keys[n->n] = right->keys[0];
+            l->values[n->n] = rl->values[0];
+            memmove(rl->values, rl->values + 1, (right->n - 1) * sizeof(void *));
+            memmove(right->keys, right->keys + 1, (right->n - 1) * sizeof(void *));
+            p->hdr.keys[ci] = right->keys[0];
+        } else {
+            BPInner *in = (BPInner *)n, *ri = (BPInner *)right;
+            n->keys[n->n] = p->hdr.keys[ci];
+            in->child[n->n + 1] = ri->child[0];
+            p->hdr.keys[ci] = right->keys[0];
+            memmove(right->keys, right->keys + 1, (right->n - 1) * sizeof(void *));
+            memmove(ri->child, ri->child + 1, right->n * sizeof(BPNode *));
+        }
+        n->n++;
+        right->n--;
+        return;
+    }
+
+    /* Merge child j into child j - 1 and drop separator j - 1 from `p`. */
+    uint32_t j = left ? ci : ci + 1;
+    BPNode *a = p->child[j - 1], *b = p->child[j];
+    if (a->leaf) {
+        BPLeaf *la = (BPLeaf *)a, *lb = (BPLeaf *)b;
+        memcpy(a->keys + a->n, b->keys, b->n * sizeof(void *));
+        memcpy(la->values + a->n, lb->values, b->n * sizeof(void *));
+        a->n += b->n;
+        la->next = lb->next;
+    } else {
+        BPInner *ia = (BPInner *)a, *ib = (BPInner *)b;
+        a->keys[a->n] = p->hdr.keys[j - 1];
+        memcpy(a->keys + a->n + 1, b->keys, b->n * sizeof(void *));
+        memcpy(ia->child + a->n + 1, ib->child, (b->n + 1) * sizeof(BPNode *));
+        a->n += b->n + 1;
+    }
+    free(b);
+    memmove(p->hdr.keys + j - 1, p->hdr.keys + j, (p->hdr.n - j) * sizeof(void *));
+    memmove(p->child + j, p->child + j + 1, (p->hdr.n - j) * sizeof(BPNode *));
+    p->hdr.n--;
+}
+
+static inline bool bptree_remove(BPTree *t, const void *key) {
+    if (!t) return false;
+    BPInner *path[BPTREE_MAX_HEIGHT];
+    uint32_t slot[BPTREE_MAX_HEIGHT];
+    size_t depth = 0;
+    BPNode *n = t->root;
+    while (!n->leaf) {
+        uint32_t i = bptree_rank(t, n, key, true);
+        path[depth] = (BPInner *)n;
+        slot[depth++] = i;
+        n = ((BPInner *)n)->child[i];
+    }
+
+    BPLeaf *l = (BPLeaf *)n;
+    uint32_t pos = bptree_rank(t, n, key, false);
+    if (pos >= n->n || !bptree_equal(t, n->keys[pos], key)) return false;
+    void *old = n->keys[pos];
+    if (t->free_value) t->free_value(l->values[pos]);
+    memmove(n->keys + pos, n->keys + pos + 1, (n->n - pos - 1) * sizeof(void *));
+    memmove(l->values + pos, l->values + pos + 1, (n->n - pos - 1) * sizeof(void *));
+    n->n--;
+    t->size--;
+
+    /*
+     * A separator naming the removed key has it as the smallest key of its
+     * right subtree, which held at least one more key. The successor is then
+     * still >= every key on the left, so it takes over the separator.
+     */
+    void *succ = pos < n->n ? n->keys[pos] : l->next ? l->next->hdr.keys[0] : NULL;
+    bptree_rename_sep(path, slot, depth, old, succ);
+    if (t->free_key) t->free_key(old);
+
+    uint32_t min = BPTREE_MIN_LEAF;
+    while (depth > 0 && n->n < min) {
+        BPInner *p = path[--depth];
+        bptree_fix_child(p, slot[depth]);
+        n = (BPNode *)p;
+        min = BPTREE_MIN_INNER;
+    }
+    if (!t->root->leaf && t->root->n == 0) {
+        BPNode *old = t->root;
+        t->root = ((BPInner *)old)->child[0];
+        free(old);
+    }
+    return true;
+}
+
+// =======================================
+// Ordered scans
+// =======================================
+
+static inline BPLeaf *bptree_first_leaf(const BPTree *t) {
+    BPNode *n = t->root;
+    while (!n->leaf) n = ((BPInner *)n)->child[0];
+    return (BPLeaf *)n;
+}
+
+static inline void bptree_inorder(const BPTree *t, bst_visit_fn visit, void *user) {
+    if (!t || !visit) return;
+    for (BPLeaf *l = bptree_first_leaf(t); l; l = l->next) {
+        for (uint32_t i = 0; i < l->hdr.n; ++i) visit(l->hdr.keys[i], l->values[i], user);
+    }
+}
+
+/* Visits the entries with lo <= key <= hi in ascending order. */
+static inline void bptree_range(const BPTree *t, const void *lo, const void *hi,
+                                bst_visit_fn visit, void *user) {
+    if (!t || !visit) return;
+    BPLeaf *l = bptree_find_leaf(t, lo);
+    uint32_t i = bptree_rank(t, &l->hdr, lo, false);
+    for (; l; l = l->next, i = 0) {
+        for (; i < l->hdr.n; ++i) {
+            const void *k = l->hdr.keys[i];
+            if (t->cmp ? t->cmp(k, hi) > 0 : (uintptr_t)k > (uintptr_t)hi) return;
+            visit(l->hdr.keys[i], l->values[i], user);
+        }
+    }
+}
+
+// =======================================
+// Bulk loading
+// =======================================
+
+static inline bool bptree_sorted(bst_cmp_fn cmp, void *const *keys, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        if (cmp ? cmp(keys[i - 1], keys[i]) >= 0 : (uintptr_t)keys[i - 1] >= (uintptr_t)keys[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Builds a tree from `n` keys bottom-up: leaves are filled left to right and
+ * each level of inner nodes is built over the one below, with entries spread
+ * evenly so no node ends up under the minimum. Input that is not strictly
+ * ascending is inserted one key at a time instead. `values` may be NULL.
+ */
+static inline BPTree *bptree_build_sorted(bst_cmp_fn cmp, bst_free_fn free_key,
+                                          bst_free_fn free_value, void *const *keys,
+                                          void *const *values, size_t n) {
+    BPTree *t = bptree_create(cmp, free_key, free_value);
+    if (!t || n == 0) return t;
+    if (!bptree_sorted(cmp, keys, n)) {
+        for (size_t i = 0; i < n; ++i) bptree_insert(t, keys[i], values ? values[i] : NULL);
+        return t;
+    }
+
+    size_t count = (n + BPTREE_ORDER - 1) / BPTREE_ORDER;
+    BPNode **level = (BPNode **)malloc(count * sizeof(BPNode *));
+    void **low = (void **)malloc(count * sizeof(void *));   /* smallest key under level[i] */
+    if (!level || !low) goto fail;
+    free(t->root);
+    t->root = NULL;
+
+    BPLeaf *prev = NULL;
+    for (size_t i = 0, k = 0; i < count; ++i) {
+        size_t take = n / count + (i < n % count);
+        BPLeaf *l = bptree_new_leaf();
+        if (!l) { count = i; goto fail_level; }
+        memcpy(l->hdr.keys, keys + k, take * sizeof(void *));
+        if (values) memcpy(l->values, values + k, take * sizeof(void *));
+        else memset(l->values, 0, take * sizeof(void *));
+        l->hdr.n = (uint32_t)take;
+        if (prev) prev->next = l;
+        prev = l;
+        level[i] = (BPNode *)l;
+        low[i] = keys[k];
+        k += take;
+        t->size += take;
+    }
+
+    while (count > 1) {
+        size_t parents = (count + BPTREE_ORDER) / (BPTREE_ORDER + 1);
+        for (size_t i = 0, k = 0; i < parents; ++i) {
+            size_t take = count / parents + (i < count % parents);
+            BPInner *in = bptree_new_inner();
+            if (!in) {
+                /* Children before k are already owned by earlier parents. */
+                for (size_t j = k; j < count; ++j) bptree_free_node(t, level[j]);
+                count = i;
+                goto fail_level;
+            }
+            memcpy(in->child, level + k, take * sizeof(BPNode *));
+            memcpy(in->hdr.keys, low + k + 1, (take - 1) * sizeof(void *));
+            in->hdr.n = (uint32_t)(take - 1);
+            level[i] = (BPNode *)in;
+            low[i] = low[k];
+            k += take;
+        }
+        count = parents;
+    }
+    t->root = level[0];
+    free(level);
+    free(low);
+    return t;
+
+fail_level:
+    /* Keys and values still belong to the caller. */
+    t->free_key = NULL;
+    t->free_value = NULL;
+    for (size_t j = 0; j < count; ++j) bptree_free_node(t, level[j]);
+    free(level);
+    free(low);
+    free(t);
+    return NULL;
+fail:
+    free(level);
+    free(low);
+    bptree_destroy(t);
+    return NULL;
+}
+
+#endif
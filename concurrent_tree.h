@@ -0,0 +1,564 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef CONCURRENT_TREE_H
+#define CONCURRENT_TREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "tree.h"
+#include "epoch.h"
+
+/*
+ * Concurrent ordered map with the BST operations, for an index shared by
+ * many threads.
+ *
+ * The tree is external: entries live in leaves and inner nodes only route,
+ * with keys < node->key on the left. Lookups take no locks; they follow
+ * child pointers loaded with acquire and finish at a leaf, which is never
+ * modified once published (a replaced value gets a new leaf).
+ *
+ * Every inner node carries a version that is odd while the node is locked
+ * and grows by two with each change to its children. Updates search
+ * without locks, then lock only the nodes they change, and only if their
+ * version still matches the one seen during the search; otherwise they
+ * start over. An insert locks the leaf's parent and swaps the leaf for a
+ * new inner node; a remove locks the grandparent and the parent and
+ * splices the leaf's sibling into the parent's place. A removed inner node
+ * stays locked, so late updates that reached it retry. Unlinked nodes are
+ * reclaimed through epoch.h.
+ *
+ * Inner nodes route by a leaf's key pointer and keep doing so after that
+ * leaf is replaced or removed. With a `free_key`, keys are reference
+ * counted through CBSTKey and freed once no node uses them. Without one,
+ * unlike the bst_* functions, a key must stay valid until cbst_destroy():
+ * freeing it after cbst_remove() or a replacing cbst_insert() leaves later
+ * searches comparing against freed memory.
+ *
+ * Balance is relaxed AVL. Inner nodes carry a height hint, and after each
+ * insert or remove the updating thread walks back down the key's path and,
+ * bottom-up, refreshes the hints and rotates where two siblings differ by
+ * more than one. A rotation locks the parent and the nodes that move, builds
+ * fresh copies of the moved nodes and swings the parent's child pointer
+ * once, so readers see either the old or the new shape; both route every
+ * key to the same leaf. The old copies stay locked like removed nodes. A
+ * rotation that finds a lock taken is skipped, and a later update on that
+ * path redoes it, so under contention the tree can be briefly out of AVL
+ * shape but sorted input still gives O(log n) depth.
+ *
+ * Every thread calls cbst_register() once for its EpochThread. As with
+ * ctrie_get(), a value returned by cbst_get() may be released once another
+ * thread replaces or removes it.
+ */
+
+typedef struct CBSTKey {
+    void *key;
+    atomic_uint refs;           /* nodes routing by or holding `key` */
+} CBSTKey;
+
+typedef struct CBSTNode {
+    void *key;
+    void *value;                /* leaves only */
+    CBSTKey *owner;             /* NULL when the tree does not free keys */
+    _Atomic(struct CBSTNode *) child[2];
+    _Atomic(uint64_t) version;  /* odd while locked */
+    atomic_int height;          /* leaves are 1; a hint on inner nodes */
+    unsigned char leaf;
+    unsigned char inf;          /* sentinel keys above every real key: 1 < 2 */
+} CBSTNode;
+
+typedef struct CBST {
+    CBSTNode *root;
+    bst_cmp_fn cmp;
+    bst_free_fn free_key;
+    bst_free_fn free_value;
+    atomic_size_t size;
+    EpochDomain epoch;
+} CBST;
+
+static inline CBSTNode *cbst_new_node(void *key, CBSTKey *owner, unsigned char inf, bool leaf) {
+    CBSTNode *n = (CBSTNode *)malloc(sizeof(CBSTNode));
+    if (!n) return NULL;
+    n->key = key;
+    n->value = NULL;
+    n->owner = owner;
+    atomic_init(&n->child[0], NULL);
+    atomic_init(&n->child[1], NULL);
+    atomic_init(&n->version, 0);
+    atomic_init(&n->height, leaf ? 1 : 2);
+    n->leaf = leaf;
+    n->inf = inf;
+    return n;
+}
+
+/*
+ * The root routes by the second sentinel and starts with the two sentinel
+ * leaves, so every real leaf has a parent and a grandparent. With a NULL
+ * `free_key`, inserted keys must outlive the tree (see above).
+ */
+static inline CBST *cbst_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
+    if (!cmp) return NULL;
+    CBST *t = (CBST *)malloc(sizeof(CBST));
+    CBSTNode *root = cbst_new_node(NULL, NULL, 2, false);
+    CBSTNode *l = cbst_new_node(NULL, NULL, 1, true);
+    CBSTNode *r = cbst_new_node(NULL, NULL, 2, true);
+    if (!t || !root || !l || !r) { free(t); free(root); free(l); free(r); return NULL; }
+    atomic_init(&root->child[0], l);
+    atomic_init(&root->child[1], r);
+    t->root = root;
+    t->cmp = cmp;
+    t->free_key = free_key;
+    t->free_value = free_value;
+    atomic_init(&t->size, 0);
+    epoch_domain_init(&t->epoch);
+    return t;
+}
+
+/* Frees an unlinked node, and its key once no other node uses it. */
+static inline void cbst_free_node(CBST *t, CBSTNode *n) {
+    if (n->owner && atomic_fetch_sub_explicit(&n->owner->refs, 1, memory_order_acq_rel) == 1) {
+        t->free_key(n->owner->key);
+        free(n->owner);
+    }
+    if (n->leaf && !n->inf && t->free_value) t->free_value(n->value);
+    free(n);
+}
+
+/* epoch_free_fn for unlinked nodes; ctx is the CBST. */
+static inline void cbst_retire_node(void *ptr, void *ctx) {
+    cbst_free_node((CBST *)ctx, (CBSTNode *)ptr);
+}
+
+/*
+ * All other threads must be done with the tree. Frees it without allocating
+ * by flattening it with right rotations as it goes, like bst_free_node().
+ */
+static inline void cbst_destroy(CBST *t) {
+    if (!t) return;
+    epoch_domain_destroy(&t->epoch);
+    CBSTNode *n = t->root;
+    while (n) {
+        CBSTNode *l = n->leaf ? NULL : atomic_load_explicit(&n->child[0], memory_order_relaxed);
+        if (l && l->leaf) {
+            atomic_store_explicit(&n->child[0], NULL, memory_order_relaxed);
+            cbst_free_node(t, l);
+        } else if (l) {
+            atomic_store_explicit(&n->child[0], atomic_load_explicit(&l->child[1], memory_order_relaxed),
+                                  memory_order_relaxed);
+            atomic_store_explicit(&l->child[1], n, memory_order_relaxed);
+            n = l;
+        } else {
+            CBSTNode *next = n->leaf ? NULL : atomic_load_explicit(&n->child[1], memory_order_relaxed);
+            cbst_free_node(t, n);
+            n = next;
+        }
+    }
+    free(t);
+}
+
+static inline EpochThread *cbst_register(CBST *t) { return epoch_register(&t->epoch); }
+static inline void cbst_unregister(EpochThread *th) { epoch_unregister(th); }
+
+static inline size_t cbst_size(const CBST *t) {
+    return t ? atomic_load_explicit(&t->size, memory_order_relaxed) : 0;
+}
+
+// =======================================
+// Search and version locks
+// =======================================
+
+/* Comparison against a node, with sentinels above every real key. */
+static inline int cbst_cmp(const CBST *t, const void *key, const CBSTNode *n) {
+    return n->inf ? -1 : t->cmp(key, n->key);
+}
+
+static inline int cbst_dir(const CBST *t, const void *key, const CBSTNode *n) {
+    return cbst_cmp(t, key, n) >= 0;
+}
+
+/* Locks `n` if its version is still `v`. */
+static inline bool cbst_trylock(CBSTNode *n, uint64_t v) {
+    return !(v & 1) && atomic_compare_exchange_strong_explicit(&n->version, &v, v + 1,
+                                                               memory_order_acquire,
+                                                               memory_order_relaxed);
+}
+
+/* Publishes the changes made under the lock. */
+static inline void cbst_unlock(CBSTNode *n) {
+    atomic_fetch_add_explicit(&n->version, 1, memory_order_release);
+}
+
+/* Releases a lock without having changed the node. */
+static inline void cbst_unlock_unchanged(CBSTNode *n, uint64_t v) {
+    atomic_store_explicit(&n->version, v, memory_order_release);
+}
+
+typedef struct CBSTPath {
+    CBSTNode *gp, *p, *l;
+    uint64_t gpv, pv;           /* versions read before following their child */
+    int gdir, dir;              /* gp->child[gdir] == p, p->child[dir] == l */
+} CBSTPath;
+
+/* Walks to the leaf for `key`. Must run inside an epoch critical section. */
+static inline void cbst_search(const CBST *t, const void *key, CBSTPath *w) {
+    w->gp = NULL;
+    w->gpv = 0;
+    w->gdir = 0;
+    w->p = t->root;
+    w->pv = atomic_load_explicit(&w->p->version, memory_order_acquire);
+    w->dir = cbst_dir(t, key, w->p);
+    w->l = atomic_load_explicit(&w->p->child[w->dir], memory_order_acquire);
+    while (!w->l->leaf) {
+        w->gp = w->p;
+        w->gpv = w->pv;
+        w->gdir = w->dir;
+        w->p = w->l;
+        w->pv = atomic_load_explicit(&w->p->version, memory_order_acquire);
+        w->dir = cbst_dir(t, key, w->p);
+        w->l = atomic_load_explicit(&w->p->child[w->dir], memory_order_acquire);
+    }
+}
+
+static inline const CBSTNode *cbst_find_leaf(CBST *t, const void *key) {
+    const CBSTNode *n = t->root;
+    while (!n->leaf) {
+        n = atomic_load_explicit(&n->child[cbst_dir(t, key, n)], memory_order_acquire);
+    }
+    return n;
+}
+
+// =======================================
+// Relaxed balancing
+// =======================================
+
+/* Deepest part of a path that one rebalancing pass looks at. */
+#ifndef CBST_FIX_DEPTH
+#define CBST_FIX_DEPTH 128
+#endif
+
+static inline int cbst_height(CBSTNode *n) {
+    return atomic_load_explicit(&n->height, memory_order_relaxed);
+}
+
+static inline CBSTNode *cbst_child(CBSTNode *n, int dir) {
+    return atomic_load_explicit(&n->child[dir], memory_order_acquire);
+}
+
+/* Turns `dst` into an unpublished copy of inner node `src` with new children. */
+static inline CBSTNode *cbst_copy(CBSTNode *dst, const CBSTNode *src, CBSTNode *c0, CBSTNode *c1) {
+    dst->key = src->key;
+    dst->inf = src->inf;
+    dst->owner = src->owner;
+    if (dst->owner) atomic_fetch_add_explicit(&dst->owner->refs, 1, memory_order_relaxed);
+    atomic_init(&dst->child[0], c0);
+    atomic_init(&dst->child[1], c1);
+    int h0 = cbst_height(c0), h1 = cbst_height(c1);
+    atomic_init(&dst->height, (h0 > h1 ? h0 : h1) + 1);
+    return dst;
+}
+
+/*
+ * Rotates the subtree n = p->child[d] toward its taller side s: a single
+ * rotation if n's tall child c leans the same way, a double one through c's
+ * inner child g otherwise. Each version is read before the children it
+ * guards, so a successful trylock proves the shape is still the one read.
+ * Returns false, changing nothing, if a lock is taken, the shape moved or
+ * memory ran out.
+ */
+static inline bool cbst_rotate(CBST *t, EpochThread *th, CBSTNode *p, CBSTNode *n) {
+    uint64_t pv = atomic_load_explicit(&p->version, memory_order_acquire);
+    int d = cbst_child(p, 1) == n;
+    if (cbst_child(p, d) != n) return false;
+    uint64_t nv = atomic_load_explicit(&n->version, memory_order_acquire);
+    CBSTNode *kid[2] = { cbst_child(n, 0), cbst_child(n, 1) };
+    int s = cbst_height(kid[0]) < cbst_height(kid[1]);
+    CBSTNode *c = kid[s], *other = kid[!s];
+    if (c->leaf) return false;
+    uint64_t cv = atomic_load_explicit(&c->version, memory_order_acquire);
+    CBSTNode *cs = cbst_child(c, s), *g = cbst_child(c, !s);
+    bool dbl = cbst_height(g) > cbst_height(cs);
+    uint64_t gv = 0;
+    CBSTNode *gs = NULL, *go = NULL;
+    if (dbl) {
+        if (g->leaf) return false;
+        gv = atomic_load_explicit(&g->version, memory_order_acquire);
+        gs = cbst_child(g, s);
+        go = cbst_child(g, !s);
+    }
+
+    CBSTNode *a = cbst_new_node(NULL, NULL, 0, false);
+    CBSTNode *b = cbst_new_node(NULL, NULL, 0, false);
+    CBSTNode *e = dbl ? cbst_new_node(NULL, NULL, 0, false) : NULL;
+    bool locked = false;
+    if (a && b && (!dbl || e) && epoch_reserve(th, 3) && cbst_trylock(p, pv)) {
+        if (!cbst_trylock(n, nv)) {
+            cbst_unlock_unchanged(p, pv);
+        } else if (!cbst_trylock(c, cv)) {
+            cbst_unlock_unchanged(n, nv);
+            cbst_unlock_unchanged(p, pv);
+        } else if (dbl && !cbst_trylock(g, gv)) {
+            cbst_unlock_unchanged(c, cv);
+            cbst_unlock_unchanged(n, nv);
+            cbst_unlock_unchanged(p, pv);
+        } else {
+            locked = true;
+        }
+    }
+    if (!locked) {
+        free(a);
+        free(b);
+        free(e);
+        return false;
+    }
+
+    CBSTNode *top, *pair[2];
+    if (!dbl) {
+        pair[s] = g;
+        pair[!s] = other;
+        CBSTNode *nn = cbst_copy(a, n, pair[0], pair[1]);
+        pair[s] = cs;
+        pair[!s] = nn;
+        top = cbst_copy(b, c, pair[0], pair[1]);
+    } else {
+        pair[s] = cs;
+        pair[!s] = gs;
+        CBSTNode *nc = cbst_copy(a, c, pair[0], pair[1]);
+        pair[s] = go;
+        pair[!s] = other;
+        CBSTNode *nn = cbst_copy(b, n, pair[0], pair[1]);
+        pair[s] = nc;
+        pair[!s] = nn;
+        top = cbst_copy(e, g, pair[0], pair[1]);
+    }
+    atomic_store_explicit(&p->child[d], top, memory_order_release);
+    cbst_unlock(p);
+    /* The replaced nodes stay locked, so updates that reached them retry. */
+    epoch_retire(th, n, cbst_retire_node, t);
+    epoch_retire(th, c, cbst_retire_node, t);
+    if (dbl) epoch_retire(th, g, cbst_retire_node, t);
+    return true;
+}
+
+/*
+ * Walks down to `key` again and, from the bottom of the path up, refreshes
+ * each inner node's height hint or rotates it back into AVL shape. The root
+ * only anchors the tree and is never rotated. Must run inside an epoch
+ * critical section.
+ */
+static inline void cbst_rebalance(CBST *t, EpochThread *th, const void *key) {
+    CBSTNode *path[CBST_FIX_DEPTH];
+    size_t depth = 0;
+    for (CBSTNode *n = t->root; !n->leaf; n = cbst_child(n, cbst_dir(t, key, n))) {
+        if (depth == CBST_FIX_DEPTH) {
+            /* Too deep: keep the lower half, where the heights just changed. */
+            memmove(path, path + CBST_FIX_DEPTH / 2, CBST_FIX_DEPTH / 2 * sizeof(CBSTNode *));
+            depth = CBST_FIX_DEPTH / 2;
+        }
+        path[depth++] = n;
+    }
+    /* path[0], the root or the top of a cut path, is only a parent. */
+    for (size_t i = depth; --i > 0;) {
+        CBSTNode *n = path[i], *p = path[i - 1];
+        int h0 = cbst_height(cbst_child(n, 0)), h1 = cbst_height(cbst_child(n, 1));
+        if ((h0 - h1 > 1 || h1 - h0 > 1) && cbst_rotate(t, th, p, n)) continue;
+        int h = (h0 > h1 ? h0 : h1) + 1;
+        if (cbst_height(n) != h) atomic_store_explicit(&n->height, h, memory_order_relaxed);
+    }
+}
+
+// =======================================
+// Operations
+// =======================================
+
+static inline void *cbst_get(CBST *t, EpochThread *th, const void *key) {
+    if (!t) return NULL;
+    epoch_enter(th);
+    const CBSTNode *l = cbst_find_leaf(t, key);
+    void *value = cbst_cmp(t, key, l) == 0 ? l->value : NULL;
+    epoch_exit(th);
+    return value;
+}
+
+static inline bool cbst_contains(CBST *t, EpochThread *th, const void *key) {
+    if (!t) return false;
+    epoch_enter(th);
+    bool found = cbst_cmp(t, key, cbst_find_leaf(t, key)) == 0;
+    epoch_exit(th);
+    return found;
+}
+
+/*
+ * Same return convention as bst_insert(). A replaced key and value are
+ * freed once no thread can still be reading them.
+ */
+static inline bool cbst_insert(CBST *t, EpochThread *th, void *key, void *value) {
+    if (!t) return false;
+    CBSTKey *owner = NULL;
+    if (t->free_key) {
+        owner = (CBSTKey *)malloc(sizeof(CBSTKey));
+        if (!owner) return false;
+        owner->key = key;
+        atomic_init(&owner->refs, 1);
+    }
+    CBSTNode *leaf = cbst_new_node(key, owner, 0, true);
+    CBSTNode *inner = cbst_new_node(NULL, NULL, 0, false);
+    if (!leaf || !inner) { free(owner); free(leaf); free(inner); return false; }
+    leaf->value = value;
+
+    CBSTPath w;
+    bool added;
+    epoch_enter(th);
+    if (!epoch_reserve(th, 1)) {
+        epoch_exit(th);
+        free(owner); free(leaf); free(inner);
+        return false;
+    }
+    for (;;) {
+        cbst_search(t, key, &w);
+        int c = cbst_cmp(t, key, w.l);
+        if (!cbst_trylock(w.p, w.pv)) continue;
+        added = c != 0;
+        if (!added) {
+            atomic_store_explicit(&w.p->child[w.dir], leaf, memory_order_release);
+            cbst_unlock(w.p);
+            epoch_retire(th, w.l, cbst_retire_node, t);
+            free(inner);
+            break;
+        }
+        /* The inner node routes by the larger key, taking a share of its owner. */
+        CBSTNode *big = c < 0 ? w.l : leaf;
+        inner->key = big->key;
+        inner->inf = big->inf;
+        inner->owner = big->owner;
+        if (inner->owner) atomic_fetch_add_explicit(&inner->owner->refs, 1, memory_order_relaxed);
+        atomic_init(&inner->child[0], c < 0 ? leaf : w.l);
+        atomic_init(&inner->child[1], c < 0 ? w.l : leaf);
+        atomic_store_explicit(&w.p->child[w.dir], inner, memory_order_release);
+        cbst_unlock(w.p);
+        atomic_fetch_add_explicit(&t->size, 1, memory_order_relaxed);
+        break;
+    }
+    if (added) cbst_rebalance(t, th, key);
+    epoch_exit(th);
+    return added;
+}
+
+static inline bool cbst_remove(CBST *t, EpochThread *th, const void *key) {
+    if (!t) return false;
+    CBSTPath w;
+    bool removed = false;
+    epoch_enter(th);
+    if (!epoch_reserve(th, 2)) {
+        epoch_exit(th);
+        return false;
+    }
+    for (;;) {
+        cbst_search(t, key, &w);
+        if (cbst_cmp(t, key, w.l) != 0) break;
+        if (!cbst_trylock(w.gp, w.gpv)) continue;
+        if (!cbst_trylock(w.p, w.pv)) {
+            cbst_unlock_unchanged(w.gp, w.gpv);
+            continue;
+        }
+        CBSTNode *sibling = atomic_load_explicit(&w.p->child[!w.dir], memory_order_relaxed);
+        atomic_store_explicit(&w.gp->child[w.gdir], sibling, memory_order_release);
+        cbst_unlock(w.gp);
+        /* w.p stays locked: updates still holding its old version must retry. */
+        atomic_fetch_sub_explicit(&t->size, 1, memory_order_relaxed);
+        epoch_retire(th, w.p, cbst_retire_node, t);
+        epoch_retire(th, w.l, cbst_retire_node, t);
+        removed = true;
+        break;
+    }
+    if (removed) cbst_rebalance(t, th, key);
+    epoch_exit(th);
+    return removed;
+}
+
+/* In-order walk over lo <= key <= hi, or over everything when !bounded. */
+static inline size_t cbst_walk(CBST *t, EpochThread *th, const void *lo, const void *hi,
+                               bool bounded, bst_visit_fn visit, void *user) {
+    size_t count = 0, cap = 64, top = 0;
+    const void *last = NULL;
+    const CBSTNode **stack = (const CBSTNode **)malloc(cap * sizeof(CBSTNode *));
+    if (!stack) return 0;
+    epoch_enter(th);
+    stack[top++] = t->root;
+    while (top) {
+        const CBSTNode *n = stack[--top];
+        if (n->leaf) {
+            /*
+             * A subtree spliced up by a remove can route keys beyond the
+             * bounds it had when it was pushed; skip anything not above the
+             * last key so the output stays ordered and duplicate-free.
+             */
+            if (n->inf || (count && t->cmp(n->key, last) <= 0)) continue;
+            if (!bounded || (t->cmp(lo, n->key) <= 0 && t->cmp(hi, n->key) >= 0)) {
+                if (visit) visit(n->key, n->value, user);
+                last = n->key;
+                count++;
+            }
+            continue;
+        }
+        if (top + 2 > cap) {
+            const CBSTNode **grown = (const CBSTNode **)realloc(stack, cap * 2 * sizeof(CBSTNode *));
+            if (!grown) break;
+            stack = grown;
+            cap *= 2;
+        }
+        /* Right below left so the left subtree comes off the stack first. */
+        if (!bounded || cbst_cmp(t, hi, n) >= 0) {
+            stack[top++] = atomic_load_explicit(&n->child[1], memory_order_acquire);
+        }
+        if (!bounded || cbst_cmp(t, lo, n) < 0) {
+            stack[top++] = atomic_load_explicit(&n->child[0], memory_order_acquire);
+        }
+    }
+    epoch_exit(th);
+    free(stack);
+    return count;
+}
+
+/*
+ * Visits the entries with lo <= key <= hi in ascending order and returns
+ * how many there were; `visit` may be NULL to just count. The walk is not
+ * a snapshot: entries inserted or removed while it runs may or may not be
+ * seen, but every entry present throughout is visited exactly once and
+ * keys always come out in ascending order.
+ */
+static inline size_t cbst_range(CBST *t, EpochThread *th, const void *lo, const void *hi,
+                                bst_visit_fn visit, void *user) {
+    return t ? cbst_walk(t, th, lo, hi, true, visit, user) : 0;
+}
+
+/* In-order walk with the same consistency as cbst_range(). */
+static inline void cbst_inorder(CBST *t, EpochThread *th, bst_visit_fn visit, void *user) {
+    if (t && visit) cbst_walk(t, th, NULL, NULL, false, visit, user);
+}
+
+#endif
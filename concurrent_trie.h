@@ -0,0 +1,290 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef CONCURRENT_TRIE_H
+#define CONCURRENT_TRIE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "trie.h"
+#include "epoch.h"
+
+/*
+ * Concurrent variant of Trie for a dictionary shared by many threads.
+ *
+ * Readers (ctrie_get/contains/starts_with) take no locks and finish in a
+ * number of steps bounded by the key length, so they are wait-free. Child
+ * pointers are published with release stores and read with acquire loads.
+ * A word's value sits in an immutable CTrieEntry that writers replace with
+ * a single pointer swap, so readers see either the old or the new entry.
+ *
+ * Writers are serialized per subtree: words are striped by their first
+ * letter, so writers that start with different letters never wait for each
+ * other. Replaced entries and pruned nodes are reclaimed through epoch.h.
+ *
+ * Every thread calls ctrie_register() once for its EpochThread. A value
+ * returned by ctrie_get() may be released (via free_value) once another
+ * thread replaces or removes it; to keep using it, bracket the lookup and
+ * the use with epoch_enter(th)/epoch_exit(th), which nest.
+ */
+
+typedef struct CTrieEntry {
+    void *value;
+} CTrieEntry;
+
+typedef struct CTrieNode {
+    _Atomic(struct CTrieNode *) child[TRIE_ALPHABET];
+    _Atomic(CTrieEntry *) entry;
+} CTrieNode;
+
+typedef struct CTrieLock {
+    alignas(64) pthread_mutex_t mutex;
+} CTrieLock;
+
+typedef struct CTrie {
+    CTrieNode *root;
+    trie_free_fn free_value;
+    atomic_size_t size;
+    CTrieLock locks[TRIE_ALPHABET + 1];     /* one per first letter, last for "" */
+    EpochDomain epoch;
+} CTrie;
+
+static inline CTrieNode *ctrie_new_node(void) {
+    CTrieNode *n = (CTrieNode *)malloc(sizeof(CTrieNode));
+    if (!n) return NULL;
+    for (int i = 0; i < TRIE_ALPHABET; ++i) atomic_init(&n->child[i], NULL);
+    atomic_init(&n->entry, NULL);
+    return n;
+}
+
+static inline CTrie *ctrie_create(trie_free_fn free_value) {
+    CTrie *t = (CTrie *)malloc(sizeof(CTrie));
+    if (!t) return NULL;
+    t->root = ctrie_new_node();
+    if (!t->root) { free(t); return NULL; }
+    t->free_value = free_value;
+    atomic_init(&t->size, 0);
+    for (int i = 0; i <= TRIE_ALPHABET; ++i) pthread_mutex_init(&t->locks[i].mutex, NULL);
+    epoch_domain_init(&t->epoch);
+    return t;
+}
+
+/* epoch_free_fn for a replaced or removed entry; ctx is the CTrie. */
+static inline void ctrie_free_entry(void *ptr, void *ctx) {
+    CTrieEntry *e = (CTrieEntry *)ptr;
+    CTrie *t = (CTrie *)ctx;
+    if (t->free_value) t->free_value(e->value);
+    free(e);
+}
+
+/* All other threads must be done with the trie. */
+static inline void ctrie_destroy(CTrie *t) {
+    if (!t) return;
+    epoch_domain_destroy(&t->epoch);
+    size_t cap = 64, top = 0;
+    CTrieNode **stack = (CTrieNode **)malloc(cap * sizeof(CTrieNode *));
+    if (stack) stack[top++] = t->root;
+    while (top) {
+        CTrieNode *n = stack[--top];
+        for (int i = 0; i < TRIE_ALPHABET; ++i) {
+            CTrieNode *c = atomic_load_explicit(&n->child[i], memory_order_relaxed);
+            if (!c) continue;
+            if (top == cap) {
+                CTrieNode **grown = (CTrieNode **)realloc(stack, cap * 2 * sizeof(CTrieNode *));
+                if (!grown) break;
+                stack = grown;
+                cap *= 2;
+            }
+            stack[top++] = c;
+        }
+        CTrieEntry *e = atomic_load_explicit(&n->entry, memory_order_relaxed);
+        if (e) ctrie_free_entry(e, t);
+        free(n);
+    }
+    free(stack);
+    for (int i = 0; i <= TRIE_ALPHABET; ++i) pthread_mutex_destroy(&t->locks[i].mutex);
+    free(t);
+}
+
+static inline EpochThread *ctrie_register(CTrie *t) { return epoch_register(&t->epoch); }
+static inline void ctrie_unregister(EpochThread *th) { epoch_unregister(th); }
+
+static inline size_t ctrie_size(const CTrie *t) {
+    return t ? atomic_load_explicit(&t->size, memory_order_relaxed) : 0;
+}
+
+/* Writer stripe for `word`: its first letter, or TRIE_ALPHABET for "". */
+static inline int ctrie_stripe(const char *word) {
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id >= 0) return id;
+    }
+    return TRIE_ALPHABET;
+}
+
+/* Node reached by `word`, or NULL. Must run inside an epoch critical section. */
+static inline CTrieNode *ctrie_walk(const CTrie *t, const char *word) {
+    CTrieNode *cur = t->root;
+    for (const char *p = word; *p && cur; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        cur = atomic_load_explicit(&cur->child[id], memory_order_acquire);
+    }
+    return cur;
+}
+
+static inline void *ctrie_get(CTrie *t, EpochThread *th, const char *word) {
+    if (!t || !word) return NULL;
+    epoch_enter(th);
+    CTrieNode *n = ctrie_walk(t, word);
+    CTrieEntry *e = n ? atomic_load_explicit(&n->entry, memory_order_acquire) : NULL;
+    void *value = e ? e->value : NULL;
+    epoch_exit(th);
+    return value;
+}
+
+static inline bool ctrie_contains(CTrie *t, EpochThread *th, const char *word) {
+    if (!t || !word) return false;
+    epoch_enter(th);
+    CTrieNode *n = ctrie_walk(t, word);
+    bool found = n && atomic_load_explicit(&n->entry, memory_order_acquire) != NULL;
+    epoch_exit(th);
+    return found;
+}
+
+static inline bool ctrie_starts_with(CTrie *t, EpochThread *th, const char *prefix) {
+    if (!t || !prefix) return false;
+    epoch_enter(th);
+    bool found = ctrie_walk(t, prefix) != NULL;
+    epoch_exit(th);
+    return found;
+}
+
+/* Same return convention as trie_insert(): true if the word was new. */
+static inline bool ctrie_insert(CTrie *t, EpochThread *th, const char *word, void *value) {
+    if (!t || !word) return false;
+    CTrieEntry *e = (CTrieEntry *)malloc(sizeof(CTrieEntry));
+    if (!e) return false;
+    e->value = value;
+
+    pthread_mutex_t *lock = &t->locks[ctrie_stripe(word)].mutex;
+    pthread_mutex_lock(lock);
+    epoch_enter(th);
+    if (!epoch_reserve(th, 1)) {
+        epoch_exit(th);
+        pthread_mutex_unlock(lock);
+        free(e);
+        return false;
+    }
+    CTrieNode *cur = t->root;
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        CTrieNode *next = atomic_load_explicit(&cur->child[id], memory_order_relaxed);
+        if (!next) {
+            next = ctrie_new_node();
+            if (!next) {
+                epoch_exit(th);
+                pthread_mutex_unlock(lock);
+                free(e);
+                return false;
+            }
+            atomic_store_explicit(&cur->child[id], next, memory_order_release);
+        }
+        cur = next;
+    }
+    CTrieEntry *old = atomic_exchange_explicit(&cur->entry, e, memory_order_acq_rel);
+    if (old) epoch_retire(th, old, ctrie_free_entry, t);
+    else atomic_fetch_add_explicit(&t->size, 1, memory_order_relaxed);
+    epoch_exit(th);
+    pthread_mutex_unlock(lock);
+    return old == NULL;
+}
+
+static inline bool ctrie_node_empty(CTrieNode *n) {
+    if (atomic_load_explicit(&n->entry, memory_order_relaxed)) return false;
+    for (int i = 0; i < TRIE_ALPHABET; ++i) {
+        if (atomic_load_explicit(&n->child[i], memory_order_relaxed)) return false;
+    }
+    return true;
+}
+
+/* Removes `word` and prunes nodes left without words below them. */
+static inline bool ctrie_remove(CTrie *t, EpochThread *th, const char *word) {
+    if (!t || !word) return false;
+    size_t len = 0;
+    for (const char *p = word; *p; ++p) len += trie_idx(*p) >= 0;
+    CTrieNode *local[64];
+    int local_idx[64];
+    CTrieNode **path = len < 64 ? local : (CTrieNode **)malloc((len + 1) * sizeof(CTrieNode *));
+    int *idx = len < 64 ? local_idx : (int *)malloc((len + 1) * sizeof(int));
+    bool removed = false;
+    if (!path || !idx) goto out;
+
+    pthread_mutex_t *lock = &t->locks[ctrie_stripe(word)].mutex;
+    pthread_mutex_lock(lock);
+    epoch_enter(th);
+    /* The entry plus every node on the path may be retired. */
+    if (!epoch_reserve(th, len + 1)) {
+        epoch_exit(th);
+        pthread_mutex_unlock(lock);
+        goto out;
+    }
+    size_t depth = 0;
+    CTrieNode *cur = t->root;
+    for (const char *p = word; *p && cur; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        path[depth] = cur;
+        idx[depth++] = id;
+        cur = atomic_load_explicit(&cur->child[id], memory_order_relaxed);
+    }
+    CTrieEntry *old = cur ? atomic_exchange_explicit(&cur->entry, NULL, memory_order_acq_rel) : NULL;
+    if (old) {
+        removed = true;
+        atomic_fetch_sub_explicit(&t->size, 1, memory_order_relaxed);
+        epoch_retire(th, old, ctrie_free_entry, t);
+        /* Unlink empty nodes bottom-up; readers already inside keep them alive. */
+        while (depth > 0 && ctrie_node_empty(cur)) {
+            depth--;
+            atomic_store_explicit(&path[depth]->child[idx[depth]], NULL, memory_order_release);
+            epoch_retire(th, cur, epoch_free_malloc, NULL);
+            cur = path[depth];
+        }
+    }
+    epoch_exit(th);
+    pthread_mutex_unlock(lock);
+
+out:
+    if (path != local) free(path);
+    if (idx != local_idx) free(idx);
+    return removed;
+}
+
+#endif
@@ -268,434 +268,16 @@ void hashmap_print(Hashmap *map) {
 // Linked List Implementation
 // =======================================
 
-typedef struct Node {
-    int data;
-    struct Node* next;
-} Node;
-
-/**
- * @brief Creates a new node with the given data.
- * 
- * @param data The integer data for the new node.
- * @return Pointer to the newly created node, or NULL if memory allocation fails.
- */
-Node* createNode(int data) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    if (!newNode) {
-        printf("Memory allocation failed\n");
-        return NULL;
-    }
-    newNode->data = data;
-    newNode->next = NULL;
-    return newNode;
-}
-
-/**
- * @brief Inserts a new node with the given data at the head of the list.
- * 
- * @param head Pointer to the pointer to the head of the list.
- * @param data The integer data to insert.
- */
-void insertAtHead(Node** head, int data) {
-    Node* newNode = createNode(data);
-    if (!newNode) return;
-    newNode->next = *head;
-    *head = newNode;
-}
-
-/**
- * @brief Inserts a new node with the given data at the tail of the list.
- * 
- * @param head Pointer to the pointer to the head of the list.
- * @param data The integer data to insert.
- */
-void insertAtTail(Node** head, int data) {
-    Node* newNode = createNode(data);
-    if (!newNode) return;
-    
-    if (*head == NULL) {
-        *head = newNode;
-        return;
-    }
-    
-    Node* temp = *head;
-    while (temp->next != NULL) {
-        temp = temp->next;
-    }
-    temp->next = newNode;
-}
-
-/**
- * @brief Deletes the first node with the given data value.
- * 
- * @param head Pointer to the pointer to the head of the list.
- * @param data The integer value to delete from the list.
- */
-void deleteNode(Node** head, int data) {
-    if (*head == NULL) return;
-
-    Node* temp = *head;
-    if (temp->data == data) {
-        *head = temp->next;
-        free(temp);
-        return;
-    }
-
-    Node* prev = NULL;
-    while (temp != NULL && temp->data != data) {
-        prev = temp;
-        temp = temp->next;
-    }
-
-    if (temp == NULL) return;
-
-    prev->next = temp->next;
-    free(temp);
-}
-
-/**
- * @brief Searches for a node with the specified data.
- * 
- * @param head Pointer to the head of the list.
- * @param data The integer value to search for.
- * @return Pointer to the node containing the data, or NULL if not found.
- */
-Node* search(Node* head, int data) {
-    Node* temp = head;
-    while (temp != NULL) {
-        if (temp->data == data) {
-            return temp;
-        }
-        temp = temp->next;
-    }
-    return NULL;
-}
-
-/**
- * @brief Prints the contents of the linked list.
- * 
- * @param head Pointer to the head of the list.
- */
-void printList(Node* head) {
-    Node* temp = head;
-    while (temp != NULL) {
-        printf("%d -> ", temp->data);
-        temp = temp->next;
-    }
-    printf("NULL\n");
-}
-
-/**
- * @brief Frees the memory allocated for the linked list.
- * 
- * @param head Pointer to the head of the list.
- */
-void freeList(Node* head) {
-    Node* temp;
-    while (head != NULL) {
-        temp = head;
-        head = head->next;
-        free(temp);
-    }
-}
+#include "linked_list.h"
 
 #endif 
 
 
 /*  -------   TRIE ------   */
 
-#ifndef TRIE_ALPHABET
-#define TRIE_ALPHABET 26 /* 'a'..'z' */
-
-
-typedef void (*trie_free_fn)(void *p);
-
-typedef struct TrieNode {
-    struct TrieNode *child[TRIE_ALPHABET];
-    bool terminal;
-    void *value;
-} TrieNode;
-
-typedef struct Trie {
-    TrieNode *root;
-    trie_free_fn free_value;
-    size_t size;
-} Trie;
-
-static inline TrieNode *trie_new_node(void) {
-    TrieNode *n = (TrieNode *)calloc(1, sizeof(TrieNode));
-    return n;
-}
-
-static inline Trie *trie_create(trie_free_fn free_value) {
-    Trie *t = (Trie *)malloc(sizeof(Trie));
-    if (!t) return NULL;
-    t->root = trie_new_node();
-    if (!t->root) { free(t); return NULL; }
-    t->free_value = free_value;
-    t->size = 0;
-    return t;
-}
-
-static inline void trie_free_node(Trie *t, TrieNode *n) {
-    if (!n) return;
-    for (int i = 0; i < TRIE_ALPHABET; ++i) trie_free_node(t, n->child[i]);
-    if (n->terminal && t->free_value) t->free_value(n->value);
-    free(n);
-}
-
-static inline void trie_destroy(Trie *t) {
-    if (!t) return;
-    trie_free_node(t, t->root);
-    free(t);
-}
-
-static inline int trie_idx(char ch) {
-    ch = (char)tolower((unsigned char)ch);
-    if (ch < 'a' || ch > 'z') return -1;
-    return (int)(ch - 'a');
-}
-
-static inline bool trie_insert(Trie *t, const char *word, void *value) {
-    if (!t || !word) return false;
-    TrieNode *cur = t->root;
-    for (const char *p = word; *p; ++p) {
-        int id = trie_idx(*p);
-        if (id < 0) continue;
-        if (!cur->child[id]) cur->child[id] = trie_new_node();
-        if (!cur->child[id]) return false;
-        cur = cur->child[id];
-    }
-    if (!cur->terminal) {
-        cur->terminal = true;
-        cur->value = value;
-        t->size++;
-        return true;
-    } else {
-        if (t->free_value) t->free_value(cur->value);
-        cur->value = value;
-        return false;
-    }
-}
-
-static inline bool trie_contains(const Trie *t, const char *word) {
-    if (!t || !word) return false;
-    const TrieNode *cur = t->root;
-    for (const char *p = word; *p; ++p) {
-        int id = trie_idx(*p);
-        if (id < 0) continue;
-        cur = cur->child[id];
-        if (!cur) return false;
-    }
-    return cur->terminal;
-}
-
-static inline void *trie_get(const Trie *t, const char *word) {
-    if (!t || !word) return NULL;
-    const TrieNode *cur = t->root;
-    for (const char *p = word; *p; ++p) {
-        int id = trie_idx(*p);
-        if (id < 0) continue;
-        cur = cur->child[id];
-        if (!cur) return NULL;
-    }
-    return cur->terminal ? cur->value : NULL;
-}
-
-static inline bool trie_starts_with(const Trie *t, const char *prefix) {
-    if (!t || !prefix) return false;
-    const TrieNode *cur = t->root;
-    for (const char *p = prefix; *p; ++p) {
-        int id = trie_idx(*p);
-        if (id < 0) continue;
-        cur = cur->child[id];
-        if (!cur) return false;
-    }
-    return true;
-}
-
-static inline bool trie_remove(Trie *t, const char *word) {
-    if (!t || !word) return false;
-
-    const char *p = word;
-    TrieNode *stack_nodes[256];
-    int stack_idx[256];
-    int top = 0;
-
-    TrieNode *cur = t->root;
-    for (; *p && top < 256; ++p) {
-        int id = trie_idx(*p);
-        if (id < 0) continue;
-        if (!cur->child[id]) return false;
-        stack_nodes[top] = cur;
-        stack_idx[top] = id;
-        top++;
-        cur = cur->child[id];
-    }
-    if (!cur->terminal) return false;
-
-    cur->terminal = false;
-    if (t->free_value) t->free_value(cur->value);
-    cur->value = NULL;
-    t->size--;
-
-    for (int i = top - 1; i >= 0; --i) {
-        TrieNode *parent = stack_nodes[i];
-        TrieNode *child  = parent->child[stack_idx[i]];
-        bool has_child = false;
-        for (int k = 0; k < TRIE_ALPHABET; ++k) {
-            if (child->child[k]) { has_child = true; break; }
-        }
-        if (!child->terminal && !has_child) {
-            parent->child[stack_idx[i]] = NULL;
-            free(child);
-        } else break;
-    }
-    return true;
-}
-
-static inline size_t trie_size(const Trie *t) { return t ? t->size : 0; }
-
-#endif
-
-
+#include "trie.h"
 
 
 /*---- TREE BST --------*/
 
-
-typedef struct BSTNode {
-    void *key;
-    void *value;
-    struct BSTNode *left;
-    struct BSTNode *right;
-} BSTNode;
-
-typedef int (*bst_cmp_fn)(const void *a, const void *b);
-typedef void (*bst_free_fn)(void *p);
-
-typedef struct BST {
-    BSTNode *root;
-    bst_cmp_fn cmp;
-    bst_free_fn free_key;
-    bst_free_fn free_value;
-    size_t size;
-} BST;
-
-static inline BST *bst_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
-    if (!cmp) return NULL;
-    BST *t = (BST *)malloc(sizeof(BST));
-    if (!t) return NULL;
-    t->root = NULL;
-    t->cmp = cmp;
-    t->free_key = free_key;
-    t->free_value = free_value;
-    t->size = 0;
-    return t;
-}
-
-static inline void bst_free_node(BST *t, BSTNode *n) {
-    if (!n) return;
-    bst_free_node(t, n->left);
-    bst_free_node(t, n->right);
-    if (t->free_key)   t->free_key(n->key);
-    if (t->free_value) t->free_value(n->value);
-    free(n);
-}
-
-static inline void bst_destroy(BST *t) {
-    if (!t) return;
-    bst_free_node(t, t->root);
-    free(t);
-}
-
-static inline size_t bst_size(const BST *t) { return t ? t->size : 0; }
-
-static inline bool bst_insert(BST *t, void *key, void *value) {
-    if (!t) return false;
-    BSTNode **cur = &t->root;
-    while (*cur) {
-        int c = t->cmp(key, (*cur)->key);
-        if (c == 0) {
-            if (t->free_key)   t->free_key((*cur)->key);
-            if (t->free_value) t->free_value((*cur)->value);
-            (*cur)->key = key;
-            (*cur)->value = value;
-            return false;
-        }
-        cur = (c < 0) ? &(*cur)->left : &(*cur)->right;
-    }
-    BSTNode *n = (BSTNode *)malloc(sizeof(BSTNode));
-    if (!n) return false;
-    n->key = key; n->value = value; n->left = n->right = NULL;
-    *cur = n;
-    t->size++;
-    return true;
-}
-
-static inline void *bst_get(const BST *t, const void *key) {
-    if (!t) return NULL;
-    BSTNode *cur = t->root;
-    while (cur) {
-        int c = t->cmp(key, cur->key);
-        if (c == 0) return cur->value;
-        cur = (c < 0) ? cur->left : cur->right;
-    }
-    return NULL;
-}
-
-static inline BSTNode *bst_min_with_parent(BSTNode *n, BSTNode **pp) {
-    *pp = NULL;
-    while (n && n->left) { *pp = n; n = n->left; }
-    return n;
-}
-
-static inline bool bst_remove(BST *t, const void *key) {
-    if (!t) return false;
-    BSTNode **link = &t->root;
-    BSTNode *parent = NULL;
-    while (*link) {
-        int c = t->cmp(key, (*link)->key);
-        if (c == 0) break;
-        parent = *link;
-        link = (c < 0) ? &(*link)->left : &(*link)->right;
-    }
-    BSTNode *target = *link;
-    if (!target) return false;
-
-    if (target->left && target->right) {
-        BSTNode *ps = NULL;
-        BSTNode *succ = bst_min_with_parent(target->right, &ps);
-
-        void *tmpk = target->key; void *tmpv = target->value;
-        target->key = succ->key; target->value = succ->value;
-        succ->key = tmpk; succ->value = tmpv;
-
-        link = (ps ? &ps->left : &target->right);
-        target = *link;
-    }
-
-    BSTNode *child = target->left ? target->left : target->right;
-    *link = child;
-
-    if (t->free_key)   t->free_key(target->key);
-    if (t->free_value) t->free_value(target->value);
-    free(target);
-    t->size--;
-    (void)parent;
-    return true;
-}
-
-typedef void (*bst_visit_fn)(void *key, void *value, void *user);
-
-static inline void bst_inorder_node(BSTNode *n, bst_visit_fn visit, void *user) {
-    if (!n) return;
-    bst_inorder_node(n->left, visit, user);
-    visit(n->key, n->value, user);
-    bst_inorder_node(n->right, visit, user);
-}
-
-static inline void bst_inorder(const BST *t, bst_visit_fn visit, void *user) {
-    if (!t || !visit) return;
-    bst_inorder_node(t->root, visit, user);
-}
+#include "tree.h"
@@ -0,0 +1,240 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+/*
+ * Epoch-based memory reclamation for the lock-free containers.
+ *
+ * Each thread registers once with a domain and brackets every access to
+ * shared nodes with epoch_enter()/epoch_exit(). A node that has been unlinked
+ * is handed to epoch_retire(); its free function runs only after the global
+ * epoch has advanced twice, at which point no thread can still be inside a
+ * critical section that saw the node.
+ */
+
+#ifndef EPOCH_MAX_THREADS
+#define EPOCH_MAX_THREADS 128
+#endif
+
+#ifndef EPOCH_ADVANCE_INTERVAL
+#define EPOCH_ADVANCE_INTERVAL 64
+#endif
+
+typedef void (*epoch_free_fn)(void *ptr, void *ctx);
+
+typedef struct EpochRetired {
+    void *ptr;
+    epoch_free_fn free_fn;
+    void *ctx;
+} EpochRetired;
+
+typedef struct EpochBag {
+    EpochRetired *items;
+    size_t count;
+    size_t capacity;
+    uint64_t epoch;
+} EpochBag;
+
+struct EpochDomain;
+
+typedef struct EpochThread {
+    alignas(64) atomic_uint_fast64_t state;   /* (epoch << 1) | active */
+    atomic_bool in_use;
+    unsigned nesting;
+    size_t since_advance;
+    EpochBag bags[3];
+    struct EpochDomain *domain;
+} EpochThread;
+
+typedef struct EpochDomain {
+    alignas(64) atomic_uint_fast64_t global;
+    EpochThread threads[EPOCH_MAX_THREADS];
+} EpochDomain;
+
+static inline void epoch_domain_init(EpochDomain *d) {
+    atomic_init(&d->global, 2);
+    for (int i = 0; i < EPOCH_MAX_THREADS; ++i) {
+        EpochThread *th = &d->threads[i];
+        atomic_init(&th->state, 0);
+        atomic_init(&th->in_use, false);
+        th->nesting = 0;
+        th->since_advance = 0;
+        for (int b = 0; b < 3; ++b) {
+            th->bags[b].items = NULL;
+            th->bags[b].count = th->bags[b].capacity = 0;
+            th->bags[b].epoch = 0;
+        }
+        th->domain = d;
+    }
+}
+
+static inline void epoch_bag_run(EpochBag *bag) {
+    for (size_t i = 0; i < bag->count; ++i) {
+        bag->items[i].free_fn(bag->items[i].ptr, bag->items[i].ctx);
+    }
+    bag->count = 0;
+}
+
+/*
+ * Runs every pending free function and releases the domain's bookkeeping.
+ * No thread may use the domain concurrently.
+ */
+static inline void epoch_domain_destroy(EpochDomain *d) {
+    for (int i = 0; i < EPOCH_MAX_THREADS; ++i) {
+        for (int b = 0; b < 3; ++b) {
+            EpochBag *bag = &d->threads[i].bags[b];
+            epoch_bag_run(bag);
+            free(bag->items);
+            bag->items = NULL;
+            bag->capacity = 0;
+        }
+    }
+}
+
+/*
+ * Claims a thread slot. Returns NULL when all EPOCH_MAX_THREADS slots are
+ * taken. A released slot keeps its pending garbage for the next owner.
+ */
+static inline EpochThread *epoch_register(EpochDomain *d) {
+    for (int i = 0; i < EPOCH_MAX_THREADS; ++i) {
+        EpochThread *th = &d->threads[i];
+        bool expected = false;
+        if (!atomic_load_explicit(&th->in_use, memory_order_relaxed) &&
+            atomic_compare_exchange_strong(&th->in_use, &expected, true)) {
+            th->nesting = 0;
+            return th;
+        }
+    }
+    return NULL;
+}
+
+static inline void epoch_unregister(EpochThread *th) {
+    atomic_store_explicit(&th->state, 0, memory_order_release);
+    atomic_store_explicit(&th->in_use, false, memory_order_release);
+}
+
+static inline void epoch_enter(EpochThread *th) {
+    if (th->nesting++ > 0) return;
+    uint64_t g = atomic_load_explicit(&th->domain->global, memory_order_relaxed);
+    atomic_store_explicit(&th->state, (g << 1) | 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+static inline void epoch_exit(EpochThread *th) {
+    if (--th->nesting > 0) return;
+    atomic_store_explicit(&th->state, 0, memory_order_release);
+}
+
+/* Frees the bags that are at least two epochs older than `g`. */
+static inline void epoch_collect(EpochThread *th, uint64_t g) {
+    for (int b = 0; b < 3; ++b) {
+        EpochBag *bag = &th->bags[b];
+        if (bag->count && bag->epoch + 2 <= g) epoch_bag_run(bag);
+    }
+}
+
+/* Advances the global epoch if every active thread has observed it. */
+static inline bool epoch_try_advance(EpochDomain *d) {
+    uint64_t g = atomic_load_explicit(&d->global, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    for (int i = 0; i < EPOCH_MAX_THREADS; ++i) {
+        uint64_t s = atomic_load_explicit(&d->threads[i].state, memory_order_relaxed);
+        if ((s & 1) && (s >> 1) != g) return false;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_compare_exchange_strong(&d->global, &g, g + 1);
+}
+
+/* Grows `bag` so it holds at least `need` entries. */
+static inline bool epoch_bag_grow(EpochBag *bag, size_t need) {
+    if (need <= bag->capacity) return true;
+    size_t cap = bag->capacity ? bag->capacity : 64;
+    while (cap < need) {
+        if (cap > SIZE_MAX / 2 / sizeof(EpochRetired)) return false;
+        cap *= 2;
+    }
+    EpochRetired *items = (EpochRetired *)realloc(bag->items, cap * sizeof(EpochRetired));
+    if (!items) return false;
+    bag->items = items;
+    bag->capacity = cap;
+    return true;
+}
+
+/*
+ * Makes room for `n` more epoch_retire() calls on this thread, so none of
+ * them can fail. Call it before unlinking anything: on false nothing has
+ * changed and the operation can back out.
+ */
+static inline bool epoch_reserve(EpochThread *th, size_t n) {
+    epoch_collect(th, atomic_load_explicit(&th->domain->global, memory_order_acquire));
+    for (int b = 0; b < 3; ++b) {
+        EpochBag *bag = &th->bags[b];
+        if (n > SIZE_MAX - bag->count || !epoch_bag_grow(bag, bag->count + n)) return false;
+    }
+    return true;
+}
+
+/*
+ * Schedules free_fn(ptr, ctx) for when no reader can still hold `ptr`.
+ * `ptr` must already be unreachable from the shared structure. Cannot fail
+ * when covered by an earlier epoch_reserve(); otherwise returns false if the
+ * retire list could not grow, in which case nothing was queued.
+ */
+static inline bool epoch_retire(EpochThread *th, void *ptr, epoch_free_fn free_fn, void *ctx) {
+    EpochDomain *d = th->domain;
+    uint64_t g = atomic_load_explicit(&d->global, memory_order_acquire);
+    epoch_collect(th, g);
+
+    EpochBag *bag = &th->bags[g % 3];
+    if (bag->count == bag->capacity && !epoch_bag_grow(bag, bag->count + 1)) return false;
+    bag->epoch = g;
+    bag->items[bag->count].ptr = ptr;
+    bag->items[bag->count].free_fn = free_fn;
+    bag->items[bag->count].ctx = ctx;
+    bag->count++;
+
+    if (++th->since_advance >= EPOCH_ADVANCE_INTERVAL) {
+        th->since_advance = 0;
+        epoch_try_advance(d);
+        epoch_collect(th, atomic_load_explicit(&d->global, memory_order_acquire));
+    }
+    return true;
+}
+
+/* Free function for epoch_retire() when the object came from malloc(). */
+static inline void epoch_free_malloc(void *ptr, void *ctx) {
+    (void)ctx;
+    free(ptr);
+}
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include "intrusive_list.h"
+
+typedef struct Task {
+    int id;
+    int priority;
+    IListNode link;
+} Task;
+
+int main(void) {
+    Task tasks[6];
+    ILIST_HEAD(pending);
+    ILIST_HEAD(urgent);
+
+    for (int i = 0; i < 6; ++i) {
+        tasks[i].id = i;
+        tasks[i].priority = i % 3;
+        ilist_add_tail(&tasks[i].link, &pending);
+    }
+
+    // Move high-priority tasks to their own list while iterating
+    ilist_for_each_entry_safe(t, &pending, Task, link) {
+        if (t->priority == 2) ilist_move_tail(&t->link, &urgent);
+    }
+
+    // Run urgent tasks first
+    ilist_splice(&urgent, &pending);
+
+    ilist_for_each_entry(t, &pending, Task, link) {
+        printf("task %d (priority %d)\n", t->id, t->priority);
+    }
+
+    return 0;
+}
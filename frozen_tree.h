@@ -0,0 +1,306 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef FROZEN_TREE_H
+#define FROZEN_TREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FROZEN_TREE_MMAP 1
+#endif
+
+#include "tree.h"
+
+/*
+ * Read-only search tree built from a BST with bst_freeze().
+ *
+ * Keys and values are copied into two arrays in Eytzinger (BFS) order: slot
+ * 1 is the root and slot k has children 2k and 2k + 1. A lookup walks down
+ * with k = 2k + (key[k] < x), which compiles to a conditional add instead of
+ * a branch, and prefetches the slots four levels below while it waits on the
+ * current one. Those sixteen descendants are contiguous, so the top of the
+ * tree shares a handful of cache lines instead of one line per node.
+ *
+ * `cmp` orders the keys during lookups. With a NULL cmp, keys are uintptr_t
+ * values compared directly, and each step is a single integer compare.
+ * The keys must then already be in integer order.
+ *
+ * frozen_tree_save() writes the arrays to a file that frozen_tree_load()
+ * maps back in place. Keys and values are stored as their 64-bit pattern,
+ * so only ones that encode data (integers, ids, offsets) survive a reload.
+ */
+
+#define FROZEN_TREE_MAGIC   "DSFTREE1"
+#define FROZEN_TREE_VERSION 1u
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FROZEN_TREE_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define FROZEN_TREE_PREFETCH(p) ((void)(p))
+#endif
+
+/* 64 bytes, so the key array starts on a cache line in a mapped file. */
+typedef struct FrozenTreeHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t key_bits;
+    uint64_t size;
+    uint64_t reserved[5];
+} FrozenTreeHeader;
+
+typedef struct FrozenTree {
+    const uint64_t *keys;       /* slots 1..size; slot 0 is unused */
+    const uint64_t *values;
+    size_t size;
+    bst_cmp_fn cmp;
+    void *mem;                  /* header followed by both arrays */
+    size_t mem_len;
+    bool mapped;
+} FrozenTree;
+
+static inline size_t frozen_tree_bytes(uint64_t size) {
+    return sizeof(FrozenTreeHeader) + 2 * ((size_t)size + 1) * sizeof(uint64_t);
+}
+
+static inline void frozen_tree_bind(FrozenTree *ft, void *mem) {
+    const FrozenTreeHeader *h = (const FrozenTreeHeader *)mem;
+    ft->size = (size_t)h->size;
+    ft->keys = (const uint64_t *)((const char *)mem + sizeof(FrozenTreeHeader));
+    ft->values = ft->keys + ft->size + 1;
+    ft->mem = mem;
+}
+
+/* Block for `len` bytes, cache-line aligned so sibling slots share lines. */
+static inline void *frozen_tree_alloc(size_t len) {
+    return aligned_alloc(64, (len + 63) & ~(size_t)63);
+}
+
+// =======================================
+// Construction
+// =======================================
+
+/* Fills slots in in-order sequence, which places sorted input in BFS layout. */
+static inline void frozen_tree_fill(uint64_t *keys, uint64_t *values, size_t n, size_t k,
+                                    BSTNode **cur) {
+    if (k > n) return;
+    frozen_tree_fill(keys, values, n, 2 * k, cur);
+    keys[k] = (uint64_t)(uintptr_t)(*cur)->key;
+    values[k] = (uint64_t)(uintptr_t)(*cur)->value;
+    *cur = bst_next(*cur);
+    frozen_tree_fill(keys, values, n, 2 * k + 1, cur);
+}
+
+/*
+ * Copies `t` into a FrozenTree that looks keys up with `cmp` (see above).
+ * The BST is left unchanged and still owns its keys and values.
+ */
+static inline FrozenTree *bst_freeze(const BST *t, bst_cmp_fn cmp) {
+    if (!t) return NULL;
+    FrozenTree *ft = (FrozenTree *)calloc(1, sizeof(FrozenTree));
+    if (!ft) return NULL;
+    size_t n = bst_size(t);
+    size_t len = frozen_tree_bytes(n);
+    void *mem = frozen_tree_alloc(len);
+    if (!mem) { free(ft); return NULL; }
+    memset(mem, 0, len);
+
+    FrozenTreeHeader *h = (FrozenTreeHeader *)mem;
+    memcpy(h->magic, FROZEN_TREE_MAGIC, sizeof(h->magic));
+    h->version = FROZEN_TREE_VERSION;
+    h->key_bits = 64;
+    h->size = n;
+    uint64_t *keys = (uint64_t *)((char *)mem + sizeof(FrozenTreeHeader));
+    BSTNode *cur = bst_first(t);
+    frozen_tree_fill(keys, keys + n + 1, n, 1, &cur);
+
+    frozen_tree_bind(ft, mem);
+    ft->mem_len = len;
+    ft->cmp = cmp;
+    ft->mapped = false;
+    return ft;
+}
+
+static inline void frozen_tree_destroy(FrozenTree *ft) {
+    if (!ft) return;
+#ifdef FROZEN_TREE_MMAP
+    if (ft->mapped) munmap(ft->mem, ft->mem_len);
+    else free(ft->mem);
+#else
+    free(ft->mem);
+#endif
+    free(ft);
+}
+
+// =======================================
+// Queries
+// =======================================
+
+static inline size_t frozen_tree_size(const FrozenTree *ft) { return ft ? ft->size : 0; }
+
+/*
+ * Slot of the first key >= `key`, or 0 if there is none. The descent
+ * records a 1 bit for each step right; the answer is the last node where it
+ * went left, found by dropping the trailing ones and one more bit.
+ */
+static inline size_t frozen_tree_lower_bound(const FrozenTree *ft, const void *key) {
+    if (!ft) return 0;
+    const uint64_t *keys = ft->keys;
+    size_t n = ft->size, k = 1;
+    if (ft->cmp) {
+        while (k <= n) {
+            FROZEN_TREE_PREFETCH(keys + 16 * k);
+            k = 2 * k + (ft->cmp((const void *)(uintptr_t)keys[k], key) < 0);
+        }
+    } else {
+        uint64_t x = (uint64_t)(uintptr_t)key;
+        while (k <= n) {
+            FROZEN_TREE_PREFETCH(keys + 16 * k);
+            k = 2 * k + (keys[k] < x);
+        }
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+#else
+    while (k & 1) k >>= 1;
+    k >>= 1;
+#endif
+    return k;
+}
+
+static inline void *frozen_tree_key(const FrozenTree *ft, size_t slot) {
+    return (void *)(uintptr_t)ft->keys[slot];
+}
+
+static inline void *frozen_tree_value(const FrozenTree *ft, size_t slot) {
+    return (void *)(uintptr_t)ft->values[slot];
+}
+
+/* Slot of the smallest key, or 0 if the tree is empty. */
+static inline size_t frozen_tree_first(const FrozenTree *ft) {
+    if (!ft || ft->size == 0) return 0;
+    size_t slot = 1;
+    while (2 * slot <= ft->size) slot *= 2;
+    return slot;
+}
+
+/* Slot holding the next larger key, or 0 after the largest. */
+static inline size_t frozen_tree_next(const FrozenTree *ft, size_t slot) {
+    if (!ft || slot == 0) return 0;
+    if (2 * slot + 1 <= ft->size) {
+        slot = 2 * slot + 1;
+        while (2 * slot <= ft->size) slot *= 2;
+        return slot;
+    }
+    while (slot & 1) slot >>= 1;
+    return slot >> 1;
+}
+
+static inline bool frozen_tree_equal(const FrozenTree *ft, size_t slot, const void *key) {
+    const void *k = frozen_tree_key(ft, slot);
+    return ft->cmp ? ft->cmp(k, key) == 0 : k == key;
+}
+
+static inline void *frozen_tree_get(const FrozenTree *ft, const void *key) {
+    size_t slot = frozen_tree_lower_bound(ft, key);
+    return slot && frozen_tree_equal(ft, slot, key) ? frozen_tree_value(ft, slot) : NULL;
+}
+
+static inline bool frozen_tree_contains(const FrozenTree *ft, const void *key) {
+    size_t slot = frozen_tree_lower_bound(ft, key);
+    return slot && frozen_tree_equal(ft, slot, key);
+}
+
+// =======================================
+// Serialization
+// =======================================
+
+static inline bool frozen_tree_save(const FrozenTree *ft, const char *path) {
+    if (!ft || !path) return false;
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(ft->mem, 1, ft->mem_len, f) == ft->mem_len;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+static inline bool frozen_tree_valid(const void *mem, size_t len) {
+    if (len < sizeof(FrozenTreeHeader)) return false;
+    const FrozenTreeHeader *h = (const FrozenTreeHeader *)mem;
+    return memcmp(h->magic, FROZEN_TREE_MAGIC, sizeof(h->magic)) == 0 &&
+           h->version == FROZEN_TREE_VERSION && h->key_bits == 64 &&
+           h->size < (uint64_t)(SIZE_MAX / 16) && frozen_tree_bytes(h->size) == len;
+}
+
+/*
+ * Opens a file written by frozen_tree_save(), searching it with `cmp`. On
+ * POSIX systems the file is mapped read-only and queried in place;
+ * elsewhere it is read into memory.
+ */
+static inline FrozenTree *frozen_tree_load(const char *path, bst_cmp_fn cmp) {
+    if (!path) return NULL;
+    FrozenTree *ft = (FrozenTree *)calloc(1, sizeof(FrozenTree));
+    if (!ft) return NULL;
+#ifdef FROZEN_TREE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { free(ft); return NULL; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); free(ft); return NULL; }
+    size_t len = (size_t)st.st_size;
+    void *mem = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) { free(ft); return NULL; }
+    if (!frozen_tree_valid(mem, len)) { munmap(mem, len); free(ft); return NULL; }
+    ft->mapped = true;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f) { free(ft); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    size_t len = end > 0 ? (size_t)end : 0;
+    void *mem = len ? frozen_tree_alloc(len) : NULL;
+    if (!mem || fread(mem, 1, len, f) != len || !frozen_tree_valid(mem, len)) {
+        free(mem); fclose(f); free(ft);
+        return NULL;
+    }
+    fclose(f);
+    ft->mapped = false;
+#endif
+    frozen_tree_bind(ft, mem);
+    ft->mem_len = len;
+    ft->cmp = cmp;
+    return ft;
+}
+
+#endif
@@ -0,0 +1,437 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef FROZEN_TRIE_H
+#define FROZEN_TRIE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FROZEN_TRIE_MMAP 1
+#endif
+
+#include "trie.h"
+
+/*
+ * Read-only double-array trie built from a Trie with trie_freeze().
+ *
+ * Every node is a slot in three parallel int32 arrays. The child of slot s
+ * for letter c lives at slot base[s] + c and is valid only if check[] of that
+ * slot equals s, so a lookup is one add and one compare per character with no
+ * pointers to chase. term[s] is the word's ordinal in lexicographic order, or
+ * -1 if no word ends at s. Keys go through trie_idx() exactly as in Trie.
+ *
+ * frozen_trie_save() writes the arrays to a file that frozen_trie_load()
+ * maps back in place without parsing. Values are stored as their 64-bit
+ * pattern: in-memory freezes return the original pointers, but only values
+ * that encode data (ids, offsets) survive a save/load round trip. Otherwise
+ * use frozen_trie_index() to look words up in a table of your own.
+ */
+
+#define FROZEN_TRIE_MAGIC   "DSFTRIE1"
+#define FROZEN_TRIE_VERSION 1u
+
+typedef struct FrozenTrieHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t alphabet;
+    uint32_t nslots;
+    uint32_t reserved;
+    uint64_t nwords;
+} FrozenTrieHeader;
+
+typedef struct FrozenTrie {
+    const int32_t *base;
+    const int32_t *check;
+    const int32_t *term;
+    const uint64_t *values;
+    uint32_t nslots;
+    size_t size;
+    void *mem;          /* single block holding all arrays */
+    size_t mem_len;
+    bool mapped;        /* mem came from mmap rather than malloc */
+} FrozenTrie;
+
+/* Byte offsets of each array inside a saved file (and the in-memory block). */
+static inline size_t frozen_trie_values_offset(uint32_t nslots) {
+    size_t off = sizeof(FrozenTrieHeader) + 3 * (size_t)nslots * sizeof(int32_t);
+    return (off + 7) & ~(size_t)7;
+}
+
+static inline size_t frozen_trie_bytes(uint32_t nslots, uint64_t nwords) {
+    return frozen_trie_values_offset(nslots) + (size_t)nwords * sizeof(uint64_t);
+}
+
+/* Points the array fields into a block laid out as in the file. */
+static inline void frozen_trie_bind(FrozenTrie *ft, void *mem) {
+    const FrozenTrieHeader *h = (const FrozenTrieHeader *)mem;
+    const char *p = (const char *)mem + sizeof(FrozenTrieHeader);
+    ft->nslots = h->nslots;
+    ft->size = (size_t)h->nwords;
+    ft->base = (const int32_t *)p;
+    ft->check = ft->base + h->nslots;
+    ft->term = ft->check + h->nslots;
+    ft->values = (const uint64_t *)((const char *)mem + frozen_trie_values_offset(h->nslots));
+    ft->mem = mem;
+}
+
+// =======================================
+// Construction
+// =======================================
+
+/*
+ * A free slot that fails this many times as the first candidate for a base
+ * is dropped from the free list. It stays unused, trading a little space for
+ * not rescanning the same holes on every placement.
+ */
+#ifndef FROZEN_TRIE_MAX_FAILS
+#define FROZEN_TRIE_MAX_FAILS 16
+#endif
+
+#define FROZEN_SLOT_UNLISTED (-2)
+
+typedef struct FrozenTrieBuilder {
+    int32_t *base, *check, *term;
+    int32_t *next_free, *prev_free;     /* doubly linked list of free slots */
+    uint8_t *fails;
+    int32_t free_head;
+    uint32_t cap;
+} FrozenTrieBuilder;
+
+static inline void frozen_builder_unlink(FrozenTrieBuilder *b, int32_t s) {
+    int32_t n = b->next_free[s], p = b->prev_free[s];
+    if (p == FROZEN_SLOT_UNLISTED) return;
+    if (p >= 0) b->next_free[p] = n; else b->free_head = n;
+    if (n >= 0) b->prev_free[n] = p;
+    b->prev_free[s] = b->next_free[s] = FROZEN_SLOT_UNLISTED;
+}
+
+/* Grows every array to at least `need` slots; new slots join the free list. */
+static inline bool frozen_builder_reserve(FrozenTrieBuilder *b, uint32_t need) {
+    if (need <= b->cap) return true;
+    uint32_t cap = b->cap ? b->cap : 64;
+    while (cap < need) cap *= 2;
+    int32_t **arrays[] = { &b->base, &b->check, &b->term, &b->next_free, &b->prev_free };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i) {
+        int32_t *grown = (int32_t *)realloc(*arrays[i], cap * sizeof(int32_t));
+        if (!grown) return false;
+        *arrays[i] = grown;
+    }
+    uint8_t *fails = (uint8_t *)realloc(b->fails, cap);
+    if (!fails) return false;
+    b->fails = fails;
+    /* Append the new slots, in order, to the tail of the free list. */
+    int32_t tail = b->free_head;
+    while (tail >= 0 && b->next_free[tail] >= 0) tail = b->next_free[tail];
+    for (uint32_t s = b->cap; s < cap; ++s) {
+        b->base[s] = 0;
+        b->check[s] = -1;
+        b->term[s] = -1;
+        b->fails[s] = 0;
+        b->prev_free[s] = tail;
+        b->next_free[s] = -1;
+        if (tail >= 0) b->next_free[tail] = (int32_t)s; else b->free_head = (int32_t)s;
+        tail = (int32_t)s;
+    }
+    b->cap = cap;
+    return true;
+}
+
+/* First base >= 1 whose slots base + labels[i] are all free. */
+static inline int32_t frozen_builder_find_base(FrozenTrieBuilder *b, const int *labels, int n) {
+    for (;;) {
+        for (int32_t f = b->free_head, next; f >= 0; f = next) {
+            next = b->next_free[f];
+            int32_t base = f - labels[0];
+            if (base >= 1 && (uint32_t)base + TRIE_ALPHABET > b->cap) break;
+            bool fits = base >= 1;
+            for (int i = 1; i < n && fits; ++i) fits = b->check[base + labels[i]] < 0;
+            if (fits) return base;
+            if (++b->fails[f] >= FROZEN_TRIE_MAX_FAILS) frozen_builder_unlink(b, f);
+        }
+        if (!frozen_builder_reserve(b, b->cap * 2)) return -1;
+    }
+}
+
+static inline void frozen_builder_free(FrozenTrieBuilder *b) {
+    free(b->base); free(b->check); free(b->term);
+    free(b->next_free); free(b->prev_free);
+    free(b->fails);
+}
+
+/*
+ * Builds a FrozenTrie from `t`. The Trie is not modified and can be destroyed
+ * afterwards; value pointers are copied as-is. Returns NULL on failure.
+ */
+static inline FrozenTrie *trie_freeze(const Trie *t) {
+    if (!t) return NULL;
+    FrozenTrieBuilder b;
+    memset(&b, 0, sizeof(b));
+    b.free_head = -1;
+
+    size_t qcap = 1024, qhead = 0, qtail = 0;
+    const TrieNode **qnode = (const TrieNode **)malloc(qcap * sizeof(*qnode));
+    int32_t *qslot = (int32_t *)malloc(qcap * sizeof(*qslot));
+    FrozenTrie *ft = NULL;
+    if (!qnode || !qslot || !frozen_builder_reserve(&b, 1024)) goto fail;
+
+    /* Breadth-first placement: each node's children get one base. */
+    frozen_builder_unlink(&b, 0);
+    b.check[0] = 0;
+    qnode[qtail] = t->root;
+    qslot[qtail++] = 0;
+    uint32_t used = 1;
+    while (qhead < qtail) {
+        const TrieNode *n = qnode[qhead];
+        int32_t s = qslot[qhead++];
+        if (n->terminal) b.term[s] = 0;
+        int labels[TRIE_ALPHABET], nl = 0;
+        for (int c = 0; c < TRIE_ALPHABET; ++c) {
+            if (n->child[c]) labels[nl++] = c;
+        }
+        if (!nl) continue;
+        int32_t base = frozen_builder_find_base(&b, labels, nl);
+        if (base < 0) goto fail;
+        b.base[s] = base;
+        if (qtail + (size_t)nl > qcap) {
+            while (qtail + (size_t)nl > qcap) qcap *= 2;
+            const TrieNode **gn = (const TrieNode **)realloc(qnode, qcap * sizeof(*qnode));
+            if (!gn) goto fail;
+            qnode = gn;
+            int32_t *gs = (int32_t *)realloc(qslot, qcap * sizeof(*qslot));
+            if (!gs) goto fail;
+            qslot = gs;
+        }
+        for (int i = 0; i < nl; ++i) {
+            int32_t slot = base + labels[i];
+            frozen_builder_unlink(&b, slot);
+            b.check[slot] = s;
+            if ((uint32_t)slot + 1 > used) used = (uint32_t)slot + 1;
+            qnode[qtail] = n->child[labels[i]];
+            qslot[qtail++] = slot;
+        }
+    }
+
+    size_t bytes = frozen_trie_bytes(used, t->size);
+    void *mem = calloc(1, bytes);
+    ft = (FrozenTrie *)calloc(1, sizeof(FrozenTrie));
+    if (!mem || !ft) { free(mem); goto fail; }
+    FrozenTrieHeader *h = (FrozenTrieHeader *)mem;
+    memcpy(h->magic, FROZEN_TRIE_MAGIC, sizeof(h->magic));
+    h->version = FROZEN_TRIE_VERSION;
+    h->alphabet = TRIE_ALPHABET;
+    h->nslots = used;
+    h->nwords = t->size;
+    int32_t *base = (int32_t *)((char *)mem + sizeof(FrozenTrieHeader));
+    int32_t *check = base + used;
+    int32_t *term = check + used;
+    uint64_t *values = (uint64_t *)((char *)mem + frozen_trie_values_offset(used));
+    for (uint32_t s = 0; s < used; ++s) {
+        base[s] = b.base[s];
+        check[s] = b.check[s];
+        term[s] = -1;
+    }
+
+    /* Number the words in lexicographic order with a depth-first walk. */
+    qhead = qtail = 0;
+    qnode[qtail++] = t->root;
+    qslot[0] = 0;
+    int64_t ordinal = 0;
+    while (qtail) {
+        const TrieNode *n = qnode[--qtail];
+        int32_t s = qslot[qtail];
+        if (n->terminal) {
+            term[s] = (int32_t)ordinal;
+            values[ordinal++] = (uint64_t)(uintptr_t)n->value;
+        }
+        for (int c = TRIE_ALPHABET - 1; c >= 0; --c) {
+            if (!n->child[c]) continue;
+            qnode[qtail] = n->child[c];
+            qslot[qtail++] = b.base[s] + c;
+        }
+    }
+    frozen_trie_bind(ft, mem);
+    ft->mem_len = bytes;
+    ft->mapped = false;
+
+    frozen_builder_free(&b);
+    free(qnode);
+    free(qslot);
+    return ft;
+
+fail:
+    free(ft);
+    frozen_builder_free(&b);
+    free(qnode);
+    free(qslot);
+    return NULL;
+}
+
+static inline void frozen_trie_destroy(FrozenTrie *ft) {
+    if (!ft) return;
+#ifdef FROZEN_TRIE_MMAP
+    if (ft->mapped) munmap(ft->mem, ft->mem_len);
+    else free(ft->mem);
+#else
+    free(ft->mem);
+#endif
+    free(ft);
+}
+
+// =======================================
+// Queries
+// =======================================
+
+/* Slot reached by `word`, or -1 if the path leaves the trie. */
+static inline int32_t frozen_trie_walk(const FrozenTrie *ft, const char *word) {
+    int32_t s = 0;
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        uint32_t next = (uint32_t)ft->base[s] + (uint32_t)id;
+        if (next >= ft->nslots || ft->check[next] != s || next == 0) return -1;
+        s = (int32_t)next;
+    }
+    return s;
+}
+
+static inline size_t frozen_trie_size(const FrozenTrie *ft) { return ft ? ft->size : 0; }
+
+static inline bool frozen_trie_contains(const FrozenTrie *ft, const char *word) {
+    if (!ft || !word) return false;
+    int32_t s = frozen_trie_walk(ft, word);
+    return s >= 0 && ft->term[s] >= 0;
+}
+
+/* Lexicographic ordinal of `word` among the frozen words, or -1. */
+static inline long frozen_trie_index(const FrozenTrie *ft, const char *word) {
+    if (!ft || !word) return -1;
+    int32_t s = frozen_trie_walk(ft, word);
+    return s >= 0 ? (long)ft->term[s] : -1;
+}
+
+static inline void *frozen_trie_get(const FrozenTrie *ft, const char *word) {
+    long i = frozen_trie_index(ft, word);
+    return i >= 0 ? (void *)(uintptr_t)ft->values[i] : NULL;
+}
+
+static inline bool frozen_trie_starts_with(const FrozenTrie *ft, const char *prefix) {
+    if (!ft || !prefix) return false;
+    return frozen_trie_walk(ft, prefix) >= 0;
+}
+
+// =======================================
+// Serialization
+// =======================================
+
+static inline bool frozen_trie_save(const FrozenTrie *ft, const char *path) {
+    if (!ft || !path) return false;
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(ft->mem, 1, ft->mem_len, f) == ft->mem_len;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+/*
+ * Checks a saved image before it is queried: the header must match and the
+ * arrays must be self-consistent, so a truncated or corrupted file is
+ * rejected instead of read out of bounds. Every base[s] lies in [0, nslots),
+ * every child slot t lies in [base[check[t]], base[check[t]] + alphabet), and
+ * every term index is -1 or below nwords.
+ */
+static inline bool frozen_trie_valid(const void *mem, size_t len) {
+    if (len < sizeof(FrozenTrieHeader)) return false;
+    const FrozenTrieHeader *h = (const FrozenTrieHeader *)mem;
+    if (memcmp(h->magic, FROZEN_TRIE_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != FROZEN_TRIE_VERSION || h->alphabet != TRIE_ALPHABET ||
+        h->nslots == 0 || h->nslots > (uint32_t)INT32_MAX || h->nwords > len / sizeof(uint64_t) ||
+        frozen_trie_bytes(h->nslots, h->nwords) != len) {
+        return false;
+    }
+    const int32_t *base = (const int32_t *)((const char *)mem + sizeof(FrozenTrieHeader));
+    const int32_t *check = base + h->nslots;
+    const int32_t *term = check + h->nslots;
+    int32_t nslots = (int32_t)h->nslots;
+    if (check[0] != 0) return false;
+    for (int32_t s = 0; s < nslots; ++s) {
+        if (base[s] < 0 || base[s] >= nslots) return false;
+        if (term[s] < -1 || (term[s] >= 0 && (uint64_t)term[s] >= h->nwords)) return false;
+        if (s == 0 || check[s] < 0) continue;
+        if (check[s] >= nslots) return false;
+        int32_t from = base[check[s]];
+        if (s < from || s - from >= TRIE_ALPHABET) return false;
+    }
+    return true;
+}
+
+/*
+ * Opens a file written by frozen_trie_save(). On POSIX systems the file is
+ * mapped read-only and queried in place; elsewhere it is read into memory.
+ */
+static inline FrozenTrie *frozen_trie_load(const char *path) {
+    if (!path) return NULL;
+    FrozenTrie *ft = (FrozenTrie *)calloc(1, sizeof(FrozenTrie));
+    if (!ft) return NULL;
+#ifdef FROZEN_TRIE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { free(ft); return NULL; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); free(ft); return NULL; }
+    size_t len = (size_t)st.st_size;
+    void *mem = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) { free(ft); return NULL; }
+    if (!frozen_trie_valid(mem, len)) { munmap(mem, len); free(ft); return NULL; }
+    ft->mapped = true;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f) { free(ft); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    size_t len = end > 0 ? (size_t)end : 0;
+    void *mem = len ? malloc(len) : NULL;
+    if (!mem || fread(mem, 1, len, f) != len || !frozen_trie_valid(mem, len)) {
+        free(mem); fclose(f); free(ft);
+        return NULL;
+    }
+    fclose(f);
+    ft->mapped = false;
+#endif
+    frozen_trie_bind(ft, mem);
+    ft->mem_len = len;
+    return ft;
+}
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Intrusive lists in the style of the Linux kernel's list_head: the links are
+ * embedded in the user's struct and container_of() gets back to the struct,
+ * so insertion and removal never allocate.
+ *
+ *     typedef struct Job { int id; IListNode link; } Job;
+ *
+ *     ILIST_HEAD(queue);
+ *     ilist_add_tail(&job->link, &queue);
+ *     ilist_for_each_entry(j, &queue, Job, link) printf("%d\n", j->id);
+ *
+ * IListNode is a circular doubly-linked list; the head is a sentinel node.
+ * SListNode is a NULL-terminated singly-linked variant for stacks and
+ * free lists where a single pointer per element is enough.
+ */
+
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+// =======================================
+// Doubly-linked intrusive list
+// =======================================
+
+typedef struct IListNode {
+    struct IListNode *next;
+    struct IListNode *prev;
+} IListNode;
+
+#define ILIST_HEAD_INIT(name) { &(name), &(name) }
+#define ILIST_HEAD(name) IListNode name = ILIST_HEAD_INIT(name)
+
+static inline void ilist_init(IListNode *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static inline void ilist_insert_between(IListNode *n, IListNode *prev, IListNode *next) {
+    next->prev = n;
+    n->next = next;
+    n->prev = prev;
+    prev->next = n;
+}
+
+/* Inserts `n` right after `head` (stack order). */
+static inline void ilist_add(IListNode *n, IListNode *head) {
+    ilist_insert_between(n, head, head->next);
+}
+
+/* Inserts `n` right before `head`, i.e. at the tail (queue order). */
+static inline void ilist_add_tail(IListNode *n, IListNode *head) {
+    ilist_insert_between(n, head->prev, head);
+}
+
+/* Unlinks `n` in O(1). The node's links are left dangling. */
+static inline void ilist_del(IListNode *n) {
+    n->next->prev = n->prev;
+    n->prev->next = n->next;
+    n->next = n->prev = NULL;
+}
+
+/* Unlinks `n` and reinitializes it as an empty list. */
+static inline void ilist_del_init(IListNode *n) {
+    n->next->prev = n->prev;
+    n->prev->next = n->next;
+    ilist_init(n);
+}
+
+static inline bool ilist_empty(const IListNode *head) {
+    return head->next == head;
+}
+
+static inline bool ilist_is_singular(const IListNode *head) {
+    return !ilist_empty(head) && head->next == head->prev;
+}
+
+static inline void ilist_move(IListNode *n, IListNode *head) {
+    ilist_del(n);
+    ilist_add(n, head);
+}
+
+static inline void ilist_move_tail(IListNode *n, IListNode *head) {
+    ilist_del(n);
+    ilist_add_tail(n, head);
+}
+
+static inline void ilist_splice_between(IListNode *list, IListNode *prev, IListNode *next) {
+    IListNode *first = list->next;
+    IListNode *last = list->prev;
+    first->prev = prev;
+    prev->next = first;
+    last->next = next;
+    next->prev = last;
+}
+
+/* Moves every entry of `list` to the front of `head` and empties `list`. O(1). */
+static inline void ilist_splice(IListNode *list, IListNode *head) {
+    if (ilist_empty(list)) return;
+    ilist_splice_between(list, head, head->next);
+    ilist_init(list);
+}
+
+/* Moves every entry of `list` to the back of `head` and empties `list`. O(1). */
+static inline void ilist_splice_tail(IListNode *list, IListNode *head) {
+    if (ilist_empty(list)) return;
+    ilist_splice_between(list, head->prev, head);
+    ilist_init(list);
+}
+
+/*
+ * Moves the entries of `head` up to and including `entry` onto the empty list
+ * `out`, leaving the rest in `head`. O(1).
+ */
+static inline void ilist_cut_position(IListNode *out, IListNode *head, IListNode *entry) {
+    if (ilist_empty(head) || entry == head) {
+        ilist_init(out);
+        return;
+    }
+    IListNode *first = head->next;
+    out->next = first;
+    first->prev = out;
+    out->prev = entry;
+    head->next = entry->next;
+    entry->next->prev = head;
+    entry->next = out;
+}
+
+#define ilist_entry(ptr, type, member) container_of(ptr, type, member)
+#define ilist_first_entry(head, type, member) ilist_entry((head)->next, type, member)
+#define ilist_last_entry(head, type, member) ilist_entry((head)->prev, type, member)
+
+#define ilist_for_each(pos, head) \
+    for (IListNode *pos = (head)->next; pos != (head); pos = pos->next)
+
+/* Iteration that tolerates ilist_del() of `pos` inside the loop body. */
+#define ilist_for_each_safe(pos, head) \
+    for (IListNode *pos = (head)->next, *pos##_next = pos->next; pos != (head); \
+         pos = pos##_next, pos##_next = pos->next)
+
+#define ilist_for_each_entry(pos, head, type, member) \
+    for (type *pos = ilist_first_entry(head, type, member); \
+         &pos->member != (head); \
+         pos = ilist_entry(pos->member.next, type, member))
+
+#define ilist_for_each_entry_safe(pos, head, type, member) \
+    for (type *pos = ilist_first_entry(head, type, member), \
+              *pos##_next = ilist_entry(pos->member.next, type, member); \
+         &pos->member != (head); \
+         pos = pos##_next, pos##_next = ilist_entry(pos->member.next, type, member))
+
+// =======================================
+// Singly-linked intrusive list
+// =======================================
+
+typedef struct SListNode {
+    struct SListNode *next;
+} SListNode;
+
+#define SLIST_HEAD_INIT { NULL }
+#define SLIST_HEAD(name) SListNode name = SLIST_HEAD_INIT
+
+static inline void slist_init(SListNode *head) { head->next = NULL; }
+
+static inline bool slist_empty(const SListNode *head) { return head->next == NULL; }
+
+/* Inserts `n` after `pos` (pass the head to push at the front). */
+static inline void slist_add(SListNode *n, SListNode *pos) {
+    n->next = pos->next;
+    pos->next = n;
+}
+
+/* Unlinks and returns the node after `pos`, or NULL. */
+static inline SListNode *slist_del_after(SListNode *pos) {
+    SListNode *n = pos->next;
+    if (n) {
+        pos->next = n->next;
+        n->next = NULL;
+    }
+    return n;
+}
+
+static inline SListNode *slist_pop(SListNode *head) {
+    return slist_del_after(head);
+}
+
+/* Unlinks `n` by searching for its predecessor. O(n). */
+static inline bool slist_del(SListNode *head, SListNode *n) {
+    for (SListNode *prev = head; prev->next; prev = prev->next) {
+        if (prev->next == n) {
+            slist_del_after(prev);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Moves every entry of `list` to the front of `head` and empties `list`. */
+static inline void slist_splice(SListNode *list, SListNode *head) {
+    SListNode *first = list->next;
+    if (!first) return;
+    SListNode *last = first;
+    while (last->next) last = last->next;
+    last->next = head->next;
+    head->next = first;
+    list->next = NULL;
+}
+
+#define slist_entry(ptr, type, member) container_of(ptr, type, member)
+
+#define slist_for_each(pos, head) \
+    for (SListNode *pos = (head)->next; pos; pos = pos->next)
+
+/*
+ * Iteration that tracks the predecessor so the body can unlink `pos` with
+ * slist_del_after(pos##_prev); the next step then resumes from pos##_prev.
+ */
+#define slist_for_each_safe(pos, head) \
+    for (SListNode *pos##_prev = (head), *pos = (head)->next; pos; \
+         pos##_prev = (pos##_prev->next == pos) ? pos : pos##_prev, pos = pos##_prev->next)
+
+#define slist_for_each_entry(pos, head, type, member) \
+    for (type *pos = (head)->next ? slist_entry((head)->next, type, member) : NULL; \
+         pos; \
+         pos = pos->member.next ? slist_entry(pos->member.next, type, member) : NULL)
+
+#endif
@@ -0,0 +1,288 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef LF_QUEUE_H
+#define LF_QUEUE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "epoch.h"
+
+/*
+ * Lock-free queues of ints.
+ *
+ * LFQueue is the Michael-Scott queue: any number of producers and consumers.
+ * MPSCQueue is Vyukov's intrusive queue: any number of producers and exactly
+ * one consumer. Linking a node is a single atomic exchange that never
+ * retries, but taking the node from the shared pool may retry a CAS, so
+ * enqueue as a whole is lock-free rather than wait-free.
+ *
+ * Both draw their nodes from an LFNodePool that allocates them in chunks and
+ * recycles them through epoch reclamation, so a steady-state queue does not
+ * call malloc. Every thread touching a queue needs an EpochThread obtained
+ * from lfq_register()/mpscq_register().
+ */
+
+#ifndef LFQ_CHUNK_NODES
+#define LFQ_CHUNK_NODES 256
+#endif
+
+typedef struct LFNode {
+    _Atomic(struct LFNode *) next;
+    int data;
+} LFNode;
+
+typedef struct LFChunk {
+    struct LFChunk *next;
+    LFNode nodes[LFQ_CHUNK_NODES];
+} LFChunk;
+
+typedef struct LFNodePool {
+    alignas(64) _Atomic(LFNode *) free;
+    _Atomic(LFChunk *) chunks;
+} LFNodePool;
+
+static inline void lf_pool_init(LFNodePool *p) {
+    atomic_init(&p->free, NULL);
+    atomic_init(&p->chunks, NULL);
+}
+
+static inline void lf_pool_destroy(LFNodePool *p) {
+    LFChunk *c = atomic_load_explicit(&p->chunks, memory_order_relaxed);
+    while (c) {
+        LFChunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    atomic_store_explicit(&p->chunks, NULL, memory_order_relaxed);
+    atomic_store_explicit(&p->free, NULL, memory_order_relaxed);
+}
+
+/* Pushes the chain first..last onto the free stack. */
+static inline void lf_pool_push_chain(LFNodePool *p, LFNode *first, LFNode *last) {
+    LFNode *top = atomic_load_explicit(&p->free, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&last->next, top, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&p->free, &top, first,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* epoch_free_fn that returns a retired node to its pool. */
+static inline void lf_pool_recycle(void *ptr, void *ctx) {
+    LFNode *n = (LFNode *)ptr;
+    lf_pool_push_chain((LFNodePool *)ctx, n, n);
+}
+
+/*
+ * Pops a node. Must run inside an epoch critical section: nodes only return
+ * to the free stack through epoch_retire(), so a node seen at the top cannot
+ * be recycled and pushed back (ABA) while this thread is still looking at it.
+ */
+static inline LFNode *lf_pool_alloc(LFNodePool *p) {
+    LFNode *top = atomic_load_explicit(&p->free, memory_order_acquire);
+    while (top) {
+        LFNode *next = atomic_load_explicit(&top->next, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&p->free, &top, next,
+                                                  memory_order_acquire,
+                                                  memory_order_acquire)) {
+            return top;
+        }
+    }
+
+    LFChunk *c = (LFChunk *)malloc(sizeof(LFChunk));
+    if (!c) return NULL;
+    for (int i = 1; i < LFQ_CHUNK_NODES; ++i) {
+        atomic_init(&c->nodes[i].next, i + 1 < LFQ_CHUNK_NODES ? &c->nodes[i + 1] : NULL);
+    }
+    c->next = atomic_load_explicit(&p->chunks, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&p->chunks, &c->next, c,
+                                                  memory_order_release,
+                                                  memory_order_relaxed)) {
+    }
+    if (LFQ_CHUNK_NODES > 1) {
+        lf_pool_push_chain(p, &c->nodes[1], &c->nodes[LFQ_CHUNK_NODES - 1]);
+    }
+    return &c->nodes[0];
+}
+
+// =======================================
+// Michael-Scott MPMC queue
+// =======================================
+
+typedef struct LFQueue {
+    alignas(64) _Atomic(LFNode *) head;
+    alignas(64) _Atomic(LFNode *) tail;
+    LFNodePool pool;
+    EpochDomain epoch;
+} LFQueue;
+
+static inline bool lfq_init(LFQueue *q) {
+    lf_pool_init(&q->pool);
+    epoch_domain_init(&q->epoch);
+    LFNode *dummy = lf_pool_alloc(&q->pool);
+    if (!dummy) return false;
+    atomic_init(&dummy->next, NULL);
+    atomic_init(&q->head, dummy);
+    atomic_init(&q->tail, dummy);
+    return true;
+}
+
+/* Tears the queue down. All other threads must be done with it. */
+static inline void lfq_destroy(LFQueue *q) {
+    epoch_domain_destroy(&q->epoch);
+    lf_pool_destroy(&q->pool);
+}
+
+static inline EpochThread *lfq_register(LFQueue *q) { return epoch_register(&q->epoch); }
+static inline void lfq_unregister(EpochThread *th) { epoch_unregister(th); }
+
+static inline bool lfq_enqueue(LFQueue *q, EpochThread *th, int value) {
+    epoch_enter(th);
+    LFNode *n = lf_pool_alloc(&q->pool);
+    if (!n) {
+        epoch_exit(th);
+        return false;
+    }
+    n->data = value;
+    atomic_store_explicit(&n->next, NULL, memory_order_relaxed);
+
+    for (;;) {
+        LFNode *tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        LFNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+        if (tail != atomic_load_explicit(&q->tail, memory_order_acquire)) continue;
+        if (next) {
+            atomic_compare_exchange_weak_explicit(&q->tail, &tail, next,
+                                                  memory_order_release, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&tail->next, &next, n,
+                                                  memory_order_release, memory_order_relaxed)) {
+            atomic_compare_exchange_strong_explicit(&q->tail, &tail, n,
+                                                    memory_order_release, memory_order_relaxed);
+            break;
+        }
+    }
+    epoch_exit(th);
+    return true;
+}
+
+/*
+ * Returns false if the queue was empty, or if no retire slot could be
+ * reserved for the old dummy node (the queue is then left unchanged).
+ */
+static inline bool lfq_dequeue(LFQueue *q, EpochThread *th, int *out) {
+    epoch_enter(th);
+    if (!epoch_reserve(th, 1)) {
+        epoch_exit(th);
+        return false;
+    }
+    for (;;) {
+        LFNode *head = atomic_load_explicit(&q->head, memory_order_acquire);
+        LFNode *tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        LFNode *next = atomic_load_explicit(&head->next, memory_order_acquire);
+        if (head != atomic_load_explicit(&q->head, memory_order_acquire)) continue;
+        if (!next) {
+            epoch_exit(th);
+            return false;
+        }
+        if (head == tail) {
+            atomic_compare_exchange_weak_explicit(&q->tail, &tail, next,
+                                                  memory_order_release, memory_order_relaxed);
+            continue;
+        }
+        int value = next->data;
+        if (atomic_compare_exchange_weak_explicit(&q->head, &head, next,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            if (out) *out = value;
+            epoch_retire(th, head, lf_pool_recycle, &q->pool);
+            epoch_exit(th);
+            return true;
+        }
+    }
+}
+
+// =======================================
+// Vyukov MPSC queue
+// =======================================
+
+typedef struct MPSCQueue {
+    alignas(64) _Atomic(LFNode *) head;   /* producers exchange here */
+    alignas(64) LFNode *tail;             /* owned by the consumer */
+    LFNodePool pool;
+    EpochDomain epoch;
+} MPSCQueue;
+
+static inline bool mpscq_init(MPSCQueue *q) {
+    lf_pool_init(&q->pool);
+    epoch_domain_init(&q->epoch);
+    LFNode *stub = lf_pool_alloc(&q->pool);
+    if (!stub) return false;
+    atomic_init(&stub->next, NULL);
+    atomic_init(&q->head, stub);
+    q->tail = stub;
+    return true;
+}
+
+static inline void mpscq_destroy(MPSCQueue *q) {
+    epoch_domain_destroy(&q->epoch);
+    lf_pool_destroy(&q->pool);
+}
+
+static inline EpochThread *mpscq_register(MPSCQueue *q) { return epoch_register(&q->epoch); }
+static inline void mpscq_unregister(EpochThread *th) { epoch_unregister(th); }
+
+/* Any thread. Lock-free: the link never retries, the pool pop may. */
+static inline bool mpscq_enqueue(MPSCQueue *q, EpochThread *th, int value) {
+    epoch_enter(th);
+    LFNode *n = lf_pool_alloc(&q->pool);
+    epoch_exit(th);
+    if (!n) return false;
+    n->data = value;
+    atomic_store_explicit(&n->next, NULL, memory_order_relaxed);
+    LFNode *prev = atomic_exchange_explicit(&q->head, n, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, n, memory_order_release);
+    return true;
+}
+
+/*
+ * Consumer thread only. Returns false if the queue is empty, or if a producer
+ * is between its exchange and its link store (the element shows up shortly).
+ * Also false, leaving the queue unchanged, if no retire slot can be reserved.
+ */
+static inline bool mpscq_dequeue(MPSCQueue *q, EpochThread *th, int *out) {
+    LFNode *tail = q->tail;
+    LFNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (!next || !epoch_reserve(th, 1)) return false;
+    q->tail = next;
+    if (out) *out = next->data;
+    epoch_retire(th, tail, lf_pool_recycle, &q->pool);
+    return true;
+}
+
+#endif
@@ -27,12 +27,46 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+/*
+ * Nodes must come from createNode(), the LinkedList functions or
+ * list_from_array(), and must be released only through freeNode() (or
+ * freeList(), list_destroy() and the list removal functions, which call it).
+ * freeNode() trusts `chunked`: handing it a Node allocated any other way
+ * makes it treat a garbage pointer as a chunk, and calling free() on a
+ * list_from_array() node frees the middle of a chunk.
+ */
 typedef struct Node {
     int data;
+    bool chunked;   /* allocated inside a ListChunk by list_from_array */
     struct Node* next;
 } Node;
 
+/*
+ * Nodes built in bulk live in LIST_CHUNK_BYTES-aligned chunks. The chunk
+ * header counts live nodes, so nodes can still be freed one at a time and
+ * the chunk goes away with its last node.
+ */
+#ifndef LIST_CHUNK_BYTES
+#define LIST_CHUNK_BYTES 4096
+#endif
+
+typedef struct ListChunk {
+    size_t live;
+    size_t reserved;
+} ListChunk;
+
+#define LIST_CHUNK_OF(n) ((ListChunk*)((uintptr_t)(n) & ~(uintptr_t)(LIST_CHUNK_BYTES - 1)))
+
+/**
+ * @brief Creates a new node with the given data.
+ * 
+ * @param data The integer data for the new node.
+ * @return Pointer to the newly created node, or NULL if memory allocation fails.
+ */
 Node* createNode(int data) {
     Node* newNode = (Node*)malloc(sizeof(Node));
     if (!newNode) {
@@ -40,10 +74,34 @@ Node* createNode(int data) {
         return NULL;
     }
     newNode->data = data;
+    newNode->chunked = false;
     newNode->next = NULL;
     return newNode;
 }
 
+/**
+ * @brief Frees a single node, whether it came from createNode or list_from_array.
+ * 
+ * This is the only way to release a node: never free() one directly, and
+ * never pass a Node that was not allocated by this header.
+ * 
+ * @param node The node to free.
+ */
+void freeNode(Node* node) {
+    if (node->chunked) {
+        ListChunk* chunk = LIST_CHUNK_OF(node);
+        if (--chunk->live == 0) free(chunk);
+    } else {
+        free(node);
+    }
+}
+
+/**
+ * @brief Inserts a new node with the given data at the head of the list.
+ * 
+ * @param head Pointer to the pointer to the head of the list.
+ * @param data The integer data to insert.
+ */
 void insertAtHead(Node** head, int data) {
     Node* newNode = createNode(data);
     if (!newNode) return;
@@ -51,6 +109,15 @@ void insertAtHead(Node** head, int data) {
     *head = newNode;
 }
 
+/**
+ * @brief Inserts a new node with the given data at the tail of the list.
+ * 
+ * O(N): it walks from the head to find the tail, so building a list this
+ * way is O(N^2). Use list_push_back() on a LinkedList for O(1) appends.
+ * 
+ * @param head Pointer to the pointer to the head of the list.
+ * @param data The integer data to insert.
+ */
 void insertAtTail(Node** head, int data) {
     Node* newNode = createNode(data);
     if (!newNode) return;
@@ -67,13 +134,22 @@ void insertAtTail(Node** head, int data) {
     temp->next = newNode;
 }
 
+/**
+ * @brief Deletes the first node with the given data value.
+ * 
+ * O(N) in the position of the value. With a LinkedList, list_remove_node()
+ * unlinks a node already in hand in O(1) (doubly-linked mode or the head).
+ * 
+ * @param head Pointer to the pointer to the head of the list.
+ * @param data The integer value to delete from the list.
+ */
 void deleteNode(Node** head, int data) {
     if (*head == NULL) return;
 
     Node* temp = *head;
     if (temp->data == data) {
         *head = temp->next;
-        free(temp);
+        freeNode(temp);
         return;
     }
 
@@ -86,9 +162,16 @@ void deleteNode(Node** head, int data) {
     if (temp == NULL) return;
 
     prev->next = temp->next;
-    free(temp);
+    freeNode(temp);
 }
 
+/**
+ * @brief Searches for a node with the specified data.
+ * 
+ * @param head Pointer to the head of the list.
+ * @param data The integer value to search for.
+ * @return Pointer to the node containing the data, or NULL if not found.
+ */
 Node* search(Node* head, int data) {
     Node* temp = head;
     while (temp != NULL) {
@@ -100,6 +183,11 @@ Node* search(Node* head, int data) {
     return NULL;
 }
 
+/**
+ * @brief Prints the contents of the linked list.
+ * 
+ * @param head Pointer to the head of the list.
+ */
 void printList(Node* head) {
     Node* temp = head;
     while (temp != NULL) {
@@ -109,13 +197,440 @@ void printList(Node* head) {
     printf("NULL\n");
 }
 
+/**
+ * @brief Frees the memory allocated for the linked list.
+ * 
+ * @param head Pointer to the head of the list.
+ */
 void freeList(Node* head) {
     Node* temp;
     while (head != NULL) {
         temp = head;
         head = head->next;
-        free(temp);
+        freeNode(temp);
+    }
+}
+
+// =======================================
+// LinkedList Handle
+// =======================================
+
+/*
+ * A LinkedList owns a chain of Nodes and tracks its tail and size, so pushes
+ * at either end and size queries are O(1). In doubly-linked mode every node is
+ * allocated as a DNode, whose leading Node member keeps it compatible with the
+ * free functions above (search(list.head, x), printList(list.head), ...).
+ */
+typedef struct DNode {
+    Node node;
+    Node* prev;
+} DNode;
+
+typedef struct LinkedList {
+    Node* head;
+    Node* tail;
+    size_t size;
+    bool doubly;
+} LinkedList;
+
+#define LIST_PREV(n) (((DNode*)(n))->prev)
+
+/**
+ * @brief Initializes an empty LinkedList.
+ * 
+ * @param list Pointer to the LinkedList to initialize.
+ * @param doubly True to allocate nodes with a back pointer (O(1) pop_back and removal).
+ */
+void list_init(LinkedList* list, bool doubly) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+    list->doubly = doubly;
+}
+
+/**
+ * @brief Frees every node of the list and leaves it empty.
+ * 
+ * @param list Pointer to the LinkedList to destroy.
+ */
+void list_destroy(LinkedList* list) {
+    freeList(list->head);
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+static Node* list_new_node(const LinkedList* list, int data) {
+    if (!list->doubly) return createNode(data);
+    DNode* dn = (DNode*)malloc(sizeof(DNode));
+    if (!dn) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    dn->node.data = data;
+    dn->node.chunked = false;
+    dn->node.next = NULL;
+    dn->prev = NULL;
+    return &dn->node;
+}
+
+/**
+ * @brief Returns the number of elements in the list.
+ */
+size_t list_size(const LinkedList* list) {
+    return list->size;
+}
+
+/**
+ * @brief Inserts a value at the front of the list in O(1).
+ * 
+ * @return The new node, or NULL if memory allocation fails.
+ */
+Node* list_push_front(LinkedList* list, int data) {
+    Node* n = list_new_node(list, data);
+    if (!n) return NULL;
+    n->next = list->head;
+    if (list->doubly && list->head) LIST_PREV(list->head) = n;
+    list->head = n;
+    if (!list->tail) list->tail = n;
+    list->size++;
+    return n;
+}
+
+/**
+ * @brief Inserts a value at the back of the list in O(1).
+ * 
+ * @return The new node, or NULL if memory allocation fails.
+ */
+Node* list_push_back(LinkedList* list, int data) {
+    Node* n = list_new_node(list, data);
+    if (!n) return NULL;
+    if (list->tail) {
+        list->tail->next = n;
+        if (list->doubly) LIST_PREV(n) = list->tail;
+    } else {
+        list->head = n;
+    }
+    list->tail = n;
+    list->size++;
+    return n;
+}
+
+/**
+ * @brief Inserts a value directly after an existing node in O(1).
+ * 
+ * @param pos Node of this list to insert after; NULL inserts at the front.
+ * @return The new node, or NULL if memory allocation fails.
+ */
+Node* list_insert_after(LinkedList* list, Node* pos, int data) {
+    if (!pos) return list_push_front(list, data);
+    Node* n = list_new_node(list, data);
+    if (!n) return NULL;
+    n->next = pos->next;
+    pos->next = n;
+    if (list->doubly) {
+        LIST_PREV(n) = pos;
+        if (n->next) LIST_PREV(n->next) = n;
+    }
+    if (list->tail == pos) list->tail = n;
+    list->size++;
+    return n;
+}
+
+/**
+ * @brief Returns the node preceding `node`.
+ * 
+ * O(1) for doubly-linked lists, a linear scan from the head otherwise.
+ */
+Node* list_prev(const LinkedList* list, const Node* node) {
+    if (list->doubly) return LIST_PREV(node);
+    Node* prev = NULL;
+    for (Node* cur = list->head; cur && cur != node; cur = cur->next) prev = cur;
+    return prev;
+}
+
+/**
+ * @brief Unlinks and frees a node belonging to the list.
+ * 
+ * O(1) for doubly-linked lists and for the head node; singly-linked lists
+ * otherwise need a scan to find the predecessor.
+ * 
+ * @param list Pointer to the LinkedList.
+ * @param node Node of this list to remove.
+ */
+void list_remove_node(LinkedList* list, Node* node) {
+    Node* prev = (node == list->head) ? NULL : list_prev(list, node);
+    if (prev) prev->next = node->next;
+    else list->head = node->next;
+    if (list->doubly && node->next) LIST_PREV(node->next) = prev;
+    if (list->tail == node) list->tail = prev;
+    list->size--;
+    freeNode(node);
+}
+
+/**
+ * @brief Removes the front element.
+ * 
+ * @param out Receives the removed value if not NULL.
+ * @return True if an element was removed, false if the list was empty.
+ */
+bool list_pop_front(LinkedList* list, int* out) {
+    if (!list->head) return false;
+    if (out) *out = list->head->data;
+    list_remove_node(list, list->head);
+    return true;
+}
+
+/**
+ * @brief Removes the back element (O(1) only in doubly-linked mode).
+ * 
+ * @param out Receives the removed value if not NULL.
+ * @return True if an element was removed, false if the list was empty.
+ */
+bool list_pop_back(LinkedList* list, int* out) {
+    if (!list->tail) return false;
+    if (out) *out = list->tail->data;
+    list_remove_node(list, list->tail);
+    return true;
+}
+
+/**
+ * @brief Removes the first node holding `data`.
+ * 
+ * @return True if a node was removed, false if the value was not found.
+ */
+bool list_remove(LinkedList* list, int data) {
+    Node* prev = NULL;
+    Node* cur = list->head;
+    while (cur && cur->data != data) {
+        prev = cur;
+        cur = cur->next;
+    }
+    if (!cur) return false;
+    if (prev) prev->next = cur->next;
+    else list->head = cur->next;
+    if (list->doubly && cur->next) LIST_PREV(cur->next) = prev;
+    if (list->tail == cur) list->tail = prev;
+    list->size--;
+    freeNode(cur);
+    return true;
+}
+
+/**
+ * @brief Searches the list for a value.
+ * 
+ * @return Pointer to the first node holding `data`, or NULL if not found.
+ */
+Node* list_find(const LinkedList* list, int data) {
+    return search(list->head, data);
+}
+
+/**
+ * @brief Prints the contents of the list.
+ */
+void list_print(const LinkedList* list) {
+    printList(list->head);
+}
+
+
+// =======================================
+// Bulk Operations
+// =======================================
+
+static Node* mergeChains(Node* a, Node* b) {
+    Node dummy;
+    Node* tail = &dummy;
+    while (a && b) {
+        if (b->data < a->data) {
+            tail->next = b;
+            b = b->next;
+        } else {
+            tail->next = a;
+            a = a->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = a ? a : b;
+    return dummy.next;
+}
+
+/**
+ * @brief Sorts a singly linked chain in ascending order.
+ * 
+ * Bottom-up merge sort: nodes are merged into runs of doubling length held in
+ * a small array of bins, so the sort is O(n log n), stable, relinks nodes in
+ * place and uses no recursion.
+ * 
+ * @param head Pointer to the pointer to the head of the list.
+ */
+void sortList(Node** head) {
+    Node* bins[64] = { NULL };
+    int fill = 0;
+    Node* rest = *head;
+    while (rest) {
+        Node* carry = rest;
+        rest = rest->next;
+        carry->next = NULL;
+        int i = 0;
+        while (i < fill && bins[i]) {
+            carry = mergeChains(bins[i], carry);
+            bins[i] = NULL;
+            i++;
+        }
+        bins[i] = carry;
+        if (i == fill) fill++;
+    }
+    Node* result = NULL;
+    for (int i = 0; i < fill; ++i) {
+        if (bins[i]) result = mergeChains(bins[i], result);
+    }
+    *head = result;
+}
+
+/* Recomputes tail (and prev links in doubly mode) after relinking the chain. */
+static void list_relink(LinkedList* list) {
+    Node* prev = NULL;
+    size_t size = 0;
+    for (Node* cur = list->head; cur; cur = cur->next) {
+        if (list->doubly) LIST_PREV(cur) = prev;
+        prev = cur;
+        size++;
+    }
+    list->tail = prev;
+    list->size = size;
+}
+
+/**
+ * @brief Sorts the list in ascending order in O(n log n), without allocating.
+ */
+void list_sort(LinkedList* list) {
+    sortList(&list->head);
+    list_relink(list);
+}
+
+/**
+ * @brief Merges the sorted list `src` into the sorted list `dst` in linear time.
+ * 
+ * `src` is left empty. Both lists must use the same node layout.
+ * 
+ * @return False if the lists differ in doubly-linked mode, true otherwise.
+ */
+bool list_merge(LinkedList* dst, LinkedList* src) {
+    if (dst->doubly != src->doubly) return false;
+    dst->head = mergeChains(dst->head, src->head);
+    list_relink(dst);
+    list_init(src, src->doubly);
+    return true;
+}
+
+/**
+ * @brief Moves every node of `src` into `dst` right after `pos` in O(1).
+ * 
+ * @param pos Node of `dst` to splice after; NULL splices at the front.
+ * @return False if the lists differ in doubly-linked mode, true otherwise.
+ */
+bool list_splice(LinkedList* dst, Node* pos, LinkedList* src) {
+    if (dst->doubly != src->doubly) return false;
+    if (!src->head) return true;
+    Node* after = pos ? pos->next : dst->head;
+    if (pos) pos->next = src->head;
+    else dst->head = src->head;
+    src->tail->next = after;
+    if (dst->doubly) {
+        LIST_PREV(src->head) = pos;
+        if (after) LIST_PREV(after) = src->tail;
+    }
+    if (!after) dst->tail = src->tail;
+    dst->size += src->size;
+    list_init(src, src->doubly);
+    return true;
+}
+
+/**
+ * @brief Moves the elements from position `index` onwards into `out`.
+ * 
+ * `out` is (re)initialized with the same layout as `list`. O(index).
+ * 
+ * @return False if `index` is past the end of the list.
+ */
+bool list_split(LinkedList* list, size_t index, LinkedList* out) {
+    if (index > list->size) return false;
+    list_init(out, list->doubly);
+    if (index == list->size) return true;
+    Node* prev = NULL;
+    Node* cur = list->head;
+    for (size_t i = 0; i < index; ++i) {
+        prev = cur;
+        cur = cur->next;
+    }
+    out->head = cur;
+    out->tail = list->tail;
+    out->size = list->size - index;
+    if (list->doubly) LIST_PREV(cur) = NULL;
+    if (prev) prev->next = NULL;
+    else list->head = NULL;
+    list->tail = prev;
+    list->size = index;
+    return true;
+}
+
+/**
+ * @brief Reverses the list in place in O(n).
+ */
+void list_reverse(LinkedList* list) {
+    Node* prev = NULL;
+    Node* cur = list->head;
+    list->tail = cur;
+    while (cur) {
+        Node* next = cur->next;
+        cur->next = prev;
+        if (list->doubly) LIST_PREV(cur) = next;
+        prev = cur;
+        cur = next;
+    }
+    list->head = prev;
+}
+
+/**
+ * @brief Builds a list holding a copy of `values`, in order.
+ * 
+ * Nodes are laid out back to back in page-sized chunks rather than allocated
+ * one by one, so traversal walks memory sequentially. They remain ordinary
+ * nodes: they can be removed, spliced or freed individually.
+ * 
+ * @param list Pointer to the LinkedList to initialize.
+ * @param values Array of `n` values.
+ * @param doubly True to build a doubly-linked list.
+ * @return False if memory allocation fails (the list is left empty).
+ */
+bool list_from_array(LinkedList* list, const int* values, size_t n, bool doubly) {
+    list_init(list, doubly);
+    size_t stride = doubly ? sizeof(DNode) : sizeof(Node);
+    size_t per_chunk = (LIST_CHUNK_BYTES - sizeof(ListChunk)) / stride;
+    size_t i = 0;
+    while (i < n) {
+        ListChunk* chunk = (ListChunk*)aligned_alloc(LIST_CHUNK_BYTES, LIST_CHUNK_BYTES);
+        if (!chunk) {
+            printf("Memory allocation failed\n");
+            list_destroy(list);
+            return false;
+        }
+        size_t count = (n - i < per_chunk) ? n - i : per_chunk;
+        chunk->live = count;
+        char* base = (char*)(chunk + 1);
+        for (size_t j = 0; j < count; ++j, ++i) {
+            Node* node = (Node*)(base + j * stride);
+            node->data = values[i];
+            node->chunked = true;
+            node->next = NULL;
+            if (doubly) LIST_PREV(node) = list->tail;
+            if (list->tail) list->tail->next = node;
+            else list->head = node;
+            list->tail = node;
+        }
+        list->size += count;
     }
+    return true;
 }
 
 #endif 
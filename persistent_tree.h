@@ -0,0 +1,460 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef PERSISTENT_TREE_H
+#define PERSISTENT_TREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "tree.h"
+#include "epoch.h"
+
+/*
+ * Persistent AVL tree with O(1) snapshots.
+ *
+ * Nodes are never modified once published. ptree_insert() and
+ * ptree_remove() copy only the nodes on the search path (plus the few that
+ * rotations touch) and publish a new version by swapping one pointer, so
+ * every older version stays intact and shares all untouched subtrees with
+ * the new one. ptree_snapshot() just takes a reference on the current
+ * version; readers then search it with no locks while the writer moves on.
+ *
+ * Nodes and versions are reference counted and freed when the last
+ * version using them is released. A key/value pair is owned by an entry
+ * shared by every copy of its node, so free_key/free_value run only once no
+ * version can reach the pair any more. The writer drops its reference on a
+ * replaced version through epoch.h, which keeps a reader that is between
+ * loading the current version and counting its reference safe.
+ *
+ * BSTNode's parent pointers cannot be shared between versions, so this is
+ * a separate PTree type rather than a BST mode. Updates must come from one
+ * thread at a time; snapshots may be taken and read from any thread that
+ * called ptree_register(). Release every snapshot before ptree_destroy().
+ */
+
+typedef struct PTreeEntry {
+    void *key;
+    void *value;
+    atomic_uint refs;           /* nodes holding this pair */
+} PTreeEntry;
+
+typedef struct PTreeNode {
+    void *key;                  /* copies of entry->key/value, kept inline */
+    void *value;
+    struct PTreeNode *left;
+    struct PTreeNode *right;
+    PTreeEntry *entry;
+    atomic_uint refs;           /* parents and version roots pointing here */
+    int height;
+    uint64_t stamp;             /* update that created the node */
+} PTreeNode;
+
+typedef struct PTreeSnapshot {
+    PTreeNode *root;
+    size_t size;
+    atomic_uint refs;
+    struct PTree *tree;
+} PTreeSnapshot;
+
+typedef struct PTree {
+    _Atomic(PTreeSnapshot *) current;
+    bst_cmp_fn cmp;
+    bst_free_fn free_key;
+    bst_free_fn free_value;
+    uint64_t stamp;             /* bumped by every update */
+    EpochDomain epoch;
+} PTree;
+
+static inline PTree *ptree_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
+    if (!cmp) return NULL;
+    PTree *t = (PTree *)malloc(sizeof(PTree));
+    PTreeSnapshot *s = (PTreeSnapshot *)malloc(sizeof(PTreeSnapshot));
+    if (!t || !s) { free(t); free(s); return NULL; }
+    s->root = NULL;
+    s->size = 0;
+    atomic_init(&s->refs, 1);
+    s->tree = t;
+    atomic_init(&t->current, s);
+    t->cmp = cmp;
+    t->free_key = free_key;
+    t->free_value = free_value;
+    t->stamp = 0;
+    epoch_domain_init(&t->epoch);
+    return t;
+}
+
+static inline EpochThread *ptree_register(PTree *t) { return epoch_register(&t->epoch); }
+static inline void ptree_unregister(EpochThread *th) { epoch_unregister(th); }
+
+// =======================================
+// Reference counting
+// =======================================
+
+static inline PTreeNode *ptree_ref(PTreeNode *n) {
+    if (n) atomic_fetch_add_explicit(&n->refs, 1, memory_order_relaxed);
+    return n;
+}
+
+static inline void ptree_entry_unref(PTree *t, PTreeEntry *e) {
+    if (atomic_fetch_sub_explicit(&e->refs, 1, memory_order_acq_rel) != 1) return;
+    if (t->free_key)   t->free_key(e->key);
+    if (t->free_value) t->free_value(e->value);
+    free(e);
+}
+
+/* Drops one reference; frees the node, and what only it held, at zero. */
+static inline void ptree_unref(PTree *t, PTreeNode *n) {
+    while (n && atomic_fetch_sub_explicit(&n->refs, 1, memory_order_acq_rel) == 1) {
+        PTreeNode *right = n->right;
+        ptree_unref(t, n->left);
+        ptree_entry_unref(t, n->entry);
+        free(n);
+        n = right;
+    }
+}
+
+/* New node for this update. Takes over the references passed in. */
+static inline PTreeNode *ptree_node(PTree *t, PTreeEntry *e, PTreeNode *left, PTreeNode *right) {
+    PTreeNode *n = (PTreeNode *)malloc(sizeof(PTreeNode));
+    if (!n) return NULL;
+    n->key = e->key;
+    n->value = e->value;
+    n->entry = e;
+    n->left = left;
+    n->right = right;
+    atomic_init(&n->refs, 1);
+    int hl = left ? left->height : 0, hr = right ? right->height : 0;
+    n->height = (hl > hr ? hl : hr) + 1;
+    n->stamp = t->stamp;
+    return n;
+}
+
+/* Copy of `n` for this update, sharing its entry and children. */
+static inline PTreeNode *ptree_clone(PTree *t, const PTreeNode *n) {
+    PTreeNode *c = ptree_node(t, n->entry, n->left, n->right);
+    if (!c) return NULL;
+    atomic_fetch_add_explicit(&n->entry->refs, 1, memory_order_relaxed);
+    ptree_ref(n->left);
+    ptree_ref(n->right);
+    return c;
+}
+
+/*
+ * Returns a node of this update that may be modified in place of `n`,
+ * whose reference the caller owns. Nodes from older versions are copied.
+ */
+static inline PTreeNode *ptree_mutable(PTree *t, PTreeNode *n) {
+    if (n->stamp == t->stamp) return n;
+    PTreeNode *c = ptree_clone(t, n);
+    if (c) ptree_unref(t, n);
+    return c;
+}
+
+// =======================================
+// Path-copying AVL updates
+// =======================================
+
+static inline int ptree_height(const PTreeNode *n) { return n ? n->height : 0; }
+
+static inline void ptree_update(PTreeNode *n) {
+    int hl = ptree_height(n->left), hr = ptree_height(n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+}
+
+/* Rotations on a node of this update; NULL (and `n` untouched) if a copy fails. */
+static inline PTreeNode *ptree_rotate_left(PTree *t, PTreeNode *n) {
+    PTreeNode *r = ptree_mutable(t, n->right);
+    if (!r) return NULL;
+    n->right = r->left;
+    r->left = n;
+    ptree_update(n);
+    ptree_update(r);
+    return r;
+}
+
+static inline PTreeNode *ptree_rotate_right(PTree *t, PTreeNode *n) {
+    PTreeNode *l = ptree_mutable(t, n->left);
+    if (!l) return NULL;
+    n->left = l->right;
+    l->right = n;
+    ptree_update(n);
+    ptree_update(l);
+    return l;
+}
+
+/* Rebalances `n` (a node of this update). On failure releases it and returns NULL. */
+static inline PTreeNode *ptree_rebalance(PTree *t, PTreeNode *n) {
+    ptree_update(n);
+    int balance = ptree_height(n->left) - ptree_height(n->right);
+    PTreeNode *r = n;
+    if (balance > 1) {
+        if (ptree_height(n->left->left) < ptree_height(n->left->right)) {
+            PTreeNode *l = ptree_mutable(t, n->left);
+            if (!l) goto fail;
+            n->left = l;
+            if (!(l = ptree_rotate_left(t, l))) goto fail;
+            n->left = l;
+        }
+        if (!(r = ptree_rotate_right(t, n))) goto fail;
+    } else if (balance < -1) {
+        if (ptree_height(n->right->right) < ptree_height(n->right->left)) {
+            PTreeNode *rr = ptree_mutable(t, n->right);
+            if (!rr) goto fail;
+            n->right = rr;
+            if (!(rr = ptree_rotate_right(t, rr))) goto fail;
+            n->right = rr;
+        }
+        if (!(r = ptree_rotate_left(t, n))) goto fail;
+    }
+    return r;
+fail:
+    ptree_unref(t, n);
+    return NULL;
+}
+
+/*
+ * Copy of the subtree at `n` (borrowed from the current version) with
+ * `e` stored under e->key. Returns an owned root, or NULL if out of memory.
+ */
+static inline PTreeNode *ptree_put(PTree *t, PTreeNode *n, PTreeEntry *e) {
+    int c = n ? t->cmp(e->key, n->key) : 0;
+    if (c == 0) {
+        PTreeNode *x = ptree_node(t, e, n ? n->left : NULL, n ? n->right : NULL);
+        if (!x) return NULL;
+        atomic_fetch_add_explicit(&e->refs, 1, memory_order_relaxed);
+        if (n) { ptree_ref(n->left); ptree_ref(n->right); }
+        return x;
+    }
+    PTreeNode *sub = ptree_put(t, c < 0 ? n->left : n->right, e);
+    if (!sub) return NULL;
+    PTreeNode *x = c < 0 ? ptree_node(t, n->entry, sub, n->right)
+                         : ptree_node(t, n->entry, n->left, sub);
+    if (!x) { ptree_unref(t, sub); return NULL; }
+    atomic_fetch_add_explicit(&n->entry->refs, 1, memory_order_relaxed);
+    ptree_ref(c < 0 ? n->right : n->left);
+    return ptree_rebalance(t, x);
+}
+
+/* Copy of `n` without its smallest node, whose entry goes to *min. */
+static inline PTreeNode *ptree_drop_min(PTree *t, PTreeNode *n, PTreeEntry **min, bool *ok) {
+    if (!n->left) {
+        *min = n->entry;
+        *ok = true;
+        return ptree_ref(n->right);
+    }
+    PTreeNode *sub = ptree_drop_min(t, n->left, min, ok);
+    if (!*ok) return NULL;
+    PTreeNode *x = ptree_node(t, n->entry, sub, n->right);
+    if (!x) { ptree_unref(t, sub); *ok = false; return NULL; }
+    atomic_fetch_add_explicit(&n->entry->refs, 1, memory_order_relaxed);
+    ptree_ref(n->right);
+    x = ptree_rebalance(t, x);
+    *ok = x != NULL;
+    return x;
+}
+
+/* Copy of `n` without `key`, which must be present. */
+static inline PTreeNode *ptree_drop(PTree *t, PTreeNode *n, const void *key, bool *ok) {
+    int c = t->cmp(key, n->key);
+    PTreeNode *x;
+    if (c == 0) {
+        if (!n->left || !n->right) {
+            *ok = true;
+            return ptree_ref(n->left ? n->left : n->right);
+        }
+        PTreeEntry *min = NULL;
+        PTreeNode *right = ptree_drop_min(t, n->right, &min, ok);
+        if (!*ok) return NULL;
+        x = ptree_node(t, min, n->left, right);
+        if (!x) { ptree_unref(t, right); *ok = false; return NULL; }
+        atomic_fetch_add_explicit(&min->refs, 1, memory_order_relaxed);
+        ptree_ref(n->left);
+    } else {
+        PTreeNode *sub = ptree_drop(t, c < 0 ? n->left : n->right, key, ok);
+        if (!*ok) return NULL;
+        x = c < 0 ? ptree_node(t, n->entry, sub, n->right)
+                  : ptree_node(t, n->entry, n->left, sub);
+        if (!x) { ptree_unref(t, sub); *ok = false; return NULL; }
+        atomic_fetch_add_explicit(&n->entry->refs, 1, memory_order_relaxed);
+        ptree_ref(c < 0 ? n->right : n->left);
+    }
+    x = ptree_rebalance(t, x);
+    *ok = x != NULL;
+    return x;
+}
+
+// =======================================
+// Versions
+// =======================================
+
+static inline void ptree_snapshot_release(PTreeSnapshot *s) {
+    if (!s || atomic_fetch_sub_explicit(&s->refs, 1, memory_order_acq_rel) != 1) return;
+    ptree_unref(s->tree, s->root);
+    free(s);
+}
+
+/* epoch_free_fn dropping the tree's own reference on a replaced version. */
+static inline void ptree_retire_version(void *ptr, void *ctx) {
+    (void)ctx;
+    ptree_snapshot_release((PTreeSnapshot *)ptr);
+}
+
+/*
+ * Version for an update, allocated and given a retire slot before it so
+ * publishing cannot fail.
+ */
+static inline PTreeSnapshot *ptree_version(PTree *t, EpochThread *th) {
+    if (!epoch_reserve(th, 1)) return NULL;
+    PTreeSnapshot *s = (PTreeSnapshot *)malloc(sizeof(PTreeSnapshot));
+    if (!s) return NULL;
+    atomic_init(&s->refs, 1);
+    s->tree = t;
+    t->stamp++;
+    return s;
+}
+
+/* Makes `s` the current version and retires the one it replaces. */
+static inline void ptree_publish(PTree *t, EpochThread *th, PTreeSnapshot *s) {
+    PTreeSnapshot *old = atomic_exchange_explicit(&t->current, s, memory_order_acq_rel);
+    epoch_retire(th, old, ptree_retire_version, NULL);
+}
+
+/* Version the writer is working on; only valid on the writer thread. */
+static inline PTreeSnapshot *ptree_head(const PTree *t) {
+    return atomic_load_explicit(&((PTree *)t)->current, memory_order_relaxed);
+}
+
+/*
+ * Takes a reference on the current version. O(1); the snapshot stays
+ * unchanged until ptree_snapshot_release().
+ */
+static inline PTreeSnapshot *ptree_snapshot(PTree *t, EpochThread *th) {
+    if (!t) return NULL;
+    epoch_enter(th);
+    PTreeSnapshot *s = atomic_load_explicit(&t->current, memory_order_acquire);
+    atomic_fetch_add_explicit(&s->refs, 1, memory_order_relaxed);
+    epoch_exit(th);
+    return s;
+}
+
+static inline size_t ptree_snapshot_size(const PTreeSnapshot *s) { return s ? s->size : 0; }
+
+static inline void *ptree_snapshot_get(const PTreeSnapshot *s, const void *key) {
+    if (!s) return NULL;
+    bst_cmp_fn cmp = s->tree->cmp;
+    for (const PTreeNode *n = s->root; n; ) {
+        int c = cmp(key, n->key);
+        if (c == 0) return n->value;
+        n = c < 0 ? n->left : n->right;
+    }
+    return NULL;
+}
+
+static inline bool ptree_snapshot_contains(const PTreeSnapshot *s, const void *key) {
+    if (!s) return false;
+    bst_cmp_fn cmp = s->tree->cmp;
+    for (const PTreeNode *n = s->root; n; ) {
+        int c = cmp(key, n->key);
+        if (c == 0) return true;
+        n = c < 0 ? n->left : n->right;
+    }
+    return false;
+}
+
+/* In-order walk; AVL height is bounded, so a fixed stack suffices. */
+static inline void ptree_snapshot_inorder(const PTreeSnapshot *s, bst_visit_fn visit, void *user) {
+    if (!s || !visit) return;
+    const PTreeNode *stack[BST_MAX_HEIGHT];
+    size_t top = 0;
+    const PTreeNode *n = s->root;
+    while (n || top) {
+        while (n) {
+            stack[top++] = n;
+            n = n->left;
+        }
+        n = stack[--top];
+        visit(n->key, n->value, user);
+        n = n->right;
+    }
+}
+
+// =======================================
+// Writer operations
+// =======================================
+
+static inline size_t ptree_size(const PTree *t) { return t ? ptree_head(t)->size : 0; }
+
+static inline void *ptree_get(const PTree *t, const void *key) {
+    return t ? ptree_snapshot_get(ptree_head(t), key) : NULL;
+}
+
+/*
+ * Same return convention as bst_insert(). A replaced key and value are
+ * freed once the last snapshot that can see them is released.
+ */
+static inline bool ptree_insert(PTree *t, EpochThread *th, void *key, void *value) {
+    if (!t) return false;
+    PTreeSnapshot *head = ptree_head(t);
+    PTreeEntry *e = (PTreeEntry *)malloc(sizeof(PTreeEntry));
+    PTreeSnapshot *s = e ? ptree_version(t, th) : NULL;
+    if (!s) { free(e); return false; }
+    e->key = key;
+    e->value = value;
+    atomic_init(&e->refs, 1);   /* held until the new nodes are built */
+    s->root = ptree_put(t, head->root, e);
+    if (!s->root) { free(e); free(s); return false; }
+    atomic_fetch_sub_explicit(&e->refs, 1, memory_order_relaxed);
+    bool added = !ptree_snapshot_contains(head, key);
+    s->size = head->size + added;
+    ptree_publish(t, th, s);
+    return added;
+}
+
+static inline bool ptree_remove(PTree *t, EpochThread *th, const void *key) {
+    if (!t) return false;
+    PTreeSnapshot *head = ptree_head(t);
+    if (!ptree_snapshot_contains(head, key)) return false;
+    PTreeSnapshot *s = ptree_version(t, th);
+    if (!s) return false;
+    bool ok = false;
+    s->root = ptree_drop(t, head->root, key, &ok);
+    if (!ok) { free(s); return false; }
+    s->size = head->size - 1;
+    ptree_publish(t, th, s);
+    return true;
+}
+
+/* All snapshots must have been released and all threads be done with `t`. */
+static inline void ptree_destroy(PTree *t) {
+    if (!t) return;
+    epoch_domain_destroy(&t->epoch);
+    ptree_snapshot_release(atomic_load_explicit(&t->current, memory_order_relaxed));
+    free(t);
+}
+
+#endif
@@ -0,0 +1,391 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef RADIX_TRIE_H
+#define RADIX_TRIE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "trie.h"
+
+/*
+ * Path-compressed (Patricia) variant of Trie with the same operations and
+ * key handling: keys are folded to lowercase a-z and other characters are
+ * skipped, exactly as trie_idx() does.
+ *
+ * Chains of single-child nodes are collapsed into one node whose edge label
+ * is stored inline, and every node's child table is sized to its actual
+ * fanout (one pointer plus one key byte per child) instead of 26 pointers.
+ */
+
+typedef struct RadixNode {
+    void *value;
+    struct RadixNode **child;   /* nchild pointers followed by nchild key bytes */
+    uint32_t len;               /* length of the edge label into this node */
+    uint8_t nchild;
+    bool terminal;
+    char label[];
+} RadixNode;
+
+typedef struct RadixTrie {
+    RadixNode *root;
+    trie_free_fn free_value;
+    size_t size;
+} RadixTrie;
+
+/* `label` may be NULL to leave the label uninitialized. */
+static inline RadixNode *radix_new_node(const char *label, size_t len) {
+    RadixNode *n = (RadixNode *)malloc(sizeof(RadixNode) + len);
+    if (!n) return NULL;
+    n->value = NULL;
+    n->child = NULL;
+    n->len = (uint32_t)len;
+    n->nchild = 0;
+    n->terminal = false;
+    if (label && len) memcpy(n->label, label, len);
+    return n;
+}
+
+static inline char *radix_child_keys(const RadixNode *n) {
+    return (char *)(n->child + n->nchild);
+}
+
+static inline int radix_find_child(const RadixNode *n, char c) {
+    const char *keys = radix_child_keys(n);
+    for (int i = 0; i < n->nchild; ++i) {
+        if (keys[i] == c) return i;
+    }
+    return -1;
+}
+
+/* Inserts `c` keeping the child table sorted by first label byte. */
+static inline bool radix_add_child(RadixNode *n, RadixNode *c) {
+    int count = n->nchild;
+    RadixNode **tab = (RadixNode **)malloc((size_t)(count + 1) * (sizeof(RadixNode *) + 1));
+    if (!tab) return false;
+    char *keys = (char *)(tab + count + 1);
+    const char *old_keys = radix_child_keys(n);
+    int pos = 0;
+    while (pos < count && old_keys[pos] < c->label[0]) pos++;
+    for (int i = 0, j = 0; i <= count; ++i) {
+        if (i == pos) {
+            tab[i] = c;
+            keys[i] = c->label[0];
+        } else {
+            tab[i] = n->child[j];
+            keys[i] = old_keys[j];
+            j++;
+        }
+    }
+    free(n->child);
+    n->child = tab;
+    n->nchild = (uint8_t)(count + 1);
+    return true;
+}
+
+static inline void radix_remove_child(RadixNode *n, int idx) {
+    char *keys = radix_child_keys(n);
+    int count = n->nchild - 1;
+    if (count == 0) {
+        free(n->child);
+        n->child = NULL;
+        n->nchild = 0;
+        return;
+    }
+    /* Shrink in place: shift pointers, then move the key bytes down. */
+    char saved[256];
+    for (int i = 0, j = 0; i <= count; ++i) {
+        if (i != idx) saved[j++] = keys[i];
+    }
+    memmove(n->child + idx, n->child + idx + 1, (size_t)(count - idx) * sizeof(RadixNode *));
+    n->nchild = (uint8_t)count;
+    memcpy(radix_child_keys(n), saved, (size_t)count);
+}
+
+/* Returns a copy of `n` with its label replaced; `n` is freed. */
+static inline RadixNode *radix_relabel(RadixNode *n, const char *label, size_t len) {
+    RadixNode *m = radix_new_node(label, len);
+    if (!m) return NULL;
+    m->value = n->value;
+    m->child = n->child;
+    m->nchild = n->nchild;
+    m->terminal = n->terminal;
+    free(n);
+    return m;
+}
+
+/*
+ * Folds `word` to the letters trie_idx() keeps, in lowercase.
+ * Returns a buffer that is either `buf` or malloc'd (caller frees if != buf).
+ */
+static inline char *radix_key(const char *word, char *buf, size_t cap, size_t *len) {
+    size_t n = 0;
+    for (const char *p = word; *p; ++p) n += trie_idx(*p) >= 0;
+    char *out = (n <= cap) ? buf : (char *)malloc(n ? n : 1);
+    if (!out) return NULL;
+    size_t i = 0;
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id >= 0) out[i++] = (char)('a' + id);
+    }
+    *len = n;
+    return out;
+}
+
+static inline RadixTrie *radix_trie_create(trie_free_fn free_value) {
+    RadixTrie *t = (RadixTrie *)malloc(sizeof(RadixTrie));
+    if (!t) return NULL;
+    t->root = radix_new_node(NULL, 0);
+    if (!t->root) { free(t); return NULL; }
+    t->free_value = free_value;
+    t->size = 0;
+    return t;
+}
+
+/* Drops the value a node holds, leaving its `value` field free for reuse. */
+static inline void radix_free_value(RadixTrie *t, RadixNode *n) {
+    if (n->terminal && t->free_value) t->free_value(n->value);
+    n->value = NULL;
+}
+
+/*
+ * Frees every node without allocating, so deep tries cannot overflow the
+ * stack: nodes waiting to be freed are chained through their `value` field
+ * once their own value has been released.
+ */
+static inline void radix_trie_destroy(RadixTrie *t) {
+    if (!t) return;
+    RadixNode *queue = t->root;
+    radix_free_value(t, queue);
+    while (queue) {
+        RadixNode *n = queue;
+        queue = (RadixNode *)n->value;
+        for (int i = 0; i < n->nchild; ++i) {
+            RadixNode *c = n->child[i];
+            radix_free_value(t, c);
+            c->value = queue;
+            queue = c;
+        }
+        free(n->child);
+        free(n);
+    }
+    free(t);
+}
+
+static inline size_t radix_trie_size(const RadixTrie *t) { return t ? t->size : 0; }
+
+static inline bool radix_trie_insert(RadixTrie *t, const char *word, void *value) {
+    if (!t || !word) return false;
+    char buf[256];
+    size_t len;
+    char *key = radix_key(word, buf, sizeof(buf), &len);
+    if (!key) return false;
+
+    bool ok = false;
+    RadixNode *cur = t->root;
+    size_t i = 0;
+    while (i < len) {
+        int ci = radix_find_child(cur, key[i]);
+        if (ci < 0) {
+            RadixNode *leaf = radix_new_node(key + i, len - i);
+            if (!leaf) goto out;
+            if (!radix_add_child(cur, leaf)) { free(leaf); goto out; }
+            cur = leaf;
+            i = len;
+            break;
+        }
+        RadixNode *c = cur->child[ci];
+        size_t common = 0;
+        while (common < c->len && i + common < len && c->label[common] == key[i + common]) common++;
+        if (common == c->len) {
+            cur = c;
+            i += common;
+            continue;
+        }
+        /* Split the edge: cur -> mid(label[0..common]) -> c(label[common..]). */
+        RadixNode *mid = radix_new_node(c->label, common);
+        if (!mid) goto out;
+        mid->child = (RadixNode **)malloc(sizeof(RadixNode *) + 1);
+        if (!mid->child) { free(mid); goto out; }
+        RadixNode *rest = radix_relabel(c, c->label + common, c->len - common);
+        if (!rest) { free(mid->child); free(mid); goto out; }
+        mid->nchild = 1;
+        mid->child[0] = rest;
+        radix_child_keys(mid)[0] = rest->label[0];
+        cur->child[ci] = mid;
+        cur = mid;
+        i += common;
+    }
+    if (!cur->terminal) {
+        cur->terminal = true;
+        cur->value = value;
+        t->size++;
+        ok = true;
+    } else {
+        if (t->free_value) t->free_value(cur->value);
+        cur->value = value;
+    }
+out:
+    if (key != buf) free(key);
+    return ok;
+}
+
+/* Walks `key`; returns the node ending exactly at it, or NULL. */
+static inline const RadixNode *radix_lookup(const RadixTrie *t, const char *key, size_t len,
+                                            bool allow_partial) {
+    const RadixNode *cur = t->root;
+    size_t i = 0;
+    while (i < len) {
+        int ci = radix_find_child(cur, key[i]);
+        if (ci < 0) return NULL;
+        const RadixNode *c = cur->child[ci];
+        size_t n = c->len < len - i ? c->len : len - i;
+        if (memcmp(c->label, key + i, n) != 0) return NULL;
+        if (n < c->len && !allow_partial) return NULL;
+        cur = c;
+        i += n;
+    }
+    return cur;
+}
+
+static inline bool radix_trie_contains(const RadixTrie *t, const char *word) {
+    if (!t || !word) return false;
+    char buf[256];
+    size_t len;
+    char *key = radix_key(word, buf, sizeof(buf), &len);
+    if (!key) return false;
+    const RadixNode *n = radix_lookup(t, key, len, false);
+    if (key != buf) free(key);
+    return n && n->terminal;
+}
+
+static inline void *radix_trie_get(const RadixTrie *t, const char *word) {
+    if (!t || !word) return NULL;
+    char buf[256];
+    size_t len;
+    char *key = radix_key(word, buf, sizeof(buf), &len);
+    if (!key) return NULL;
+    const RadixNode *n = radix_lookup(t, key, len, false);
+    if (key != buf) free(key);
+    return (n && n->terminal) ? n->value : NULL;
+}
+
+static inline bool radix_trie_starts_with(const RadixTrie *t, const char *prefix) {
+    if (!t || !prefix) return false;
+    char buf[256];
+    size_t len;
+    char *key = radix_key(prefix, buf, sizeof(buf), &len);
+    if (!key) return false;
+    const RadixNode *n = radix_lookup(t, key, len, true);
+    if (key != buf) free(key);
+    return n != NULL;
+}
+
+/* Merges a non-terminal single-child node with its child. */
+static inline RadixNode *radix_merge_child(RadixNode *n) {
+    RadixNode *c = n->child[0];
+    RadixNode *m = radix_new_node(NULL, (size_t)n->len + c->len);
+    if (!m) return n;
+    memcpy(m->label, n->label, n->len);
+    memcpy(m->label + n->len, c->label, c->len);
+    m->value = c->value;
+    m->child = c->child;
+    m->nchild = c->nchild;
+    m->terminal = c->terminal;
+    free(n->child);
+    free(n);
+    free(c);
+    return m;
+}
+
+static inline bool radix_trie_remove(RadixTrie *t, const char *word) {
+    if (!t || !word) return false;
+    char buf[256];
+    size_t len;
+    char *key = radix_key(word, buf, sizeof(buf), &len);
+    if (!key) return false;
+
+    RadixNode *grand = NULL, *parent = NULL, *cur = t->root;
+    int gi = -1, pi = -1;
+    size_t i = 0;
+    while (i < len) {
+        int ci = radix_find_child(cur, key[i]);
+        if (ci < 0) break;
+        RadixNode *c = cur->child[ci];
+        if (c->len > len - i || memcmp(c->label, key + i, c->len) != 0) break;
+        grand = parent; gi = pi;
+        parent = cur; pi = ci;
+        cur = c;
+        i += c->len;
+    }
+    if (key != buf) free(key);
+    if (i < len || !cur->terminal) return false;
+
+    if (t->free_value) t->free_value(cur->value);
+    cur->value = NULL;
+    cur->terminal = false;
+    t->size--;
+    if (cur == t->root) return true;
+
+    if (cur->nchild == 0) {
+        radix_remove_child(parent, pi);
+        free(cur->child);
+        free(cur);
+        /* The parent may now be a pass-through node. */
+        if (parent != t->root && !parent->terminal && parent->nchild == 1) {
+            grand->child[gi] = radix_merge_child(parent);
+        }
+    } else if (cur->nchild == 1) {
+        parent->child[pi] = radix_merge_child(cur);
+    }
+    return true;
+}
+
+/* Bytes held by the trie's nodes and child tables. */
+static inline size_t radix_trie_memory(const RadixTrie *t) {
+    if (!t) return 0;
+    size_t total = 0, cap = 64, top = 0;
+    const RadixNode **stack = (const RadixNode **)malloc(cap * sizeof(RadixNode *));
+    if (!stack) return 0;
+    stack[top++] = t->root;
+    while (top) {
+        const RadixNode *n = stack[--top];
+        total += sizeof(RadixNode) + n->len + (size_t)n->nchild * (sizeof(RadixNode *) + 1);
+        if (top + n->nchild > cap) {
+            while (top + n->nchild > cap) cap *= 2;
+            const RadixNode **grown = (const RadixNode **)realloc(stack, cap * sizeof(RadixNode *));
+            if (!grown) break;
+            stack = grown;
+        }
+        for (int i = 0; i < n->nchild; ++i) stack[top++] = n->child[i];
+    }
+    free(stack);
+    return total;
+}
+
+#endif
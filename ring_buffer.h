@@ -0,0 +1,235 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+/*
+ * Bounded ring buffers of ints with a power-of-two capacity.
+ *
+ * SPSCRing: one producer and one consumer, both wait-free. Head and tail sit
+ * on separate cache lines, and each side keeps a cached copy of the other's
+ * index so it only reads the shared line when the ring looks full or empty.
+ *
+ * MPMCRing: any number of producers and consumers (Vyukov's bounded queue).
+ * Each slot carries a sequence number that says whose turn it is, so
+ * producers and consumers only contend on their own position counter.
+ */
+
+#define RING_CACHE_LINE 64
+
+/* Smallest power of two >= n (at least 2), or 0 if that overflows size_t. */
+static inline size_t ring_round_pow2(size_t n) {
+    if (n > SIZE_MAX / 2 + 1) return 0;
+    size_t cap = 2;
+    while (cap < n) cap <<= 1;
+    return cap;
+}
+
+// =======================================
+// Single-producer single-consumer ring
+// =======================================
+
+typedef struct SPSCRing {
+    alignas(RING_CACHE_LINE) atomic_size_t head;   /* next slot to read */
+    size_t cached_tail;                            /* consumer's view of tail */
+    alignas(RING_CACHE_LINE) atomic_size_t tail;   /* next slot to write */
+    size_t cached_head;                            /* producer's view of head */
+    alignas(RING_CACHE_LINE) int *buf;
+    size_t mask;
+} SPSCRing;
+
+/* Capacity is rounded up to a power of two. False if out of memory or too large. */
+static inline bool spsc_ring_init(SPSCRing *r, size_t capacity) {
+    size_t cap = ring_round_pow2(capacity);
+    if (!cap || cap > SIZE_MAX / sizeof(int)) return false;
+    r->buf = (int *)malloc(cap * sizeof(int));
+    if (!r->buf) return false;
+    r->mask = cap - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->cached_head = r->cached_tail = 0;
+    return true;
+}
+
+static inline void spsc_ring_destroy(SPSCRing *r) {
+    free(r->buf);
+    r->buf = NULL;
+}
+
+static inline size_t spsc_ring_capacity(const SPSCRing *r) { return r->mask + 1; }
+
+/* Producer only. Pushes up to `n` values and returns how many fit. */
+static inline size_t spsc_ring_push_n(SPSCRing *r, const int *values, size_t n) {
+    size_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t cap = r->mask + 1;
+    size_t free_slots = cap - (t - r->cached_head);
+    if (free_slots < n) {
+        r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+        free_slots = cap - (t - r->cached_head);
+        if (n > free_slots) n = free_slots;
+    }
+    for (size_t i = 0; i < n; ++i) r->buf[(t + i) & r->mask] = values[i];
+    if (n) atomic_store_explicit(&r->tail, t + n, memory_order_release);
+    return n;
+}
+
+/* Consumer only. Pops up to `n` values into `out` and returns how many. */
+static inline size_t spsc_ring_pop_n(SPSCRing *r, int *out, size_t n) {
+    size_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t avail = r->cached_tail - h;
+    if (avail < n) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        avail = r->cached_tail - h;
+        if (n > avail) n = avail;
+    }
+    for (size_t i = 0; i < n; ++i) out[i] = r->buf[(h + i) & r->mask];
+    if (n) atomic_store_explicit(&r->head, h + n, memory_order_release);
+    return n;
+}
+
+static inline bool spsc_ring_push(SPSCRing *r, int value) {
+    return spsc_ring_push_n(r, &value, 1) == 1;
+}
+
+static inline bool spsc_ring_pop(SPSCRing *r, int *out) {
+    return spsc_ring_pop_n(r, out, 1) == 1;
+}
+
+/* Approximate when called while the other side is running. */
+static inline size_t spsc_ring_size(SPSCRing *r) {
+    return atomic_load_explicit(&r->tail, memory_order_acquire) -
+           atomic_load_explicit(&r->head, memory_order_acquire);
+}
+
+// =======================================
+// Multi-producer multi-consumer ring
+// =======================================
+
+typedef struct RingSlot {
+    atomic_size_t seq;
+    int value;
+} RingSlot;
+
+typedef struct MPMCRing {
+    alignas(RING_CACHE_LINE) atomic_size_t enqueue_pos;
+    alignas(RING_CACHE_LINE) atomic_size_t dequeue_pos;
+    alignas(RING_CACHE_LINE) RingSlot *slots;
+    size_t mask;
+} MPMCRing;
+
+static inline bool mpmc_ring_init(MPMCRing *r, size_t capacity) {
+    size_t cap = ring_round_pow2(capacity);
+    if (!cap || cap > SIZE_MAX / sizeof(RingSlot)) return false;
+    r->slots = (RingSlot *)malloc(cap * sizeof(RingSlot));
+    if (!r->slots) return false;
+    for (size_t i = 0; i < cap; ++i) atomic_init(&r->slots[i].seq, i);
+    r->mask = cap - 1;
+    atomic_init(&r->enqueue_pos, 0);
+    atomic_init(&r->dequeue_pos, 0);
+    return true;
+}
+
+static inline void mpmc_ring_destroy(MPMCRing *r) {
+    free(r->slots);
+    r->slots = NULL;
+}
+
+static inline size_t mpmc_ring_capacity(const MPMCRing *r) { return r->mask + 1; }
+
+/* Returns false if the ring is full. */
+static inline bool mpmc_ring_push(MPMCRing *r, int value) {
+    size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    RingSlot *slot;
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    slot->value = value;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+/* Returns false if the ring is empty. */
+static inline bool mpmc_ring_pop(MPMCRing *r, int *out) {
+    size_t pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+    RingSlot *slot;
+    for (;;) {
+        slot = &r->slots[pos & r->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&r->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    *out = slot->value;
+    atomic_store_explicit(&slot->seq, pos + r->mask + 1, memory_order_release);
+    return true;
+}
+
+/*
+ * Batch forms. Slots are still claimed one at a time: a contiguous claim
+ * would need every slot in the range to be released already, which the
+ * per-slot protocol does not guarantee.
+ */
+static inline size_t mpmc_ring_push_n(MPMCRing *r, const int *values, size_t n) {
+    size_t i = 0;
+    while (i < n && mpmc_ring_push(r, values[i])) i++;
+    return i;
+}
+
+static inline size_t mpmc_ring_pop_n(MPMCRing *r, int *out, size_t n) {
+    size_t i = 0;
+    while (i < n && mpmc_ring_pop(r, &out[i])) i++;
+    return i;
+}
+
+#endif
@@ -0,0 +1,456 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "epoch.h"
+
+/*
+ * Skip list ordered sets of ints with O(log n) expected insert, search and
+ * remove.
+ *
+ * SkipList is single-threaded. Each node's tower is sized to its level (the
+ * level lives in one byte), and nodes are carved from slabs and recycled
+ * through per-level free lists, so churn does not hit malloc.
+ *
+ * CSkipList is the lock-free variant (Herlihy & Shavit): links carry a mark
+ * bit, lookups never write, and removed nodes are reclaimed through epoch.h.
+ */
+
+#ifndef SKIPLIST_MAX_LEVEL
+#define SKIPLIST_MAX_LEVEL 24
+#endif
+
+#ifndef SKIPLIST_SLAB_BYTES
+#define SKIPLIST_SLAB_BYTES 65536
+#endif
+
+/* Level with P(level > k) = 4^-k; p = 1/4 keeps about 1.33 links per node. */
+static inline int skiplist_level_from(uint64_t r) {
+    int level = 1;
+    while ((r & 3) == 0 && level < SKIPLIST_MAX_LEVEL) {
+        level++;
+        r >>= 2;
+    }
+    return level;
+}
+
+static inline uint64_t skiplist_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// =======================================
+// Single-threaded skip list
+// =======================================
+
+typedef struct SkipNode {
+    int key;
+    uint8_t level;
+    struct SkipNode *next[];
+} SkipNode;
+
+typedef struct SkipSlab {
+    struct SkipSlab *next;
+    size_t used;
+    alignas(max_align_t) unsigned char mem[SKIPLIST_SLAB_BYTES];
+} SkipSlab;
+
+typedef struct SkipList {
+    SkipNode *head;
+    int level;
+    size_t size;
+    uint64_t rng;
+    SkipNode *free_nodes[SKIPLIST_MAX_LEVEL + 1];
+    SkipSlab *slabs;
+} SkipList;
+
+typedef void (*skiplist_visit_fn)(int key, void *user);
+
+static inline size_t skiplist_node_bytes(int level) {
+    size_t n = offsetof(SkipNode, next) + (size_t)level * sizeof(SkipNode *);
+    return (n + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+static inline SkipNode *skiplist_alloc_node(SkipList *sl, int level) {
+    SkipNode *n = sl->free_nodes[level];
+    if (n) {
+        sl->free_nodes[level] = n->next[0];
+        return n;
+    }
+    size_t bytes = skiplist_node_bytes(level);
+    if (!sl->slabs || sl->slabs->used + bytes > SKIPLIST_SLAB_BYTES) {
+        SkipSlab *slab = (SkipSlab *)malloc(sizeof(SkipSlab));
+        if (!slab) return NULL;
+        slab->next = sl->slabs;
+        slab->used = 0;
+        sl->slabs = slab;
+    }
+    n = (SkipNode *)(sl->slabs->mem + sl->slabs->used);
+    sl->slabs->used += bytes;
+    n->level = (uint8_t)level;
+    return n;
+}
+
+static inline void skiplist_release_node(SkipList *sl, SkipNode *n) {
+    n->next[0] = sl->free_nodes[n->level];
+    sl->free_nodes[n->level] = n;
+}
+
+static inline SkipList *skiplist_create(void) {
+    SkipList *sl = (SkipList *)calloc(1, sizeof(SkipList));
+    if (!sl) return NULL;
+    sl->head = (SkipNode *)calloc(1, skiplist_node_bytes(SKIPLIST_MAX_LEVEL));
+    if (!sl->head) { free(sl); return NULL; }
+    sl->head->level = SKIPLIST_MAX_LEVEL;
+    sl->level = 1;
+    sl->rng = (uint64_t)(uintptr_t)sl;
+    return sl;
+}
+
+static inline void skiplist_destroy(SkipList *sl) {
+    if (!sl) return;
+    SkipSlab *slab = sl->slabs;
+    while (slab) {
+        SkipSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(sl->head);
+    free(sl);
+}
+
+static inline size_t skiplist_size(const SkipList *sl) { return sl ? sl->size : 0; }
+
+/* Fills update[] with the rightmost node before `key` on every level. */
+static inline SkipNode *skiplist_find(const SkipList *sl, int key, SkipNode **update) {
+    SkipNode *x = sl->head;
+    for (int i = sl->level - 1; i >= 0; --i) {
+        while (x->next[i] && x->next[i]->key < key) x = x->next[i];
+        if (update) update[i] = x;
+    }
+    return x->next[0];
+}
+
+static inline bool skiplist_insert(SkipList *sl, int key) {
+    if (!sl) return false;
+    SkipNode *update[SKIPLIST_MAX_LEVEL];
+    SkipNode *x = skiplist_find(sl, key, update);
+    if (x && x->key == key) return false;
+
+    int level = skiplist_level_from(skiplist_mix(sl->rng++));
+    SkipNode *n = skiplist_alloc_node(sl, level);
+    if (!n) return false;
+    if (level > sl->level) {
+        for (int i = sl->level; i < level; ++i) update[i] = sl->head;
+        sl->level = level;
+    }
+    n->key = key;
+    for (int i = 0; i < level; ++i) {
+        n->next[i] = update[i]->next[i];
+        update[i]->next[i] = n;
+    }
+    sl->size++;
+    return true;
+}
+
+static inline bool skiplist_contains(const SkipList *sl, int key) {
+    if (!sl) return false;
+    SkipNode *x = skiplist_find(sl, key, NULL);
+    return x && x->key == key;
+}
+
+static inline bool skiplist_remove(SkipList *sl, int key) {
+    if (!sl) return false;
+    SkipNode *update[SKIPLIST_MAX_LEVEL];
+    SkipNode *x = skiplist_find(sl, key, update);
+    if (!x || x->key != key) return false;
+    for (int i = 0; i < x->level; ++i) update[i]->next[i] = x->next[i];
+    while (sl->level > 1 && !sl->head->next[sl->level - 1]) sl->level--;
+    skiplist_release_node(sl, x);
+    sl->size--;
+    return true;
+}
+
+/* First node with key >= `key`, or NULL. Walk on with skiplist_next(). */
+static inline const SkipNode *skiplist_lower_bound(const SkipList *sl, int key) {
+    return sl ? skiplist_find(sl, key, NULL) : NULL;
+}
+
+static inline const SkipNode *skiplist_next(const SkipNode *n) {
+    return n ? n->next[0] : NULL;
+}
+
+/* Visits every key in [lo, hi] in ascending order; returns how many. */
+static inline size_t skiplist_range(const SkipList *sl, int lo, int hi,
+                                    skiplist_visit_fn visit, void *user) {
+    size_t count = 0;
+    for (const SkipNode *n = skiplist_lower_bound(sl, lo); n && n->key <= hi; n = n->next[0]) {
+        if (visit) visit(n->key, user);
+        count++;
+    }
+    return count;
+}
+
+// =======================================
+// Lock-free skip list
+// =======================================
+
+typedef struct CSkipNode {
+    int key;
+    uint8_t level;
+    atomic_int owners;                /* inserter + remover; last one retires */
+    _Atomic(uintptr_t) next[];        /* low bit marks the node as removed */
+} CSkipNode;
+
+typedef struct CSkipList {
+    CSkipNode *head;
+    atomic_size_t size;
+    EpochDomain epoch;
+} CSkipList;
+
+#define CSKIP_MARK ((uintptr_t)1)
+
+static inline CSkipNode *cskip_ptr(uintptr_t v) { return (CSkipNode *)(v & ~CSKIP_MARK); }
+static inline bool cskip_marked(uintptr_t v) { return (v & CSKIP_MARK) != 0; }
+
+static inline CSkipNode *cskip_new_node(int key, int level) {
+    CSkipNode *n = (CSkipNode *)malloc(offsetof(CSkipNode, next) + (size_t)level * sizeof(uintptr_t));
+    if (!n) return NULL;
+    n->key = key;
+    n->level = (uint8_t)level;
+    atomic_init(&n->owners, 2);
+    for (int i = 0; i < level; ++i) atomic_init(&n->next[i], 0);
+    return n;
+}
+
+static inline CSkipList *cskiplist_create(void) {
+    CSkipList *sl = (CSkipList *)malloc(sizeof(CSkipList));
+    if (!sl) return NULL;
+    sl->head = cskip_new_node(0, SKIPLIST_MAX_LEVEL);
+    if (!sl->head) { free(sl); return NULL; }
+    atomic_init(&sl->size, 0);
+    epoch_domain_init(&sl->epoch);
+    return sl;
+}
+
+/* All other threads must be done with the list. */
+static inline void cskiplist_destroy(CSkipList *sl) {
+    if (!sl) return;
+    epoch_domain_destroy(&sl->epoch);
+    CSkipNode *n = cskip_ptr(atomic_load_explicit(&sl->head->next[0], memory_order_relaxed));
+    while (n) {
+        CSkipNode *next = cskip_ptr(atomic_load_explicit(&n->next[0], memory_order_relaxed));
+        free(n);
+        n = next;
+    }
+    free(sl->head);
+    free(sl);
+}
+
+static inline EpochThread *cskiplist_register(CSkipList *sl) { return epoch_register(&sl->epoch); }
+static inline void cskiplist_unregister(EpochThread *th) { epoch_unregister(th); }
+
+static inline size_t cskiplist_size(const CSkipList *sl) {
+    return sl ? atomic_load_explicit(&sl->size, memory_order_relaxed) : 0;
+}
+
+/*
+ * Finds preds/succs for `key` on every level, unlinking marked nodes on the
+ * way. Must run inside an epoch critical section.
+ */
+static inline bool cskip_find(CSkipList *sl, int key, CSkipNode **preds, CSkipNode **succs) {
+retry:;
+    CSkipNode *pred = sl->head;
+    for (int i = SKIPLIST_MAX_LEVEL - 1; i >= 0; --i) {
+        CSkipNode *curr = cskip_ptr(atomic_load_explicit(&pred->next[i], memory_order_acquire));
+        while (curr) {
+            uintptr_t succ = atomic_load_explicit(&curr->next[i], memory_order_acquire);
+            while (cskip_marked(succ)) {
+                uintptr_t expected = (uintptr_t)curr;
+                if (!atomic_compare_exchange_strong_explicit(&pred->next[i], &expected,
+                                                             succ & ~CSKIP_MARK,
+                                                             memory_order_acq_rel,
+                                                             memory_order_acquire)) {
+                    goto retry;
+                }
+                curr = cskip_ptr(succ);
+                if (!curr) break;
+                succ = atomic_load_explicit(&curr->next[i], memory_order_acquire);
+            }
+            if (!curr || curr->key >= key) break;
+            pred = curr;
+            curr = cskip_ptr(succ);
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return succs[0] && succs[0]->key == key;
+}
+
+/*
+ * Drops one ownership reference; the last owner unlinks and retires the node.
+ * The caller must hold an epoch_reserve() slot for the retire.
+ */
+static inline void cskip_release(CSkipList *sl, EpochThread *th, CSkipNode *n) {
+    if (atomic_fetch_sub_explicit(&n->owners, 1, memory_order_acq_rel) != 1) return;
+    CSkipNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+    cskip_find(sl, n->key, preds, succs);
+    epoch_retire(th, n, epoch_free_malloc, NULL);
+}
+
+static inline int cskip_random_level(void) {
+    static _Thread_local uint64_t state;
+    if (!state) state = (uint64_t)(uintptr_t)&state;
+    return skiplist_level_from(skiplist_mix(state++));
+}
+
+static inline bool cskiplist_insert(CSkipList *sl, EpochThread *th, int key) {
+    CSkipNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+    int level = cskip_random_level();
+    CSkipNode *n = NULL;
+
+    epoch_enter(th);
+    if (!epoch_reserve(th, 1)) {
+        epoch_exit(th);
+        return false;
+    }
+    for (;;) {
+        if (cskip_find(sl, key, preds, succs)) {
+            epoch_exit(th);
+            free(n);
+            return false;
+        }
+        if (!n && !(n = cskip_new_node(key, level))) {
+            epoch_exit(th);
+            return false;
+        }
+        for (int i = 0; i < level; ++i) {
+            atomic_store_explicit(&n->next[i], (uintptr_t)succs[i], memory_order_relaxed);
+        }
+        uintptr_t expected = (uintptr_t)succs[0];
+        if (atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &expected, (uintptr_t)n,
+                                                    memory_order_release, memory_order_relaxed)) {
+            break;
+        }
+    }
+    atomic_fetch_add_explicit(&sl->size, 1, memory_order_relaxed);
+
+    for (int i = 1; i < level; ++i) {
+        for (;;) {
+            uintptr_t cur = atomic_load_explicit(&n->next[i], memory_order_acquire);
+            if (cskip_marked(cur)) goto done;
+            if (cskip_ptr(cur) != succs[i] &&
+                !atomic_compare_exchange_strong_explicit(&n->next[i], &cur, (uintptr_t)succs[i],
+                                                         memory_order_release,
+                                                         memory_order_relaxed)) {
+                goto done;   /* only a remover changes it: the node is going away */
+            }
+            uintptr_t expected = (uintptr_t)succs[i];
+            if (atomic_compare_exchange_strong_explicit(&preds[i]->next[i], &expected, (uintptr_t)n,
+                                                        memory_order_release,
+                                                        memory_order_relaxed)) {
+                break;
+            }
+            cskip_find(sl, key, preds, succs);
+            if (succs[0] != n) goto done;
+        }
+    }
+done:
+    cskip_release(sl, th, n);
+    epoch_exit(th);
+    return true;
+}
+
+static inline bool cskiplist_remove(CSkipList *sl, EpochThread *th, int key) {
+    CSkipNode *preds[SKIPLIST_MAX_LEVEL], *succs[SKIPLIST_MAX_LEVEL];
+    epoch_enter(th);
+    if (!epoch_reserve(th, 1) || !cskip_find(sl, key, preds, succs)) {
+        epoch_exit(th);
+        return false;
+    }
+    CSkipNode *victim = succs[0];
+    for (int i = victim->level - 1; i >= 1; --i) {
+        uintptr_t v = atomic_load_explicit(&victim->next[i], memory_order_acquire);
+        while (!cskip_marked(v) &&
+               !atomic_compare_exchange_weak_explicit(&victim->next[i], &v, v | CSKIP_MARK,
+                                                      memory_order_acq_rel,
+                                                      memory_order_acquire)) {
+        }
+    }
+    uintptr_t v = atomic_load_explicit(&victim->next[0], memory_order_acquire);
+    for (;;) {
+        if (cskip_marked(v)) {
+            epoch_exit(th);
+            return false;   /* another thread removed it first */
+        }
+        if (atomic_compare_exchange_weak_explicit(&victim->next[0], &v, v | CSKIP_MARK,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            break;
+        }
+    }
+    atomic_fetch_sub_explicit(&sl->size, 1, memory_order_relaxed);
+    cskip_find(sl, key, preds, succs);
+    cskip_release(sl, th, victim);
+    epoch_exit(th);
+    return true;
+}
+
+/* Never writes to shared memory and never restarts. */
+static inline bool cskiplist_contains(CSkipList *sl, EpochThread *th, int key) {
+    epoch_enter(th);
+    CSkipNode *pred = sl->head;
+    CSkipNode *curr = NULL;
+    for (int i = SKIPLIST_MAX_LEVEL - 1; i >= 0; --i) {
+        curr = cskip_ptr(atomic_load_explicit(&pred->next[i], memory_order_acquire));
+        while (curr) {
+            uintptr_t succ = atomic_load_explicit(&curr->next[i], memory_order_acquire);
+            while (cskip_marked(succ)) {
+                curr = cskip_ptr(succ);
+                if (!curr) break;
+                succ = atomic_load_explicit(&curr->next[i], memory_order_acquire);
+            }
+            if (!curr || curr->key >= key) break;
+            pred = curr;
+            curr = cskip_ptr(succ);
+        }
+    }
+    bool found = curr && curr->key == key &&
+                 !cskip_marked(atomic_load_explicit(&curr->next[0], memory_order_acquire));
+    epoch_exit(th);
+    return found;
+}
+
+#endif
@@ -22,8 +22,2439 @@
     SOFTWARE.
 */
 
+/* The tests below are plain asserts, so keep them in release builds too. */
+#undef NDEBUG
+#include <assert.h>
+
 #include "ds.h"
+#include "unrolled_list.h"
+#include "intrusive_list.h"
+#include "lf_queue.h"
+#include "ring_buffer.h"
+#include "skip_list.h"
+#include "radix_trie.h"
+#include "art.h"
+#include "frozen_trie.h"
+#include "aho_corasick.h"
+#include "concurrent_trie.h"
+#include "bptree.h"
+#include "typed_tree.h"
+#include "frozen_tree.h"
+#include "persistent_tree.h"
+#include "concurrent_tree.h"
+#include "tree_join.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* xorshift64*, deterministic inputs for the tests. */
+static uint64_t test_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+#define TEST_THREADS 4
+
+static void test_pass(const char *name) { printf("%s: ok\n", name); }
+
+// =======================================
+// Linked lists
+// =======================================
+
+/*
+ * `list` holds exactly want[0..n), with a matching size and tail and, in
+ * doubly mode, prev links that mirror the next links.
+ */
+static void list_check(const LinkedList *list, const int *want, size_t n) {
+    assert(list_size(list) == n);
+    const Node *prev = NULL;
+    size_t i = 0;
+    for (const Node *cur = list->head; cur; prev = cur, cur = cur->next, ++i) {
+        assert(i < n && cur->data == want[i]);
+        if (list->doubly) assert(LIST_PREV(cur) == prev);
+    }
+    assert(i == n && list->tail == prev);
+}
+
+static void test_list_handle(void) {
+    /* The head-pointer API the handle wraps. */
+    Node *head = NULL;
+    insertAtTail(&head, 30);
+    insertAtHead(&head, 20);
+    insertAtHead(&head, 10);
+    insertAtTail(&head, 40);
+    deleteNode(&head, 10);
+    deleteNode(&head, 40);
+    deleteNode(&head, 99);
+    assert(head && head->data == 20 && head->next->data == 30 && !head->next->next);
+    assert(search(head, 30) == head->next && !search(head, 10));
+    freeList(head);
+
+    enum { CAP = 512 };
+    for (int doubly = 0; doubly < 2; ++doubly) {
+        /* The reference deque lives in ref[lo, hi), centred so it can grow either way. */
+        int ref[2 * CAP + 2], lo = CAP, hi = CAP, v = -1;
+        LinkedList list;
+        list_init(&list, doubly);
+        list_check(&list, NULL, 0);
+        assert(!list_pop_front(&list, &v) && !list_pop_back(&list, &v) && v == -1);
+        uint64_t seed = 4;
+        for (int i = 0; i < 4000; ++i) {
+            int size = hi - lo;
+            switch (test_rand(&seed) % 6) {
+            case 0:
+                if (lo == 0) break;
+                assert(list_push_front(&list, i) == list.head);
+                ref[--lo] = i;
+                break;
+            case 1:
+                if (hi == 2 * CAP + 2) break;
+                assert(list_push_back(&list, i) == list.tail);
+                ref[hi++] = i;
+                break;
+            case 2:
+                assert(list_pop_front(&list, &v) == (size > 0));
+                if (size) assert(v == ref[lo++]);
+                break;
+            case 3:
+                assert(list_pop_back(&list, &v) == (size > 0));
+                if (size) assert(v == ref[--hi]);
+                break;
+            default: {
+                /* Remove the head, the tail or a node in between. */
+                if (!size) break;
+                int at = (int)(test_rand(&seed) % 3);
+                at = at == 0 ? 0 : at == 1 ? size - 1 : (int)(test_rand(&seed) % (unsigned)size);
+                Node *prev = NULL, *n = list.head;
+                for (int j = 0; j < at; ++j) {
+                    prev = n;
+                    n = n->next;
+                }
+                assert(list_prev(&list, n) == prev);
+                list_remove_node(&list, n);
+                memmove(&ref[lo + at], &ref[lo + at + 1], (size_t)(size - at - 1) * sizeof(int));
+                hi--;
+                break;
+            }
+            }
+            list_check(&list, ref + lo, (size_t)(hi - lo));
+        }
+        while (lo < hi) {
+            assert(list_pop_back(&list, &v) && v == ref[--hi]);
+            list_check(&list, ref + lo, (size_t)(hi - lo));
+        }
+        assert(!list_pop_front(&list, &v) && !list_pop_back(&list, &v) && !list.head && !list.tail);
+
+        /* Middle inserts keep the links and the tail in step. */
+        int want[] = { 1, 2, 3, 4 };
+        Node *two = list_push_back(&list, 2);
+        list_insert_after(&list, NULL, 1);
+        list_insert_after(&list, list_insert_after(&list, two, 3), 4);
+        list_check(&list, want, 4);
+        assert(list_find(&list, 3) == two->next && list_prev(&list, two) == list.head);
+        list_destroy(&list);
+        list_check(&list, NULL, 0);
+    }
+    test_pass("list_handle");
+}
+
+/* Position of `n` in nodes[0..count), the order the nodes were created in. */
+static size_t list_origin(Node *const *nodes, size_t count, const Node *n) {
+    size_t i = 0;
+    while (i < count && nodes[i] != n) i++;
+    assert(i < count);
+    return i;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void test_list_bulk(void) {
+    enum { N = 300, BIG = 1000 };
+    static int ref[BIG], values[BIG];
+    static Node *nodes[2 * N];
+    uint64_t seed = 5;
+    for (int doubly = 0; doubly < 2; ++doubly) {
+        /* Sort is stable: equal values keep their creation order. */
+        LinkedList a, b, c;
+        list_init(&a, doubly);
+        for (int i = 0; i < N; ++i) {
+            ref[i] = (int)(test_rand(&seed) % 16);
+            nodes[i] = list_push_back(&a, ref[i]);
+        }
+        list_sort(&a);
+        qsort(ref, N, sizeof(int), cmp_int);
+        list_check(&a, ref, N);
+        for (Node *n = a.head; n->next; n = n->next) {
+            if (n->data == n->next->data) assert(list_origin(nodes, N, n) < list_origin(nodes, N, n->next));
+        }
+
+        /* Merge is stable too, taking dst's nodes first on ties. */
+        list_init(&b, doubly);
+        for (int i = 0; i < N; ++i) {
+            ref[N + i] = (int)(test_rand(&seed) % 16);
+            nodes[N + i] = list_push_back(&b, ref[N + i]);
+        }
+        list_sort(&b);
+        list_init(&c, !doubly);
+        assert(!list_merge(&a, &c) && list_size(&a) == N);
+        assert(list_merge(&a, &b));
+        list_check(&b, NULL, 0);
+        qsort(ref, 2 * N, sizeof(int), cmp_int);
+        list_check(&a, ref, 2 * N);
+        for (Node *n = a.head; n->next; n = n->next) {
+            if (n->data != n->next->data) continue;
+            size_t x = list_origin(nodes, 2 * N, n), y = list_origin(nodes, 2 * N, n->next);
+            assert((x < N) == (y < N) ? x < y : x < N);
+        }
+
+        /* Split at 0, at the end, past the end and in the middle. */
+        assert(list_split(&a, 0, &b));
+        list_check(&a, NULL, 0);
+        list_check(&b, ref, 2 * N);
+        assert(list_split(&b, 2 * N, &a));
+        list_check(&a, NULL, 0);
+        list_check(&b, ref, 2 * N);
+        assert(!list_split(&b, 2 * N + 1, &a));
+        assert(list_split(&b, N / 3, &a));
+        list_check(&b, ref, N / 3);
+        list_check(&a, ref + N / 3, 2 * N - N / 3);
+
+        list_destroy(&b);
+        list_destroy(&a);
+
+        /* Splice at the front, in the middle and after the tail, and into an empty list. */
+        static const int d0[] = { 1, 2, 3 }, s0[] = { 7, 8 }, s1[] = { 9 }, s2[] = { 5, 6 };
+        static const int spliced[] = { 7, 8, 1, 5, 6, 2, 3, 9 };
+        assert(list_from_array(&a, d0, 3, doubly));
+        list_init(&c, doubly);
+        assert(list_splice(&a, NULL, &c) && list_splice(&a, a.head, &c) && list_splice(&a, a.tail, &c));
+        list_check(&a, d0, 3);
+        Node *one = a.head;
+        assert(list_from_array(&b, s0, 2, doubly) && list_splice(&a, NULL, &b));
+        list_check(&b, NULL, 0);
+        assert(list_from_array(&b, s1, 1, doubly) && list_splice(&a, a.tail, &b));
+        assert(list_from_array(&b, s2, 2, doubly) && list_splice(&a, one, &b));
+        list_check(&a, spliced, 8);
+        list_init(&c, !doubly);
+        assert(list_push_back(&c, 4) && !list_splice(&a, NULL, &c) && list_size(&c) == 1);
+        list_destroy(&c);
+        list_init(&c, doubly);
+        assert(list_splice(&c, NULL, &a));
+        list_check(&c, spliced, 8);
+        list_check(&a, NULL, 0);
+
+        /* Reverse: empty, one node, many. */
+        static const int reversed[] = { 9, 3, 2, 6, 5, 1, 8, 7 };
+        list_reverse(&a);
+        list_check(&a, NULL, 0);
+        list_reverse(&c);
+        list_check(&c, reversed, 8);
+        assert(list_split(&c, 1, &a));
+        list_reverse(&c);
+        list_check(&c, reversed, 1);
+        list_destroy(&c);
+        list_destroy(&a);
+
+        /*
+         * list_from_array across several chunks. Nodes are then freed one
+         * at a time in random order, mixed with malloc'd nodes, so every
+         * chunk dies with whichever of its nodes goes last.
+         */
+        for (int i = 0; i < BIG; ++i) values[i] = 3 * i;
+        assert(list_from_array(&a, values, 0, doubly) && !a.head);
+        assert(list_from_array(&a, values, BIG, doubly));
+        assert(LIST_CHUNK_OF(a.head) != LIST_CHUNK_OF(a.tail));
+        list_check(&a, values, BIG);
+        memcpy(ref, values, sizeof(values));
+        int size = BIG;
+        for (int i = 0; i < BIG / 2; ++i) {
+            int at = (int)(test_rand(&seed) % (unsigned)size);
+            Node *n = a.head;
+            for (int j = 0; j < at; ++j) n = n->next;
+            list_remove_node(&a, n);
+            memmove(&ref[at], &ref[at + 1], (size_t)(size - at - 1) * sizeof(int));
+            size--;
+            if (i % 2) {
+                ref[size++] = -i;
+                assert(list_push_back(&a, -i));
+            }
+            if (i % 50 == 0) list_check(&a, ref, (size_t)size);
+        }
+        list_check(&a, ref, (size_t)size);
+        list_sort(&a);
+        list_destroy(&a);
+
+        /* freeNode directly on a detached chain, last node first. */
+        assert(list_from_array(&a, values, BIG, doubly));
+        Node *detached = a.head;
+        list_init(&a, doubly);
+        while (detached && detached->next) {
+            Node *prev = detached;
+            while (prev->next->next) prev = prev->next;
+            freeNode(prev->next);
+            prev->next = NULL;
+        }
+        freeNode(detached);
+    }
+    test_pass("list_bulk");
+}
+
+/*
+ * `l` holds exactly want[0..n). Blocks are non-empty and within capacity,
+ * and every block but the tail is at least half full.
+ */
+static void unrolled_check(const UnrolledList *l, const int *want, size_t n) {
+    assert(unrolled_list_size(l) == n);
+    size_t i = 0;
+    const UnrolledNode *last = NULL;
+    for (const UnrolledNode *b = l->head; b; last = b, b = b->next) {
+        assert(b->count > 0 && b->count <= (int)UNROLLED_CAPACITY);
+        if (b->next) assert(b->count >= (int)UNROLLED_CAPACITY / 2);
+        for (int j = 0; j < b->count; ++j, ++i) assert(i < n && b->data[j] == want[i]);
+    }
+    assert(i == n && l->tail == last);
+}
+
+static void test_unrolled_list(void) {
+    enum { N = 2000 };
+    static int ref[N];
+    UnrolledList l;
+    unrolled_list_init(&l);
+    unrolled_check(&l, NULL, 0);
+    int v = -1;
+    size_t pos;
+    assert(!unrolled_list_get(&l, 0, &v) && !unrolled_list_set(&l, 0, 1) && v == -1);
+    assert(!unrolled_list_remove_at(&l, 0, &v) && !unrolled_list_remove(&l, 1));
+    assert(!unrolled_list_find(&l, 0, &pos) && !unrolled_list_insert(&l, 1, 0));
+
+    /* Inserts at random positions split full blocks; values are unique. */
+    uint64_t seed = 28;
+    size_t size = 0;
+    for (int i = 0; i < N; ++i) {
+        size_t at = (size_t)(test_rand(&seed) % (size + 1));
+        if (i % 10 == 0) at = i % 20 ? size : 0;
+        assert(unrolled_list_insert(&l, at, i));
+        memmove(&ref[at + 1], &ref[at], (size - at) * sizeof(int));
+        ref[at] = i;
+        size++;
+        if (i % 97 == 0) unrolled_check(&l, ref, size);
+    }
+    unrolled_check(&l, ref, size);
+    assert(!unrolled_list_insert(&l, size + 1, 0));
+
+    /* Index get/set, including the first and last slot of every block. */
+    size_t start = 0;
+    for (const UnrolledNode *b = l.head; b; b = b->next) {
+        size_t idx[2] = { start, start + (size_t)b->count - 1 };
+        for (int j = 0; j < 2; ++j) {
+            assert(unrolled_list_get(&l, idx[j], &v) && v == ref[idx[j]]);
+            ref[idx[j]] += N;
+            assert(unrolled_list_set(&l, idx[j], ref[idx[j]]));
+        }
+        start += (size_t)b->count;
+    }
+    for (size_t i = 0; i < size; ++i) assert(unrolled_list_get(&l, i, &v) && v == ref[i]);
+    assert(!unrolled_list_get(&l, size, &v) && !unrolled_list_set(&l, size, 0));
+    unrolled_check(&l, ref, size);
+
+    /* Find and remove by value, or by position; underfull blocks borrow or merge. */
+    while (size) {
+        size_t at = (size_t)(test_rand(&seed) % size);
+        if (size % 2) {
+            assert(unrolled_list_find(&l, ref[at], &pos) && pos == at);
+            assert(unrolled_list_remove(&l, ref[at]));
+        } else {
+            assert(unrolled_list_remove_at(&l, at, &v) && v == ref[at]);
+        }
+        int gone = ref[at];
+        memmove(&ref[at], &ref[at + 1], (size - at - 1) * sizeof(int));
+        size--;
+        assert(!unrolled_list_find(&l, gone, &pos));
+        if (size % 53 == 0) unrolled_check(&l, ref, size);
+    }
+    assert(!l.head && !l.tail);
+
+    /*
+     * Full blocks: a match in the vector lanes, in the scalar tail after
+     * them, in the very last slot, a repeated value, and a miss.
+     */
+    const int cap = (int)UNROLLED_CAPACITY;
+    for (int i = 0; i < 3 * cap; ++i) assert(unrolled_list_push_back(&l, i));
+    for (int i = 0; i < 3 * cap; ++i) assert(unrolled_list_find(&l, i, &pos) && pos == (size_t)i);
+    assert(unrolled_list_find(&l, cap - 1, &pos) && pos == (size_t)cap - 1);
+    assert(unrolled_list_find(&l, 3 * cap - 1, &pos) && pos == (size_t)(3 * cap - 1));
+    assert(!unrolled_list_find(&l, 3 * cap, &pos) && !unrolled_list_find(&l, -1, NULL));
+    assert(unrolled_list_set(&l, 2 * cap - 1, 5) && unrolled_list_find(&l, 5, &pos) && pos == 5);
+    assert(unrolled_list_remove(&l, 5) && unrolled_list_find(&l, 5, &pos) && pos == (size_t)(2 * cap - 2));
+    unrolled_list_destroy(&l);
+    unrolled_check(&l, NULL, 0);
+    test_pass("unrolled_list");
+}
+
+typedef struct {
+    int id;
+    IListNode link;
+    SListNode slink;
+} IJob;
+
+/* `head` holds jobs with ids want[0..n) in order, linked consistently both ways. */
+static void ilist_check(const IListNode *head, const int *want, int n) {
+    int i = 0;
+    const IListNode *prev = head;
+    for (const IListNode *p = head->next; p != head; prev = p, p = p->next, ++i) {
+        assert(i < n && p->prev == prev && ilist_entry(p, IJob, link)->id == want[i]);
+    }
+    assert(i == n && head->prev == prev && ilist_empty(head) == (n == 0));
+    assert(ilist_is_singular(head) == (n == 1));
+}
+
+static void slist_check(const SListNode *head, const int *want, int n) {
+    int i = 0;
+    slist_for_each_entry(j, head, IJob, slink) assert(i < n && j->id == want[i++]);
+    assert(i == n && slist_empty(head) == (n == 0));
+}
+
+static void test_intrusive_list(void) {
+    static IJob jobs[12];
+    for (int i = 0; i < 12; ++i) jobs[i].id = i;
+    ILIST_HEAD(a);
+    IListNode b, out;
+    ilist_init(&b);
+    ilist_check(&a, NULL, 0);
+
+    /* add puts entries at the front, add_tail at the back. */
+    for (int i = 2; i < 6; ++i) ilist_add_tail(&jobs[i].link, &a);
+    ilist_add(&jobs[1].link, &a);
+    ilist_add(&jobs[0].link, &a);
+    static const int w0[] = { 0, 1, 2, 3, 4, 5 };
+    ilist_check(&a, w0, 6);
+    assert(ilist_first_entry(&a, IJob, link) == &jobs[0] && ilist_last_entry(&a, IJob, link) == &jobs[5]);
+
+    /* del at the front, the back and in the middle; del_init leaves a usable empty list. */
+    ilist_del(&jobs[0].link);
+    ilist_del(&jobs[5].link);
+    ilist_del_init(&jobs[3].link);
+    assert(!jobs[0].link.next && !jobs[5].link.prev && ilist_empty(&jobs[3].link));
+    static const int w1[] = { 1, 2, 4 };
+    ilist_check(&a, w1, 3);
+    ilist_move(&jobs[4].link, &a);
+    ilist_move_tail(&jobs[1].link, &a);
+    static const int w2[] = { 4, 2, 1 };
+    ilist_check(&a, w2, 3);
+
+    /* splice to the front and splice_tail to the back; empty sources are no-ops. */
+    ilist_splice(&b, &a);
+    ilist_splice_tail(&b, &a);
+    ilist_check(&a, w2, 3);
+    ilist_add_tail(&jobs[6].link, &b);
+    ilist_add_tail(&jobs[7].link, &b);
+    ilist_splice(&b, &a);
+    ilist_check(&b, NULL, 0);
+    ilist_add_tail(&jobs[8].link, &b);
+    ilist_splice_tail(&b, &a);
+    ilist_check(&b, NULL, 0);
+    static const int w3[] = { 6, 7, 4, 2, 1, 8 };
+    ilist_check(&a, w3, 6);
+
+    /* cut_position at the head (nothing), in the middle, and at the last entry (everything). */
+    ilist_cut_position(&out, &a, &a);
+    ilist_check(&out, NULL, 0);
+    ilist_check(&a, w3, 6);
+    ilist_cut_position(&out, &a, &jobs[4].link);
+    ilist_check(&out, w3, 3);
+    ilist_check(&a, w3 + 3, 3);
+    ilist_cut_position(&b, &a, &jobs[8].link);
+    ilist_check(&b, w3 + 3, 3);
+    ilist_check(&a, NULL, 0);
+    IListNode none;
+    ilist_cut_position(&none, &a, a.next);
+    ilist_check(&none, NULL, 0);
+    ilist_splice(&out, &a);
+    ilist_splice_tail(&b, &a);
+    ilist_check(&a, w3, 6);
+
+    /* Deleting the current entry inside the safe iterators. */
+    ilist_for_each_safe(p, &a) {
+        int id = ilist_entry(p, IJob, link)->id;
+        if (id == 6 || id == 2 || id == 8) ilist_del(p);
+    }
+    static const int w4[] = { 7, 4, 1 };
+    ilist_check(&a, w4, 3);
+    int seen = 0;
+    ilist_for_each_entry_safe(j, &a, IJob, link) {
+        seen += j->id;
+        ilist_del(&j->link);
+    }
+    assert(seen == 12);
+    ilist_check(&a, NULL, 0);
+
+    /* Singly-linked variant. */
+    SLIST_HEAD(s);
+    SListNode t;
+    slist_init(&t);
+    slist_check(&s, NULL, 0);
+    assert(!slist_pop(&s) && !slist_del(&s, &jobs[0].slink));
+    for (int i = 5; i >= 0; --i) slist_add(&jobs[i].slink, &s);
+    slist_add(&jobs[9].slink, &jobs[2].slink);
+    static const int s0[] = { 0, 1, 2, 9, 3, 4, 5 };
+    slist_check(&s, s0, 7);
+    assert(slist_pop(&s) == &jobs[0].slink && !jobs[0].slink.next);
+    assert(slist_del(&s, &jobs[9].slink) && !slist_del(&s, &jobs[9].slink));
+    assert(slist_del(&s, &jobs[5].slink));
+    static const int s1[] = { 1, 2, 3, 4 };
+    slist_check(&s, s1, 4);
+    slist_splice(&t, &s);
+    slist_check(&s, s1, 4);
+    slist_add(&jobs[11].slink, &t);
+    slist_add(&jobs[10].slink, &t);
+    slist_splice(&t, &s);
+    slist_check(&t, NULL, 0);
+    static const int s2[] = { 10, 11, 1, 2, 3, 4 };
+    slist_check(&s, s2, 6);
+    slist_for_each_safe(p, &s) {
+        if (slist_entry(p, IJob, slink)->id % 2 == 0) slist_del_after(p_prev);
+    }
+    static const int s3[] = { 11, 1, 3 };
+    slist_check(&s, s3, 3);
+    int count = 0;
+    slist_for_each(p, &s) count++;
+    assert(count == 3);
+    test_pass("intrusive_list");
+}
+
+// =======================================
+// Lock-free queues
+// =======================================
+
+#define QUEUE_PER_PRODUCER 20000
+
+typedef struct {
+    LFQueue *q;
+    MPSCQueue *mq;
+    int id;
+    int *seen;                  /* consumers: per-value hit counts */
+    _Atomic int *consumed;
+} QueueArgs;
+
+static void *queue_producer(void *arg) {
+    QueueArgs *a = (QueueArgs *)arg;
+    EpochThread *th = a->q ? lfq_register(a->q) : mpscq_register(a->mq);
+    for (int i = 0; i < QUEUE_PER_PRODUCER; ++i) {
+        int v = a->id * QUEUE_PER_PRODUCER + i;
+        while (!(a->q ? lfq_enqueue(a->q, th, v) : mpscq_enqueue(a->mq, th, v))) {
+        }
+    }
+    epoch_unregister(th);
+    return NULL;
+}
+
+static void *queue_consumer(void *arg) {
+    QueueArgs *a = (QueueArgs *)arg;
+    EpochThread *th = lfq_register(a->q);
+    int total = TEST_THREADS * QUEUE_PER_PRODUCER, last[TEST_THREADS], v;
+    for (int i = 0; i < TEST_THREADS; ++i) last[i] = -1;
+    while (atomic_load(a->consumed) < total) {
+        if (!lfq_dequeue(a->q, th, &v)) continue;
+        atomic_fetch_add(a->consumed, 1);
+        a->seen[v]++;
+        /* One consumer sees each producer's values in enqueue order. */
+        assert(v % QUEUE_PER_PRODUCER > last[v / QUEUE_PER_PRODUCER]);
+        last[v / QUEUE_PER_PRODUCER] = v % QUEUE_PER_PRODUCER;
+    }
+    lfq_unregister(th);
+    return NULL;
+}
+
+static void test_lf_queue(void) {
+    /* Single thread against a plain FIFO. */
+    LFQueue q;
+    MPSCQueue mq;
+    assert(lfq_init(&q) && mpscq_init(&mq));
+    EpochThread *th = lfq_register(&q), *mth = mpscq_register(&mq);
+    int ref[1000], head = 0, tail = 0, v;
+    uint64_t seed = 1;
+    for (int i = 0; i < 5000; ++i) {
+        if (test_rand(&seed) % 3 && tail < 1000) {
+            ref[tail++] = i;
+            assert(lfq_enqueue(&q, th, i) && mpscq_enqueue(&mq, mth, i));
+        } else if (head < tail) {
+            assert(lfq_dequeue(&q, th, &v) && v == ref[head]);
+            assert(mpscq_dequeue(&mq, mth, &v) && v == ref[head]);
+            head++;
+        } else {
+            assert(!lfq_dequeue(&q, th, &v) && !mpscq_dequeue(&mq, mth, &v));
+        }
+    }
+    lfq_unregister(th);
+    mpscq_unregister(mth);
+    lfq_destroy(&q);
+    mpscq_destroy(&mq);
+
+    /* Several producers and consumers: every value arrives exactly once. */
+    enum { TOTAL = TEST_THREADS * QUEUE_PER_PRODUCER };
+    static int seen[2][TOTAL];
+    _Atomic int consumed = 0;
+    pthread_t tid[2 * TEST_THREADS];
+    QueueArgs args[2 * TEST_THREADS];
+    assert(lfq_init(&q));
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (QueueArgs){ &q, NULL, i, NULL, &consumed };
+        args[TEST_THREADS + i] = (QueueArgs){ &q, NULL, i, seen[i & 1], &consumed };
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        pthread_create(&tid[i], NULL, queue_producer, &args[i]);
+    }
+    for (int i = 0; i < 2; ++i) {
+        pthread_create(&tid[TEST_THREADS + i], NULL, queue_consumer, &args[TEST_THREADS + i]);
+    }
+    for (int i = 0; i < TEST_THREADS + 2; ++i) pthread_join(tid[i], NULL);
+    for (int i = 0; i < TOTAL; ++i) assert(seen[0][i] + seen[1][i] == 1);
+    th = lfq_register(&q);
+    assert(!lfq_dequeue(&q, th, &v));
+    lfq_unregister(th);
+    lfq_destroy(&q);
+
+    /* MPSC: the single consumer sees each producer's values in order. */
+    assert(mpscq_init(&mq));
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (QueueArgs){ NULL, &mq, i, NULL, NULL };
+        pthread_create(&tid[i], NULL, queue_producer, &args[i]);
+    }
+    mth = mpscq_register(&mq);
+    int last[TEST_THREADS] = { -1, -1, -1, -1 }, got = 0;
+    while (got < TOTAL) {
+        if (!mpscq_dequeue(&mq, mth, &v)) continue;
+        assert(v % QUEUE_PER_PRODUCER == last[v / QUEUE_PER_PRODUCER] + 1);
+        last[v / QUEUE_PER_PRODUCER]++;
+        got++;
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) pthread_join(tid[i], NULL);
+    assert(!mpscq_dequeue(&mq, mth, &v));
+    mpscq_unregister(mth);
+    mpscq_destroy(&mq);
+    test_pass("lf_queue");
+}
+
+#define RING_VALUES 100000
+
+typedef struct {
+    SPSCRing *sr;
+    MPMCRing *mr;
+    int id;
+    int *seen;                  /* consumers: per-value hit counts */
+    _Atomic int *consumed;
+} RingArgs;
+
+/* Pushes batches of 1..7 values, waiting while the ring is full. */
+static void *ring_producer(void *arg) {
+    RingArgs *a = (RingArgs *)arg;
+    int base = a->id * RING_VALUES, batch[7];
+    for (int i = 0; i < RING_VALUES;) {
+        int n = 1 + i % 7;
+        if (n > RING_VALUES - i) n = RING_VALUES - i;
+        for (int j = 0; j < n; ++j) batch[j] = base + i + j;
+        size_t pushed = a->sr ? spsc_ring_push_n(a->sr, batch, (size_t)n)
+                              : mpmc_ring_push_n(a->mr, batch, (size_t)n);
+        if (!pushed) sched_yield();
+        i += (int)pushed;   /* a partial push leaves the rest for the next round */
+    }
+    return NULL;
+}
+
+static void *ring_consumer(void *arg) {
+    RingArgs *a = (RingArgs *)arg;
+    int total = TEST_THREADS * RING_VALUES, out[5];
+    while (atomic_load(a->consumed) < total) {
+        size_t n = mpmc_ring_pop_n(a->mr, out, 5);
+        if (!n) { sched_yield(); continue; }
+        atomic_fetch_add(a->consumed, (int)n);
+        for (size_t i = 0; i < n; ++i) a->seen[out[i]]++;
+    }
+    return NULL;
+}
+
+static void test_ring_buffer(void) {
+    /* Capacity rounding, and sizes that cannot be rounded. */
+    assert(ring_round_pow2(0) == 2 && ring_round_pow2(2) == 2 && ring_round_pow2(5) == 8);
+    assert(ring_round_pow2(SIZE_MAX / 2 + 1) == SIZE_MAX / 2 + 1);
+    assert(ring_round_pow2(SIZE_MAX / 2 + 2) == 0 && ring_round_pow2(SIZE_MAX) == 0);
+    SPSCRing sr;
+    MPMCRing mr;
+    assert(!spsc_ring_init(&sr, SIZE_MAX) && !mpmc_ring_init(&mr, SIZE_MAX));
+    assert(spsc_ring_init(&sr, 9) && mpmc_ring_init(&mr, 9));
+    assert(spsc_ring_capacity(&sr) == 16 && mpmc_ring_capacity(&mr) == 16);
+    spsc_ring_destroy(&sr);
+    mpmc_ring_destroy(&mr);
+
+    /* Single thread against a plain FIFO; 8 slots, so indices wrap often. */
+    assert(spsc_ring_init(&sr, 8) && mpmc_ring_init(&mr, 8));
+    static int ref[8 * 5000];
+    int head = 0, tail = 0, v, in[8], out[8], out2[8];
+    uint64_t seed = 3;
+    for (int i = 0; i < 5000; ++i) {
+        size_t k = (size_t)(test_rand(&seed) % 9), size = (size_t)(tail - head);
+        switch (test_rand(&seed) % 4) {
+        case 0:
+            assert(spsc_ring_push(&sr, i) == (size < 8) && mpmc_ring_push(&mr, i) == (size < 8));
+            if (size < 8) ref[tail++] = i;
+            break;
+        case 1:
+            assert(spsc_ring_pop(&sr, &v) == (size > 0));
+            if (size) assert(v == ref[head]);
+            assert(mpmc_ring_pop(&mr, &v) == (size > 0));
+            if (size) assert(v == ref[head++]);
+            break;
+        case 2: {
+            /* Only as many as fit go in. */
+            size_t fit = k < 8 - size ? k : 8 - size;
+            for (size_t j = 0; j < k; ++j) in[j] = i * 8 + (int)j;
+            assert(spsc_ring_push_n(&sr, in, k) == fit && mpmc_ring_push_n(&mr, in, k) == fit);
+            for (size_t j = 0; j < fit; ++j) ref[tail++] = in[j];
+            break;
+        }
+        default: {
+            size_t got = k < size ? k : size;
+            assert(spsc_ring_pop_n(&sr, out, k) == got && mpmc_ring_pop_n(&mr, out2, k) == got);
+            for (size_t j = 0; j < got; ++j, ++head) assert(out[j] == ref[head] && out2[j] == ref[head]);
+            break;
+        }
+        }
+        assert(spsc_ring_size(&sr) == (size_t)(tail - head));
+    }
+    /* Full and empty edges. */
+    while (head < tail) assert(spsc_ring_pop(&sr, &v) && mpmc_ring_pop(&mr, &v) && v == ref[head++]);
+    assert(!spsc_ring_pop(&sr, &v) && !mpmc_ring_pop(&mr, &v));
+    assert(spsc_ring_pop_n(&sr, out, 8) == 0 && mpmc_ring_pop_n(&mr, out, 8) == 0);
+    for (int j = 0; j < 8; ++j) assert(spsc_ring_push(&sr, j) && mpmc_ring_push(&mr, j));
+    assert(!spsc_ring_push(&sr, 8) && !mpmc_ring_push(&mr, 8));
+    assert(spsc_ring_push_n(&sr, in, 3) == 0 && mpmc_ring_push_n(&mr, in, 3) == 0);
+    for (int j = 0; j < 8; ++j) assert(spsc_ring_pop(&sr, &v) && v == j && mpmc_ring_pop(&mr, &v) && v == j);
+    spsc_ring_destroy(&sr);
+    mpmc_ring_destroy(&mr);
+
+    /* SPSC across threads: the consumer sees 0, 1, 2, ... in order. */
+    RingArgs args[2 * TEST_THREADS];
+    pthread_t tid[2 * TEST_THREADS];
+    assert(spsc_ring_init(&sr, 64));
+    args[0] = (RingArgs){ &sr, NULL, 0, NULL, NULL };
+    pthread_create(&tid[0], NULL, ring_producer, &args[0]);
+    for (int next = 0; next < RING_VALUES;) {
+        size_t n = spsc_ring_pop_n(&sr, out, 1 + (size_t)next % 8);
+        if (!n) sched_yield();
+        for (size_t j = 0; j < n; ++j) assert(out[j] == next++);
+    }
+    pthread_join(tid[0], NULL);
+    assert(!spsc_ring_pop(&sr, &v) && spsc_ring_size(&sr) == 0);
+    spsc_ring_destroy(&sr);
+
+    /* MPMC: every value from every producer is popped exactly once. */
+    enum { TOTAL = TEST_THREADS * RING_VALUES };
+    static int seen[2][TOTAL];
+    _Atomic int consumed = 0;
+    assert(mpmc_ring_init(&mr, 64));
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (RingArgs){ NULL, &mr, i, NULL, NULL };
+        args[TEST_THREADS + i] = (RingArgs){ NULL, &mr, i, seen[i & 1], &consumed };
+        pthread_create(&tid[i], NULL, ring_producer, &args[i]);
+    }
+    for (int i = 0; i < 2; ++i) {
+        pthread_create(&tid[TEST_THREADS + i], NULL, ring_consumer, &args[TEST_THREADS + i]);
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) pthread_join(tid[i], NULL);
+    for (int i = 0; i < 2; ++i) pthread_join(tid[TEST_THREADS + i], NULL);
+    for (int i = 0; i < TOTAL; ++i) assert(seen[0][i] + seen[1][i] == 1);
+    assert(!mpmc_ring_pop(&mr, &v));
+    mpmc_ring_destroy(&mr);
+    test_pass("ring_buffer");
+}
+
+// =======================================
+// Skip lists
+// =======================================
+
+#define SET_KEYS 2048
+#define SET_OPS 20000
+
+static void count_int(int key, void *user) {
+    int *last = (int *)user;
+    assert(key > last[0]);
+    last[0] = key;
+    last[1]++;
+}
+
+/*
+ * Concurrent set stress: thread `id` owns the keys with key % TEST_THREADS
+ * == id, so it can check its own results exactly, and only reads the rest.
+ */
+typedef struct {
+    CSkipList *sl;
+    int id;
+    char *present;
+} CSkipArgs;
+
+static void *cskip_worker(void *arg) {
+    CSkipArgs *a = (CSkipArgs *)arg;
+    EpochThread *th = cskiplist_register(a->sl);
+    uint64_t seed = 100 + (uint64_t)a->id;
+    for (int i = 0; i < SET_OPS; ++i) {
+        uint64_t r = test_rand(&seed);
+        int key = (int)(r % SET_KEYS);
+        if (key % TEST_THREADS != a->id) {
+            cskiplist_contains(a->sl, th, key);
+        } else if (r & (1u << 20)) {
+            assert(cskiplist_insert(a->sl, th, key) == !a->present[key]);
+            a->present[key] = 1;
+        } else {
+            assert(cskiplist_remove(a->sl, th, key) == a->present[key]);
+            a->present[key] = 0;
+        }
+        if (key % TEST_THREADS == a->id) assert(cskiplist_contains(a->sl, th, key) == a->present[key]);
+    }
+    cskiplist_unregister(th);
+    return NULL;
+}
+
+static void test_skip_list(void) {
+    static char ref[SET_KEYS];
+    memset(ref, 0, sizeof(ref));
+    SkipList *sl = skiplist_create();
+    CSkipList *csl = cskiplist_create();
+    EpochThread *th = cskiplist_register(csl);
+    size_t size = 0;
+    uint64_t seed = 2;
+    for (int i = 0; i < SET_OPS; ++i) {
+        int key = (int)(test_rand(&seed) % SET_KEYS);
+        if (i % 3) {
+            assert(skiplist_insert(sl, key) == !ref[key]);
+            assert(cskiplist_insert(csl, th, key) == !ref[key]);
+            size += !ref[key];
+            ref[key] = 1;
+        } else {
+            assert(skiplist_remove(sl, key) == ref[key]);
+            assert(cskiplist_remove(csl, th, key) == ref[key]);
+            size -= ref[key];
+            ref[key] = 0;
+        }
+        assert(skiplist_size(sl) == size && cskiplist_size(csl) == size);
+    }
+    size_t in_range = 0;
+    for (int k = 0; k < SET_KEYS; ++k) {
+        assert(skiplist_contains(sl, k) == ref[k]);
+        assert(cskiplist_contains(csl, th, k) == ref[k]);
+        in_range += k >= 100 && k <= 900 && ref[k];
+    }
+    int walk[2] = { -1, 0 };
+    assert(skiplist_range(sl, 100, 900, count_int, walk) == in_range && (size_t)walk[1] == in_range);
+    const SkipNode *n = skiplist_lower_bound(sl, 1000);
+    int expect = 1000;
+    while (expect < SET_KEYS && !ref[expect]) expect++;
+    assert(expect == SET_KEYS ? !n : n && n->key == expect);
+    cskiplist_unregister(th);
+    cskiplist_destroy(csl);
+    skiplist_destroy(sl);
+
+    /* Lock-free variant under concurrent writers. */
+    static char present[SET_KEYS];
+    memset(present, 0, sizeof(present));
+    csl = cskiplist_create();
+    pthread_t tid[TEST_THREADS];
+    CSkipArgs args[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (CSkipArgs){ csl, i, present };
+        pthread_create(&tid[i], NULL, cskip_worker, &args[i]);
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) pthread_join(tid[i], NULL);
+    th = cskiplist_register(csl);
+    size = 0;
+    for (int k = 0; k < SET_KEYS; ++k) {
+        assert(cskiplist_contains(csl, th, k) == present[k]);
+        size += present[k];
+    }
+    assert(cskiplist_size(csl) == size);
+    cskiplist_unregister(th);
+    cskiplist_destroy(csl);
+    test_pass("skip_list");
+}
+
+// =======================================
+// Tries
+// =======================================
+
+#define WORDS 600
+#define WORD_CAP 12
+
+/*
+ * Distinct words of 1..8 letters over a small alphabet, so they share long
+ * prefixes and every split/merge path in the tries gets exercised.
+ */
+static void make_words(char words[][WORD_CAP], int n, const char *alphabet, uint64_t seed) {
+    size_t k = strlen(alphabet);
+    for (int i = 0; i < n; ) {
+        size_t len = 1 + (size_t)(test_rand(&seed) % 8);
+        for (size_t j = 0; j < len; ++j) words[i][j] = alphabet[test_rand(&seed) % k];
+        words[i][len] = '\0';
+        int dup = 0;
+        for (int j = 0; j < i && !dup; ++j) dup = strcmp(words[i], words[j]) == 0;
+        if (!dup) i++;
+    }
+}
+
+/* Reference for starts_with: any present word with this prefix. */
+static bool ref_has_prefix(char words[][WORD_CAP], const char *present, int n, const char *prefix) {
+    for (int i = 0; i < n; ++i) {
+        if (present[i] && strncmp(words[i], prefix, strlen(prefix)) == 0) return true;
+    }
+    return false;
+}
+
+/* Every non-root node is terminal or branches, and child keys are distinct. */
+static void radix_check(const RadixNode *n, bool root) {
+    if (!root) assert(n->len > 0 && (n->terminal || n->nchild >= 2));
+    const char *keys = radix_child_keys(n);
+    for (int i = 0; i < n->nchild; ++i) {
+        assert(n->child[i]->label[0] == keys[i]);
+        for (int j = 0; j < i; ++j) assert(keys[i] != keys[j]);
+        radix_check(n->child[i], false);
+    }
+}
+
+static void test_radix_trie(void) {
+    static char words[WORDS][WORD_CAP];
+    static char present[WORDS];
+    memset(present, 0, sizeof(present));
+    make_words(words, WORDS, "abc", 3);
+    RadixTrie *t = radix_trie_create(NULL);
+    size_t size = 0;
+    uint64_t seed = 4;
+    for (int i = 0; i < 6000; ++i) {
+        int w = (int)(test_rand(&seed) % WORDS);
+        void *value = (void *)(uintptr_t)(w + 1);
+        if (i % 3) {
+            assert(radix_trie_insert(t, words[w], value) == !present[w]);
+            size += !present[w];
+            present[w] = 1;
+        } else {
+            assert(radix_trie_remove(t, words[w]) == present[w]);
+            size -= present[w];
+            present[w] = 0;
+        }
+        assert(radix_trie_size(t) == size);
+        if (i % 500 == 0) radix_check(t->root, true);
+    }
+    radix_check(t->root, true);
+    for (int w = 0; w < WORDS; ++w) {
+        assert(radix_trie_contains(t, words[w]) == present[w]);
+        assert(radix_trie_get(t, words[w]) == (present[w] ? (void *)(uintptr_t)(w + 1) : NULL));
+        char prefix[WORD_CAP];
+        size_t len = strlen(words[w]);
+        memcpy(prefix, words[w], (len + 1) / 2);
+        prefix[(len + 1) / 2] = '\0';
+        assert(radix_trie_starts_with(t, prefix) == ref_has_prefix(words, present, WORDS, prefix));
+    }
+    /* Removing everything merges the trie back down to a bare root. */
+    for (int w = 0; w < WORDS; ++w) {
+        if (present[w]) assert(radix_trie_remove(t, words[w]));
+    }
+    assert(radix_trie_size(t) == 0 && t->root->nchild == 0);
+    /* Case folding and skipped characters, as in Trie. */
+    assert(radix_trie_insert(t, "Hello-World", NULL));
+    assert(radix_trie_contains(t, "helloworld") && !radix_trie_insert(t, "HELLO world", NULL));
+    radix_trie_destroy(t);
+    test_pass("radix_trie");
+}
+
+// =======================================
+// Adaptive radix tree
+// =======================================
+
+#define ART_KEYS 3000
+#define ART_KEY_CAP 8
+
+typedef struct ArtWalk {
+    unsigned char last[ART_KEY_CAP * 1024];
+    size_t last_len, count;
+    bool started;
+} ArtWalk;
+
+/* Byte order with a proper prefix first, as art_foreach promises. */
+static int art_key_cmp(const unsigned char *a, size_t alen, const unsigned char *b, size_t blen) {
+    int c = memcmp(a, b, alen < blen ? alen : blen);
+    return c ? c : (alen > blen) - (alen < blen);
+}
+
+static bool art_walk(const unsigned char *key, size_t len, void *value, void *user) {
+    ArtWalk *w = (ArtWalk *)user;
+    (void)value;
+    assert(len <= sizeof(w->last));
+    if (w->started) assert(art_key_cmp(w->last, w->last_len, key, len) < 0);
+    memcpy(w->last, key, len);
+    w->last_len = len;
+    w->started = true;
+    w->count++;
+    return true;
+}
+
+static uint8_t art_root_type(const ArtTree *t) {
+    assert(t->root && !ART_IS_LEAF(t->root));
+    return ((const ArtNode *)t->root)->type;
+}
+
+static void test_art(void) {
+    ArtTree *t = art_create(NULL);
+    /* One-byte keys branch at the root: grow through every node size... */
+    unsigned char k[1];
+    for (int c = 0; c < 256; ++c) {
+        k[0] = (unsigned char)c;
+        assert(art_insert(t, k, 1, (void *)(uintptr_t)(c + 1)));
+        if (c == 0) assert(ART_IS_LEAF(t->root));
+        if (c == 3) assert(art_root_type(t) == ART_NODE4);
+        if (c == 4) assert(art_root_type(t) == ART_NODE16);
+        if (c == 16) assert(art_root_type(t) == ART_NODE48);
+        if (c == 48) assert(art_root_type(t) == ART_NODE256);
+    }
+    for (int c = 0; c < 256; ++c) {
+        k[0] = (unsigned char)c;
+        assert(art_get(t, k, 1) == (void *)(uintptr_t)(c + 1));
+    }
+    ArtWalk walk = {0};
+    art_foreach(t, art_walk, &walk);
+    assert(walk.count == 256);
+    /* ...and shrink back down to a single leaf. */
+    for (int c = 255; c > 0; --c) {
+        k[0] = (unsigned char)c;
+        assert(art_remove(t, k, 1) && !art_contains(t, k, 1));
+        if (c == 37) assert(art_root_type(t) == ART_NODE48);
+        if (c == 12) assert(art_root_type(t) == ART_NODE16);
+        if (c == 3) assert(art_root_type(t) == ART_NODE4);
+    }
+    assert(art_size(t) == 1 && ART_IS_LEAF(t->root));
+    k[0] = 0;
+    assert(art_remove(t, k, 1) && t->root == NULL && art_size(t) == 0);
+
+    /* Random binary keys with NULs and 0xff, many of them prefixes of others. */
+    static unsigned char keys[ART_KEYS][ART_KEY_CAP];
+    static size_t lens[ART_KEYS];
+    static char present[ART_KEYS];
+    static const unsigned char bytes[] = { 0, 1, 'a', 'b', 0xff };
+    uint64_t seed = 5;
+    for (int i = 0; i < ART_KEYS; ) {
+        lens[i] = 1 + (size_t)(test_rand(&seed) % ART_KEY_CAP);
+        for (size_t j = 0; j < lens[i]; ++j) keys[i][j] = bytes[test_rand(&seed) % sizeof(bytes)];
+        int dup = 0;
+        for (int j = 0; j < i && !dup; ++j) dup = lens[i] == lens[j] && !memcmp(keys[i], keys[j], lens[i]);
+        if (!dup) i++;
+    }
+    size_t size = 0;
+    for (int i = 0; i < 30000; ++i) {
+        int w = (int)(test_rand(&seed) % ART_KEYS);
+        if (i % 3) {
+            assert(art_insert(t, keys[w], lens[w], (void *)(uintptr_t)(w + 1)) == !present[w]);
+            size += !present[w];
+            present[w] = 1;
+        } else {
+            assert(art_remove(t, keys[w], lens[w]) == present[w]);
+            size -= present[w];
+            present[w] = 0;
+        }
+        assert(art_size(t) == size);
+    }
+    for (int w = 0; w < ART_KEYS; ++w) {
+        assert(art_contains(t, keys[w], lens[w]) == present[w]);
+        assert(art_get(t, keys[w], lens[w]) == (present[w] ? (void *)(uintptr_t)(w + 1) : NULL));
+    }
+    memset(&walk, 0, sizeof(walk));
+    art_foreach(t, art_walk, &walk);
+    assert(walk.count == size);
+    /* Prefix scans see exactly the present keys that start with the prefix. */
+    for (int w = 0; w < ART_KEYS; w += 7) {
+        size_t plen = (lens[w] + 1) / 2, expect = 0;
+        for (int j = 0; j < ART_KEYS; ++j) {
+            expect += present[j] && lens[j] >= plen && !memcmp(keys[j], keys[w], plen);
+        }
+        memset(&walk, 0, sizeof(walk));
+        art_prefix_scan(t, keys[w], plen, art_walk, &walk);
+        assert(walk.count == expect);
+    }
+    art_destroy(t);
+
+    /* A chain of keys that each extend the last is one inner node per byte;
+     * walking and freeing it must not depend on the C stack. */
+    static unsigned char deep[ART_KEY_CAP * 1024];
+    memset(deep, 'a', sizeof(deep));
+    t = art_create(NULL);
+    size_t longest = 0;
+    for (size_t len = 1; len <= sizeof(deep); len += 3) {
+        assert(art_insert(t, deep, len, NULL));
+        longest = len;
+    }
+    memset(&walk, 0, sizeof(walk));
+    art_foreach(t, art_walk, &walk);
+    assert(walk.count == art_size(t) && walk.last_len == longest);
+    art_destroy(t);
+    test_pass("art");
+}
+
+/* Lexicographic rank of words[w] among the present words. */
+static long ref_rank(char words[][WORD_CAP], const char *present, int n, int w) {
+    long rank = 0;
+    for (int i = 0; i < n; ++i) rank += present[i] && strcmp(words[i], words[w]) < 0;
+    return rank;
+}
+
+static void frozen_trie_check(const FrozenTrie *ft, char words[][WORD_CAP], const char *present, int n) {
+    for (int w = 0; w < n; ++w) {
+        assert(frozen_trie_contains(ft, words[w]) == present[w]);
+        assert(frozen_trie_get(ft, words[w]) == (present[w] ? (void *)(uintptr_t)(w + 1) : NULL));
+        assert(frozen_trie_index(ft, words[w]) == (present[w] ? ref_rank(words, present, n, w) : -1));
+        char prefix[WORD_CAP];
+        size_t len = strlen(words[w]);
+        memcpy(prefix, words[w], (len + 1) / 2);
+        prefix[(len + 1) / 2] = '\0';
+        assert(frozen_trie_starts_with(ft, prefix) == ref_has_prefix(words, present, n, prefix));
+    }
+}
+
+/* Writes `len` bytes of `image` with one int32 at `off` replaced, then loads it. */
+static FrozenTrie *frozen_trie_load_patched(const char *path, const char *image, size_t len,
+                                            size_t off, int32_t patch) {
+    static char buf[1 << 20];
+    assert(len <= sizeof(buf));
+    memcpy(buf, image, len);
+    if (off + sizeof(patch) <= len) memcpy(buf + off, &patch, sizeof(patch));
+    FILE *f = fopen(path, "wb");
+    assert(f && fwrite(buf, 1, len, f) == len);
+    fclose(f);
+    return frozen_trie_load(path);
+}
+
+static void test_frozen_trie(void) {
+    static char words[WORDS][WORD_CAP];
+    static char present[WORDS];
+    make_words(words, WORDS, "abcd", 6);
+    Trie *t = trie_create(NULL);
+    for (int w = 0; w < WORDS; ++w) {
+        present[w] = w % 4 != 0;
+        if (present[w]) assert(trie_insert(t, words[w], (void *)(uintptr_t)(w + 1)));
+    }
+    FrozenTrie *ft = trie_freeze(t);
+    assert(ft && frozen_trie_size(ft) == trie_size(t));
+    frozen_trie_check(ft, words, present, WORDS);
+    /* The frozen copy does not depend on the Trie it came from. */
+    trie_destroy(t);
+
+    /* Save/load round trip: integer values survive, queries are unchanged. */
+    const char *path = "frozen_trie_test.bin";
+    assert(frozen_trie_save(ft, path));
+    FrozenTrie *loaded = frozen_trie_load(path);
+    assert(loaded && frozen_trie_size(loaded) == frozen_trie_size(ft));
+    frozen_trie_check(loaded, words, present, WORDS);
+    frozen_trie_destroy(loaded);
+
+    /* Corrupted images are rejected rather than read out of bounds. */
+    const char *image = (const char *)ft->mem;
+    size_t len = ft->mem_len, arrays = sizeof(FrozenTrieHeader);
+    size_t base0 = arrays, check0 = arrays + ft->nslots * sizeof(int32_t);
+    size_t term0 = check0 + ft->nslots * sizeof(int32_t);
+    int32_t child = ft->base[0] + trie_idx(words[1][0]), word = 0;
+    while (ft->term[word] < 0) word++;
+    loaded = frozen_trie_load_patched(path, image, len, len, 0);
+    assert(loaded != NULL);
+    frozen_trie_destroy(loaded);
+    assert(!frozen_trie_load_patched(path, image, len - 8, len, 0));
+    assert(!frozen_trie_load_patched(path, image, len, base0, (int32_t)ft->nslots));
+    assert(!frozen_trie_load_patched(path, image, len, base0, -1));
+    assert(!frozen_trie_load_patched(path, image, len, check0 + child * sizeof(int32_t),
+                                     (int32_t)ft->nslots));
+    assert(!frozen_trie_load_patched(path, image, len, check0 + child * sizeof(int32_t), child));
+    assert(!frozen_trie_load_patched(path, image, len, term0 + word * sizeof(int32_t),
+                                     (int32_t)ft->size));
+    assert(!frozen_trie_load_patched(path, image, len, term0 + word * sizeof(int32_t), -2));
+    remove(path);
+    frozen_trie_destroy(ft);
+    test_pass("frozen_trie");
+}
+
+#define TOPK 5
+
+static void test_trie_rank(void) {
+    static char words[WORDS][WORD_CAP];
+    static char present[WORDS];
+    static double score[WORDS];
+    memset(present, 0, sizeof(present));
+    make_words(words, WORDS, "abc", 7);
+    Trie *t = trie_create_ranked(NULL, TOPK);
+    uint64_t seed = 8;
+    for (int i = 0; i < 4000; ++i) {
+        int w = (int)(test_rand(&seed) % WORDS);
+        if (i % 4) {
+            /* Small integer scores, so ties fall back to word order. */
+            double sc = (double)(test_rand(&seed) % 20);
+            assert(trie_insert_scored(t, words[w], (void *)(uintptr_t)(w + 1), sc) == !present[w]);
+            present[w] = 1;
+            score[w] = sc;
+        } else {
+            assert(trie_remove(t, words[w]) == present[w]);
+            present[w] = 0;
+        }
+    }
+    assert(t->rank_count > 0);
+    for (int p = 0; p < WORDS; p += 5) {
+        char prefix[WORD_CAP];
+        size_t plen = strlen(words[p]) / 2;
+        memcpy(prefix, words[p], plen);
+        prefix[plen] = '\0';
+        /* Reference: the TOPK best matches by selection. */
+        int best[TOPK];
+        size_t nbest = 0;
+        for (; nbest < TOPK; ++nbest) {
+            int pick = -1;
+            for (int w = 0; w < WORDS; ++w) {
+                if (!present[w] || strncmp(words[w], prefix, plen) != 0) continue;
+                bool taken = false;
+                for (size_t j = 0; j < nbest; ++j) taken = taken || best[j] == w;
+                if (taken) continue;
+                if (pick < 0 || score[w] > score[pick] ||
+                    (score[w] == score[pick] && strcmp(words[w], words[pick]) < 0)) pick = w;
+            }
+            if (pick < 0) break;
+            best[nbest] = pick;
+        }
+        TrieCompletion out[TOPK + 1];
+        assert(trie_top_k(t, prefix, TOPK + 1, out) == nbest);
+        for (size_t j = 0; j < nbest; ++j) {
+            assert(strcmp(out[j].word, words[best[j]]) == 0 && out[j].score == score[best[j]]);
+            assert(out[j].value == (void *)(uintptr_t)(best[j] + 1));
+        }
+        assert(trie_top_k(t, prefix, 2, out) == (nbest < 2 ? nbest : 2));
+
+        /* Prefix iteration yields the same matches in lexicographic order. */
+        TrieIter it;
+        assert(trie_iter_init(&it, t, prefix));
+        const char *word, *last = NULL;
+        char last_buf[WORD_CAP];
+        void *value;
+        size_t count = 0, expect = 0;
+        while (trie_iter_next(&it, &word, &value)) {
+            assert(strncmp(word, prefix, plen) == 0 && (!last || strcmp(last, word) < 0));
+            int w = (int)(uintptr_t)value - 1;
+            assert(w >= 0 && w < WORDS && present[w] && strcmp(words[w], word) == 0);
+            strcpy(last_buf, word);
+            last = last_buf;
+            count++;
+        }
+        trie_iter_destroy(&it);
+        for (int w = 0; w < WORDS; ++w) expect += present[w] && strncmp(words[w], prefix, plen) == 0;
+        assert(count == expect);
+    }
+    /* Emptying the trie leaves no stale completions or table entries. */
+    for (int w = 0; w < WORDS; ++w) {
+        if (present[w]) assert(trie_remove(t, words[w]));
+    }
+    TrieCompletion out[TOPK];
+    assert(trie_top_k(t, "", TOPK, out) == 0);
+    assert(t->rank_count == 1);     /* the root's empty list */
+    trie_destroy(t);
+    test_pass("trie_rank");
+}
+
+#define AC_PATTERNS 60
+#define AC_TEXT 4000
+
+typedef struct AcHits {
+    char (*seen)[AC_TEXT];
+    size_t count, limit;
+} AcHits;
+
+static bool ac_record(size_t start, size_t len, void *value, void *user) {
+    AcHits *h = (AcHits *)user;
+    int w = (int)(uintptr_t)value - 1;
+    assert(w >= 0 && w < AC_PATTERNS && start + len <= AC_TEXT && !h->seen[w][start]);
+    h->seen[w][start] = 1;
+    return ++h->count != h->limit;
+}
+
+static void test_aho_corasick(void) {
+    static char words[AC_PATTERNS][WORD_CAP];
+    static char expect[AC_PATTERNS][AC_TEXT], seen[AC_PATTERNS][AC_TEXT];
+    static char text[AC_TEXT];
+    make_words(words, AC_PATTERNS, "abc", 9);
+    Trie *t = trie_create(NULL);
+    for (int w = 0; w < AC_PATTERNS; ++w) assert(trie_insert(t, words[w], (void *)(uintptr_t)(w + 1)));
+    AcMatcher *m = trie_build_matcher(t);
+    assert(m && m->npatterns == AC_PATTERNS);
+    trie_destroy(t);
+
+    /* Mostly pattern letters, some upper case, some separators. */
+    static const char alphabet[] = "abcabcabcABC -";
+    uint64_t seed = 10;
+    for (size_t i = 0; i < AC_TEXT; ++i) text[i] = alphabet[test_rand(&seed) % (sizeof(alphabet) - 1)];
+    size_t total = 0;
+    for (int w = 0; w < AC_PATTERNS; ++w) {
+        size_t len = strlen(words[w]);
+        for (size_t i = 0; i + len <= AC_TEXT; ++i) {
+            size_t j = 0;
+            while (j < len && tolower((unsigned char)text[i + j]) == words[w][j]) j++;
+            expect[w][i] = j == len;
+            total += j == len;
+        }
+    }
+
+    /* Feeding the text in uneven chunks finds matches across chunk edges. */
+    AcHits hits = { seen, 0, 0 };
+    AcStream st;
+    ac_stream_init(&st, m);
+    for (size_t off = 0; off < AC_TEXT; ) {
+        size_t chunk = 1 + (size_t)(test_rand(&seed) % 37);
+        if (chunk > AC_TEXT - off) chunk = AC_TEXT - off;
+        assert(ac_stream_match(&st, text + off, chunk, ac_record, &hits));
+        off += chunk;
+    }
+    assert(hits.count == total && memcmp(seen, expect, sizeof(seen)) == 0);
+
+    /* A callback returning false stops the scan at that match. */
+    memset(seen, 0, sizeof(seen));
+    hits.count = 0;
+    hits.limit = total / 2;
+    ac_stream_init(&st, m);
+    assert(!ac_stream_match(&st, text, AC_TEXT, ac_record, &hits));
+    assert(hits.count == total / 2 && st.offset < AC_TEXT);
+    ac_matcher_destroy(m);
+    test_pass("aho_corasick");
+}
+
+/* Plain O(mn) Levenshtein distance. */
+static size_t ref_edit_distance(const char *a, const char *b) {
+    size_t m = strlen(a), n = strlen(b), row[WORD_CAP * 2];
+    assert(n < sizeof(row) / sizeof(row[0]));
+    for (size_t j = 0; j <= n; ++j) row[j] = j;
+    for (size_t i = 1; i <= m; ++i) {
+        size_t diag = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= n; ++j) {
+            size_t up = row[j], best = diag + (a[i - 1] != b[j - 1]);
+            if (up + 1 < best) best = up + 1;
+            if (row[j - 1] + 1 < best) best = row[j - 1] + 1;
+            diag = up;
+            row[j] = best;
+        }
+    }
+    return row[n];
+}
+
+typedef struct FuzzyHits {
+    char (*words)[WORD_CAP];
+    char *seen;
+    const char *query;
+    size_t count, limit;
+} FuzzyHits;
+
+static bool fuzzy_record(const char *word, size_t dist, void *value, void *user) {
+    FuzzyHits *h = (FuzzyHits *)user;
+    int w = (int)(uintptr_t)value - 1;
+    assert(w >= 0 && w < WORDS && !h->seen[w] && strcmp(h->words[w], word) == 0);
+    assert(dist == ref_edit_distance(h->query, word));
+    h->seen[w] = 1;
+    return ++h->count != h->limit;
+}
+
+static void test_trie_fuzzy(void) {
+    static char words[WORDS][WORD_CAP];
+    static char seen[WORDS];
+    make_words(words, WORDS, "abcd", 11);
+    Trie *t = trie_create(NULL);
+    for (int w = 0; w < WORDS; ++w) assert(trie_insert(t, words[w], (void *)(uintptr_t)(w + 1)));
+    static char queries[40][WORD_CAP];
+    make_words(queries, 40, "abcde", 12);
+    for (int q = 0; q < 40; ++q) {
+        for (size_t d = 0; d <= 3; ++d) {
+            memset(seen, 0, sizeof(seen));
+            FuzzyHits hits = { words, seen, queries[q], 0, 0 };
+            size_t found = trie_fuzzy_search(t, queries[q], d, fuzzy_record, &hits);
+            size_t expect = 0;
+            for (int w = 0; w < WORDS; ++w) {
+                bool near = ref_edit_distance(queries[q], words[w]) <= d;
+                assert(seen[w] == near);
+                expect += near;
+            }
+            assert(found == expect && hits.count == expect);
+        }
+    }
+    /* Case and non-letters are folded away, and a false return stops early. */
+    memset(seen, 0, sizeof(seen));
+    FuzzyHits hits = { words, seen, "ab", 0, 2 };
+    assert(trie_fuzzy_search(t, "A-b", 2, fuzzy_record, &hits) == 2 && hits.count == 2);
+    assert(trie_fuzzy_search(t, "ab", 2, NULL, NULL) > 2);
+
+    /* Huge bounds match every word, even one deeper than the first buffers, without wrapping. */
+    char deep[201];
+    memset(deep, 'c', 200);
+    deep[200] = '\0';
+    assert(trie_insert(t, deep, NULL));
+    size_t all = trie_size(t);
+    assert(trie_fuzzy_search(t, "ab", SIZE_MAX, NULL, NULL) == all);
+    assert(trie_fuzzy_search(t, "ab", SIZE_MAX / 16, NULL, NULL) == all);
+    assert(trie_fuzzy_search(t, "", SIZE_MAX / 4 + 1, NULL, NULL) == all);
+    assert(trie_fuzzy_search(t, deep, 0, NULL, NULL) == 1);
+    assert(trie_fuzzy_search(t, deep + 3, 3, NULL, NULL) == 1);
+    trie_destroy(t);
+    test_pass("trie_fuzzy");
+}
+
+/* Atomic: tree_join.h set operations call free functions from several threads. */
+static _Atomic size_t freed_values;
+
+static void count_free(void *p) {
+    (void)p;
+    freed_values++;
+}
+
+static int cmp_word(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static void test_trie_bulk(void) {
+    static char words[WORDS][WORD_CAP];
+    static const char *sorted[WORDS + 2];
+    static void *values[WORDS + 2];
+    make_words(words, WORDS, "abc", 13);
+    for (int w = 0; w < WORDS; ++w) sorted[w] = words[w];
+    qsort(sorted, WORDS, sizeof(sorted[0]), cmp_word);
+    for (int w = 0; w < WORDS; ++w) values[w] = (void *)sorted[w];
+    /* Distinct prefixes, root included: the node count of the trie. */
+    size_t nodes = 1;
+    for (int w = 0; w < WORDS; ++w) {
+        for (size_t len = 1; len <= strlen(sorted[w]); ++len) {
+            bool first = true;
+            for (int v = 0; v < w && first; ++v) {
+                first = strlen(sorted[v]) < len || strncmp(sorted[v], sorted[w], len) != 0;
+            }
+            nodes += first;
+        }
+    }
+
+    /* Sorted input, NULL entries skipped, and a trailing duplicate replacing its value. */
+    sorted[WORDS] = NULL;
+    sorted[WORDS + 1] = sorted[0];
+    values[WORDS + 1] = (void *)"dup";
+    freed_values = 0;
+    Trie *t = trie_build_sorted(sorted, values, WORDS + 2, count_free);
+    assert(t && trie_size(t) == WORDS && freed_values == 1);
+    for (int w = 0; w < WORDS; ++w) {
+        assert(trie_contains(t, words[w]));
+        const char *v = (const char *)trie_get(t, words[w]);
+        assert(strcmp(words[w], sorted[0]) == 0 ? strcmp(v, "dup") == 0 : strcmp(v, words[w]) == 0);
+    }
+    /* Pooled nodes can be removed and re-added like any others. */
+    for (int w = 0; w < WORDS; w += 3) assert(trie_remove(t, words[w]));
+    for (int w = 0; w < WORDS; w += 6) assert(trie_insert(t, words[w], words[w]));
+    for (int w = 0; w < WORDS; ++w) assert(trie_contains(t, words[w]) == (w % 3 != 0 || w % 6 == 0));
+    trie_destroy(t);
+
+    /* Unsorted input gives the same trie. */
+    const char *unsorted[WORDS];
+    for (int w = 0; w < WORDS; ++w) unsorted[w] = words[w];
+    t = trie_build_sorted(unsorted, NULL, WORDS, NULL);
+    assert(t && trie_size(t) == WORDS);
+    for (int w = 0; w < WORDS; ++w) assert(trie_contains(t, words[w]) && !trie_get(t, words[w]));
+    trie_destroy(t);
+
+    /* Budgeted teardown frees `budget` nodes per call and every value once. */
+    t = trie_create(count_free);
+    for (int w = 0; w < WORDS; ++w) assert(trie_insert(t, words[w], words[w]));
+    freed_values = 0;
+    size_t calls = 1;
+    while (!trie_destroy_step(t, 7)) calls++;
+    assert(calls == (nodes + 6) / 7 && freed_values == WORDS);
+    test_pass("trie_bulk");
+}
+
+/* Same ownership scheme as the concurrent skip list test: word w belongs to w % TEST_THREADS. */
+typedef struct {
+    CTrie *t;
+    int id;
+    char (*words)[WORD_CAP];
+    char *present;
+} CTrieArgs;
+
+static void *ctrie_worker(void *arg) {
+    CTrieArgs *a = (CTrieArgs *)arg;
+    EpochThread *th = ctrie_register(a->t);
+    uint64_t seed = 200 + (uint64_t)a->id;
+    for (int i = 0; i < SET_OPS; ++i) {
+        uint64_t r = test_rand(&seed);
+        int w = (int)(r % WORDS);
+        const char *word = a->words[w];
+        if (w % TEST_THREADS != a->id) {
+            /* Someone else's word: any answer is fine, but a value must be its own. */
+            void *v = ctrie_get(a->t, th, word);
+            assert(!v || v == (void *)(uintptr_t)(w + 1));
+            ctrie_starts_with(a->t, th, word);
+            continue;
+        }
+        if (r & (1u << 20)) {
+            assert(ctrie_insert(a->t, th, word, (void *)(uintptr_t)(w + 1)) == !a->present[w]);
+            a->present[w] = 1;
+        } else {
+            assert(ctrie_remove(a->t, th, word) == a->present[w]);
+            a->present[w] = 0;
+        }
+        assert(ctrie_get(a->t, th, word) == (a->present[w] ? (void *)(uintptr_t)(w + 1) : NULL));
+        /* Prefixes of a present word stay reachable whatever the others do. */
+        if (a->present[w]) assert(ctrie_starts_with(a->t, th, word));
+    }
+    ctrie_unregister(th);
+    return NULL;
+}
+
+static void test_concurrent_trie(void) {
+    static char words[WORDS][WORD_CAP];
+    static char present[WORDS];
+    memset(present, 0, sizeof(present));
+    make_words(words, WORDS, "abcd", 14);
+    CTrie *t = ctrie_create(NULL);
+    EpochThread *th = ctrie_register(t);
+    size_t size = 0;
+    uint64_t seed = 15;
+    for (int i = 0; i < SET_OPS; ++i) {
+        int w = (int)(test_rand(&seed) % WORDS);
+        if (i % 3) {
+            void *value = (void *)(uintptr_t)(w + 1 + i);
+            assert(ctrie_insert(t, th, words[w], value) == !present[w]);
+            assert(ctrie_get(t, th, words[w]) == value);
+            size += !present[w];
+            present[w] = 1;
+        } else {
+            assert(ctrie_remove(t, th, words[w]) == present[w]);
+            size -= present[w];
+            present[w] = 0;
+        }
+        assert(ctrie_size(t) == size);
+    }
+    for (int w = 0; w < WORDS; ++w) {
+        assert(ctrie_contains(t, th, words[w]) == present[w]);
+        char prefix[WORD_CAP];
+        size_t len = strlen(words[w]);
+        memcpy(prefix, words[w], (len + 1) / 2);
+        prefix[(len + 1) / 2] = '\0';
+        assert(ctrie_starts_with(t, th, prefix) == ref_has_prefix(words, present, WORDS, prefix));
+    }
+    ctrie_unregister(th);
+    ctrie_destroy(t);
+
+    /* Writers on overlapping paths, readers everywhere. */
+    memset(present, 0, sizeof(present));
+    t = ctrie_create(NULL);
+    pthread_t tid[TEST_THREADS];
+    CTrieArgs args[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (CTrieArgs){ t, i, words, present };
+        pthread_create(&tid[i], NULL, ctrie_worker, &args[i]);
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) pthread_join(tid[i], NULL);
+    th = ctrie_register(t);
+    size = 0;
+    for (int w = 0; w < WORDS; ++w) {
+        assert(ctrie_get(t, th, words[w]) == (present[w] ? (void *)(uintptr_t)(w + 1) : NULL));
+        size += present[w];
+    }
+    assert(ctrie_size(t) == size);
+    ctrie_unregister(th);
+    ctrie_destroy(t);
+    test_pass("concurrent_trie");
+}
+
+// =======================================
+// Trees
+// =======================================
+
+#define TREE_KEYS 4096
+
+static int cmp_uint(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t)a, y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+#define UKEY(k) ((void *)(uintptr_t)(k))
+
+/*
+ * Checks keys in (lo, hi), parent links and subtree sizes below `n`, plus
+ * AVL heights and balance when `balanced`. Returns the subtree height.
+ */
+static int bst_check(const BSTNode *n, const BSTNode *parent, uintptr_t lo, uintptr_t hi, bool balanced) {
+    if (!n) return 0;
+    uintptr_t k = (uintptr_t)n->key;
+    assert(n->parent == parent && k > lo && k < hi);
+    int hl = bst_check(n->left, n, lo, k, balanced);
+    int hr = bst_check(n->right, n, k, hi, balanced);
+    assert(n->size == bst_subtree_size(n->left) + bst_subtree_size(n->right) + 1);
+    int h = (hl > hr ? hl : hr) + 1;
+    if (balanced) assert(n->height == h && hl - hr <= 1 && hr - hl <= 1);
+    return h;
+}
+
+static void bst_check_tree(const BST *t) {
+    bst_check(t->root, NULL, 0, UINTPTR_MAX, t->balanced);
+    assert(bst_subtree_size(t->root) == bst_size(t));
+}
+
+static void test_avl(void) {
+    static char ref[TREE_KEYS];
+    for (int balanced = 0; balanced < 2; ++balanced) {
+        memset(ref, 0, sizeof(ref));
+        BST *t = balanced ? bst_create_balanced(cmp_uint, NULL, NULL) : bst_create(cmp_uint, NULL, NULL);
+        size_t size = 0;
+        uint64_t seed = 16;
+        for (int i = 0; i < 40000; ++i) {
+            uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+            if (i % 3) {
+                assert(bst_insert(t, UKEY(k), UKEY(k + i)) == !ref[k - 1]);
+                assert(bst_get(t, UKEY(k)) == UKEY(k + i));
+                size += !ref[k - 1];
+                ref[k - 1] = 1;
+            } else {
+                assert(bst_remove(t, UKEY(k)) == ref[k - 1]);
+                assert(!bst_get(t, UKEY(k)));
+                size -= ref[k - 1];
+                ref[k - 1] = 0;
+            }
+            assert(bst_size(t) == size);
+            if (i % 1000 == 0) bst_check_tree(t);
+        }
+        bst_check_tree(t);
+        /* Drain from both ends so removals hit every node shape. */
+        for (uintptr_t i = 0; i < TREE_KEYS; ++i) {
+            uintptr_t key = i % 2 ? TREE_KEYS - i / 2 : 1 + i / 2;
+            assert(bst_remove(t, UKEY(key)) == ref[key - 1]);
+            ref[key - 1] = 0;
+            if (i % 256 == 0) bst_check_tree(t);
+        }
+        assert(bst_size(t) == 0 && !t->root);
+        bst_destroy(t);
+    }
+    /* Sorted input keeps a balanced tree at AVL height (< 1.45 log2 n). */
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    for (uintptr_t k = 1; k <= TREE_KEYS; ++k) assert(bst_insert(t, UKEY(k), NULL));
+    bst_check_tree(t);
+    assert(bst_height(t->root) <= 17);
+    bst_destroy(t);
+    test_pass("avl");
+}
+
+static int cmp_str(const void *a, const void *b) { return strcmp((const char *)a, (const char *)b); }
+
+static int bptree_cmp(const BPTree *t, const void *a, const void *b) {
+    return t->cmp ? t->cmp(a, b) : cmp_uint(a, b);
+}
+
+/*
+ * Checks that keys below `n` lie in [lo, hi) (NULL means unbounded), that
+ * nodes outside the root hold the minimum, and that every separator is the
+ * pointer of a key still stored in a leaf. Returns the node's height.
+ */
+static int bptree_check(const BPTree *t, const BPNode *n, const void *lo, const void *hi) {
+    assert(n == t->root || n->n >= (n->leaf ? BPTREE_MIN_LEAF : BPTREE_MIN_INNER));
+    for (uint32_t i = 0; i < n->n; ++i) {
+        assert(!lo || bptree_cmp(t, n->keys[i], lo) >= 0);
+        assert(!hi || bptree_cmp(t, n->keys[i], hi) < 0);
+        assert(i == 0 || bptree_cmp(t, n->keys[i - 1], n->keys[i]) < 0);
+    }
+    if (n->leaf) return 1;
+    const BPInner *in = (const BPInner *)n;
+    for (uint32_t i = 0; i < n->n; ++i) {
+        const BPLeaf *l = bptree_find_leaf(t, n->keys[i]);
+        uint32_t pos = bptree_rank(t, &l->hdr, n->keys[i], false);
+        assert(pos < l->hdr.n && l->hdr.keys[pos] == n->keys[i]);
+    }
+    int h = 0;
+    for (uint32_t i = 0; i <= n->n; ++i) {
+        int ch = bptree_check(t, in->child[i], i ? n->keys[i - 1] : lo, i < n->n ? n->keys[i] : hi);
+        assert(i == 0 || ch == h);
+        h = ch;
+    }
+    return h + 1;
+}
+
+static void count_entry(void *key, void *value, void *user) {
+    uintptr_t *last = (uintptr_t *)user;
+    assert((uintptr_t)key > last[0] && value == UKEY((uintptr_t)key * 3));
+    last[0] = (uintptr_t)key;
+    last[1]++;
+}
+
+static void test_bptree(void) {
+    static char ref[TREE_KEYS];
+    /* Integer keys, both with the branch-free search and through a comparator. */
+    for (int with_cmp = 0; with_cmp < 2; ++with_cmp) {
+        memset(ref, 0, sizeof(ref));
+        BPTree *t = bptree_create(with_cmp ? cmp_uint : NULL, NULL, NULL);
+        size_t size = 0;
+        uint64_t seed = 17;
+        for (int i = 0; i < 60000; ++i) {
+            uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+            if (i % 5 < 3) {
+                assert(bptree_insert(t, UKEY(k), UKEY(k * 3)) == !ref[k - 1]);
+                size += !ref[k - 1];
+                ref[k - 1] = 1;
+            } else {
+                assert(bptree_remove(t, UKEY(k)) == ref[k - 1]);
+                size -= ref[k - 1];
+                ref[k - 1] = 0;
+            }
+            assert(bptree_size(t) == size);
+            if (i % 2000 == 0) bptree_check(t, t->root, NULL, NULL);
+        }
+        bptree_check(t, t->root, NULL, NULL);
+        size_t in_range = 0;
+        for (uintptr_t k = 1; k <= TREE_KEYS; ++k) {
+            assert(bptree_contains(t, UKEY(k)) == ref[k - 1]);
+            assert(bptree_get(t, UKEY(k)) == (ref[k - 1] ? UKEY(k * 3) : NULL));
+            in_range += k >= 1000 && k <= 3000 && ref[k - 1];
+        }
+        uintptr_t walk[2] = { 0, 0 };
+        bptree_inorder(t, count_entry, walk);
+        assert(walk[1] == size);
+        walk[0] = walk[1] = 0;
+        bptree_range(t, UKEY(1000), UKEY(3000), count_entry, walk);
+        assert(walk[1] == in_range);
+        for (uintptr_t k = 1; k <= TREE_KEYS; ++k) assert(bptree_remove(t, UKEY(k)) == ref[k - 1]);
+        assert(bptree_size(t) == 0 && t->root->leaf && t->root->n == 0);
+        bptree_destroy(t);
+    }
+
+    /*
+     * Heap keys owned by the tree. Separators name leaf keys, so removing or
+     * replacing a key that is also a separator must not leave a dangling one
+     * (ASan catches the use after free; bptree_check catches the stale pointer).
+     */
+    memset(ref, 0, sizeof(ref));
+    BPTree *t = bptree_create(cmp_str, free, free);
+    uint64_t seed = 18;
+    char buf[16];
+    for (int i = 0; i < 60000; ++i) {
+        int k = (int)(test_rand(&seed) % 1024);
+        snprintf(buf, sizeof(buf), "k%05d", k);
+        if (i % 4 == 0) {
+            assert(bptree_remove(t, buf) == ref[k]);
+            ref[k] = 0;
+        } else {
+            /* Re-inserting a present key frees the old key and value. */
+            assert(bptree_insert(t, strdup(buf), strdup(buf)) == !ref[k]);
+            ref[k] = 1;
+        }
+        const char *v = (const char *)bptree_get(t, buf);
+        assert(ref[k] ? v && strcmp(v, buf) == 0 : !v);
+        if (i % 2000 == 0) bptree_check(t, t->root, NULL, NULL);
+    }
+    bptree_check(t, t->root, NULL, NULL);
+    for (int k = 0; k < 1024; ++k) {
+        snprintf(buf, sizeof(buf), "k%05d", k);
+        assert(bptree_contains(t, buf) == ref[k]);
+    }
+    bptree_destroy(t);
+
+    /* Bottom-up build from sorted keys. */
+    static void *keys[TREE_KEYS], *values[TREE_KEYS];
+    for (uintptr_t k = 0; k < TREE_KEYS; ++k) {
+        keys[k] = UKEY(k + 1);
+        values[k] = UKEY((k + 1) * 3);
+    }
+    t = bptree_build_sorted(NULL, NULL, NULL, keys, values, TREE_KEYS);
+    assert(t && bptree_size(t) == TREE_KEYS);
+    bptree_check(t, t->root, NULL, NULL);
+    uintptr_t walk[2] = { 0, 0 };
+    bptree_inorder(t, count_entry, walk);
+    assert(walk[1] == TREE_KEYS);
+    for (uintptr_t k = 1; k <= TREE_KEYS; k += 2) assert(bptree_remove(t, UKEY(k)));
+    bptree_check(t, t->root, NULL, NULL);
+    bptree_destroy(t);
+    test_pass("bptree");
+}
+
+static void count_key(void *key, void *value, void *user) {
+    uintptr_t *last = (uintptr_t *)user;
+    (void)value;
+    assert((uintptr_t)key > last[0]);
+    last[0] = (uintptr_t)key;
+    last[1]++;
+}
+
+static void test_bst_range(void) {
+    static char ref[TREE_KEYS + 2];
+    for (int balanced = 0; balanced < 2; ++balanced) {
+        memset(ref, 0, sizeof(ref));
+        BST *t = balanced ? bst_create_balanced(cmp_uint, NULL, NULL) : bst_create(cmp_uint, NULL, NULL);
+        uint64_t seed = 19;
+        size_t size = 0;
+        for (int i = 0; i < TREE_KEYS; ++i) {
+            uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+            size += bst_insert(t, UKEY(k), NULL);
+            ref[k] = 1;
+        }
+        /* Bounds against a scan of the reference. */
+        for (uintptr_t q = 0; q <= TREE_KEYS + 1; ++q) {
+            uintptr_t lb = q, ub = q + 1;
+            while (lb <= TREE_KEYS && !ref[lb]) lb++;
+            while (ub <= TREE_KEYS && !ref[ub]) ub++;
+            BSTNode *n = bst_lower_bound(t, UKEY(q));
+            assert(lb > TREE_KEYS ? !n : n && (uintptr_t)n->key == lb);
+            n = bst_upper_bound(t, UKEY(q));
+            assert(ub > TREE_KEYS ? !n : n && (uintptr_t)n->key == ub);
+        }
+        /* Full walks both ways. */
+        size_t count = 0;
+        uintptr_t prev = 0;
+        for (BSTNode *n = bst_first(t); n; n = bst_next(n), count++) {
+            assert((uintptr_t)n->key > prev && ref[(uintptr_t)n->key]);
+            prev = (uintptr_t)n->key;
+        }
+        assert(count == size && !bst_next(bst_last(t)) && !bst_prev(bst_first(t)));
+        count = 0;
+        prev = UINTPTR_MAX;
+        for (BSTNode *n = bst_last(t); n; n = bst_prev(n), count++) {
+            assert((uintptr_t)n->key < prev);
+            prev = (uintptr_t)n->key;
+        }
+        assert(count == size);
+        uintptr_t walk[2] = { 0, 0 };
+        bst_inorder(t, count_key, walk);
+        assert(walk[1] == size);
+        /* Ranges, including empty and inverted ones. */
+        for (int r = 0; r < 200; ++r) {
+            uintptr_t lo = (uintptr_t)(test_rand(&seed) % (TREE_KEYS + 2));
+            uintptr_t hi = (uintptr_t)(test_rand(&seed) % (TREE_KEYS + 2));
+            size_t expect = 0;
+            for (uintptr_t k = lo; k <= hi; ++k) expect += ref[k];
+            walk[0] = lo ? lo - 1 : 0;
+            walk[1] = 0;
+            assert(bst_range(t, UKEY(lo), UKEY(hi), count_key, walk) == expect && walk[1] == expect);
+            assert(bst_range(t, UKEY(lo), UKEY(hi), NULL, NULL) == expect);
+        }
+        /* A cursor keeps working across inserts on either side of it. */
+        BSTNode *cur = bst_lower_bound(t, UKEY(TREE_KEYS / 2));
+        uintptr_t at = (uintptr_t)cur->key;
+        for (uintptr_t k = 1; k <= TREE_KEYS; k += 2) {
+            bst_insert(t, UKEY(k), NULL);
+            ref[k] = 1;
+        }
+        assert((uintptr_t)cur->key == at);
+        for (BSTNode *n = bst_next(cur); n; n = bst_next(n)) {
+            uintptr_t next = at + 1;
+            while (!ref[next]) next++;
+            assert((uintptr_t)n->key == next);
+            at = next;
+        }
+        /*
+         * Removing a key whose node has two children frees only that node:
+         * cursors on its neighbours, the successor in particular, stay valid.
+         */
+        for (int r = 0; r < 200; ++r) {
+            BSTNode *n = bst_lower_bound(t, UKEY(1 + test_rand(&seed) % TREE_KEYS));
+            while (n && !(n->left && n->right)) n = bst_next(n);
+            if (!n) continue;
+            uintptr_t gone = (uintptr_t)n->key;
+            BSTNode *succ = bst_next(n), *pred = bst_prev(n);
+            uintptr_t sk = (uintptr_t)succ->key, pk = (uintptr_t)pred->key;
+            assert(bst_remove(t, UKEY(gone)) && !bst_get(t, UKEY(gone)));
+            ref[gone] = 0;
+            assert((uintptr_t)succ->key == sk && (uintptr_t)pred->key == pk);
+            assert(bst_next(pred) == succ && bst_prev(succ) == pred);
+            bst_check_tree(t);
+        }
+        count = 0;
+        for (BSTNode *n = bst_first(t); n; n = bst_next(n), count++) assert(ref[(uintptr_t)n->key]);
+        assert(count == bst_size(t));
+        bst_destroy(t);
+    }
+    test_pass("bst_range");
+}
+
+static void test_bst_stats(void) {
+    static char ref[TREE_KEYS + 2];
+    static uintptr_t sorted[TREE_KEYS];
+    for (int balanced = 0; balanced < 2; ++balanced) {
+        memset(ref, 0, sizeof(ref));
+        BST *t = balanced ? bst_create_balanced(cmp_uint, NULL, NULL) : bst_create(cmp_uint, NULL, NULL);
+        uint64_t seed = 20;
+        for (int i = 0; i < 3 * TREE_KEYS; ++i) {
+            uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+            if (i % 3) {
+                bst_insert(t, UKEY(k), NULL);
+                ref[k] = 1;
+            } else {
+                bst_remove(t, UKEY(k));
+                ref[k] = 0;
+            }
+        }
+        size_t n = 0;
+        for (uintptr_t k = 1; k <= TREE_KEYS; ++k) {
+            if (ref[k]) sorted[n++] = k;
+        }
+        assert(bst_size(t) == n);
+        /* select(i) is the i-th key and rank() inverts it. */
+        for (size_t i = 0; i < n; ++i) {
+            BSTNode *node = bst_select(t, i);
+            assert(node && (uintptr_t)node->key == sorted[i]);
+            assert(bst_rank(t, UKEY(sorted[i])) == i);
+        }
+        assert(!bst_select(t, n));
+        /* rank() of an absent key is where it would go. */
+        size_t below = 0;
+        for (uintptr_t k = 0; k <= TREE_KEYS + 1; ++k) {
+            assert(bst_rank(t, UKEY(k)) == below);
+            below += ref[k];
+        }
+        for (int r = 0; r < 500; ++r) {
+            uintptr_t lo = (uintptr_t)(test_rand(&seed) % (TREE_KEYS + 2));
+            uintptr_t hi = (uintptr_t)(test_rand(&seed) % (TREE_KEYS + 2));
+            size_t expect = 0;
+            for (uintptr_t k = lo; k <= hi; ++k) expect += ref[k];
+            assert(bst_count_range(t, UKEY(lo), UKEY(hi)) == expect);
+            assert(bst_count_range(t, UKEY(lo), UKEY(hi)) == bst_range(t, UKEY(lo), UKEY(hi), NULL, NULL));
+        }
+        bst_destroy(t);
+    }
+    test_pass("bst_stats");
+}
+
+DS_BST_DECLARE(TestMap, long, long, (a > b) - (a < b))
+
+/* Checks order and AVL heights below `n`; returns the subtree height. */
+static int typed_check(const TestMap_node *n, long lo, long hi, size_t *count) {
+    if (!n) return 0;
+    assert(n->key > lo && n->key < hi && n->value == n->key * 7);
+    int hl = typed_check(n->left, lo, n->key, count);
+    int hr = typed_check(n->right, n->key, hi, count);
+    assert(n->height == (hl > hr ? hl : hr) + 1 && hl - hr <= 1 && hr - hl <= 1);
+    (*count)++;
+    return n->height;
+}
+
+static void typed_visit(long key, long *value, void *user) {
+    long *last = (long *)user;
+    assert(key > last[0] && *value == key * 7);
+    last[0] = key;
+    last[1]++;
+}
+
+static void test_typed_tree(void) {
+    static char ref[TREE_KEYS];
+    static long *slot[TREE_KEYS];
+    memset(ref, 0, sizeof(ref));
+    TestMap *t = TestMap_create();
+    size_t size = 0;
+    uint64_t seed = 21;
+    for (int i = 0; i < 60000; ++i) {
+        long k = (long)(test_rand(&seed) % TREE_KEYS);
+        if (i % 3) {
+            assert(TestMap_insert(t, k, k * 7) == !ref[k]);
+            size += !ref[k];
+            ref[k] = 1;
+            slot[k] = TestMap_get(t, k);
+        } else {
+            assert(TestMap_remove(t, k) == ref[k]);
+            size -= ref[k];
+            ref[k] = 0;
+        }
+        assert(TestMap_size(t) == size);
+        if (i % 2000 == 0) {
+            size_t count = 0;
+            typed_check(t->root, -1, TREE_KEYS, &count);
+            assert(count == size);
+        }
+    }
+    /* Value pointers taken at insert time still point at their own entries. */
+    for (long k = 0; k < TREE_KEYS; ++k) {
+        assert(TestMap_contains(t, k) == ref[k]);
+        if (ref[k]) assert(TestMap_get(t, k) == slot[k] && *slot[k] == k * 7);
+        else assert(!TestMap_get(t, k));
+    }
+    long walk[2] = { -1, 0 };
+    TestMap_inorder(t, typed_visit, walk);
+    assert((size_t)walk[1] == size);
+    for (long k = 0; k < TREE_KEYS; ++k) assert(TestMap_remove(t, k) == ref[k]);
+    assert(TestMap_size(t) == 0 && !t->root);
+    TestMap_destroy(t);
+    test_pass("typed_tree");
+}
+
+static void frozen_tree_check(const FrozenTree *ft, const char *ref, size_t size) {
+    assert(frozen_tree_size(ft) == size);
+    for (uintptr_t q = 0; q <= TREE_KEYS + 1; ++q) {
+        uintptr_t lb = q;
+        while (lb <= TREE_KEYS && !ref[lb]) lb++;
+        size_t slot = frozen_tree_lower_bound(ft, UKEY(q));
+        assert(lb > TREE_KEYS ? slot == 0 : slot && (uintptr_t)frozen_tree_key(ft, slot) == lb);
+        assert(frozen_tree_contains(ft, UKEY(q)) == (q <= TREE_KEYS && ref[q]));
+        assert(frozen_tree_get(ft, UKEY(q)) == (q <= TREE_KEYS && ref[q] ? UKEY(q * 3) : NULL));
+    }
+    size_t count = 0;
+    uintptr_t prev = 0;
+    for (size_t slot = frozen_tree_first(ft); slot; slot = frozen_tree_next(ft, slot), count++) {
+        uintptr_t k = (uintptr_t)frozen_tree_key(ft, slot);
+        assert(k > prev && ref[k] && frozen_tree_value(ft, slot) == UKEY(k * 3));
+        prev = k;
+    }
+    assert(count == size);
+}
+
+static void test_frozen_tree(void) {
+    static char ref[TREE_KEYS + 2];
+    memset(ref, 0, sizeof(ref));
+    BST *t = bst_create_balanced(cmp_uint, NULL, NULL);
+    /* An empty tree freezes to an empty table. */
+    FrozenTree *ft = bst_freeze(t, NULL);
+    assert(ft && frozen_tree_size(ft) == 0 && !frozen_tree_first(ft));
+    assert(!frozen_tree_lower_bound(ft, UKEY(1)) && !frozen_tree_contains(ft, UKEY(1)));
+    frozen_tree_destroy(ft);
+
+    uint64_t seed = 22;
+    size_t size = 0;
+    for (int i = 0; i < TREE_KEYS; ++i) {
+        uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+        size += bst_insert(t, UKEY(k), UKEY(k * 3));
+        ref[k] = 1;
+    }
+    /* Both the integer fast path and a comparator. */
+    for (int with_cmp = 0; with_cmp < 2; ++with_cmp) {
+        ft = bst_freeze(t, with_cmp ? cmp_uint : NULL);
+        assert(ft);
+        frozen_tree_check(ft, ref, size);
+        frozen_tree_destroy(ft);
+    }
+    ft = bst_freeze(t, NULL);
+    bst_destroy(t);
+
+    /* Save/load round trip, then a truncated file. */
+    const char *path = "frozen_tree_test.bin";
+    assert(frozen_tree_save(ft, path));
+    FrozenTree *loaded = frozen_tree_load(path, NULL);
+    assert(loaded);
+    frozen_tree_check(loaded, ref, size);
+    frozen_tree_destroy(loaded);
+    FILE *f = fopen(path, "wb");
+    assert(f && fwrite(ft->mem, 1, ft->mem_len - 8, f) == ft->mem_len - 8);
+    fclose(f);
+    assert(!frozen_tree_load(path, NULL));
+    remove(path);
+    frozen_tree_destroy(ft);
+    test_pass("frozen_tree");
+}
+
+#define PTREE_KEYS 1024
+#define PTREE_SNAPS 8
+
+/* AVL heights and key order below `n`; returns the subtree height. */
+static int ptree_check(const PTreeNode *n, uintptr_t lo, uintptr_t hi) {
+    if (!n) return 0;
+    uintptr_t k = (uintptr_t)n->key;
+    assert(k > lo && k < hi);
+    int hl = ptree_check(n->left, lo, k), hr = ptree_check(n->right, k, hi);
+    assert(n->height == (hl > hr ? hl : hr) + 1 && hl - hr <= 1 && hr - hl <= 1);
+    return n->height;
+}
+
+/* Order-sensitive digest of a snapshot's entries. */
+static void ptree_digest(void *key, void *value, void *user) {
+    uint64_t *d = (uint64_t *)user;
+    assert((uintptr_t)key > d[2]);
+    d[2] = (uintptr_t)key;
+    d[0] = d[0] * 1000003u + (uintptr_t)key * 31u + (uintptr_t)value;
+    d[1]++;
+}
+
+static void ptree_snapshot_check(const PTreeSnapshot *s, const uintptr_t *ref) {
+    ptree_check(s->root, 0, UINTPTR_MAX);
+    size_t size = 0;
+    for (uintptr_t k = 1; k <= PTREE_KEYS; ++k) {
+        assert(ptree_snapshot_get(s, UKEY(k)) == (ref[k] ? UKEY(ref[k]) : NULL));
+        assert(ptree_snapshot_contains(s, UKEY(k)) == (ref[k] != 0));
+        size += ref[k] != 0;
+    }
+    uint64_t d[3] = { 0, 0, 0 };
+    ptree_snapshot_inorder(s, ptree_digest, d);
+    assert(ptree_snapshot_size(s) == size && d[1] == size);
+}
+
+typedef struct {
+    PTree *t;
+    atomic_int *done;
+} PTreeArgs;
+
+/* Takes snapshots while the writer runs and checks that each one stays put. */
+static void *ptree_reader(void *arg) {
+    PTreeArgs *a = (PTreeArgs *)arg;
+    EpochThread *th = ptree_register(a->t);
+    for (int i = 0; i < 300; ++i) {
+        PTreeSnapshot *s = ptree_snapshot(a->t, th);
+        uint64_t first[3] = { 0, 0, 0 }, again[3] = { 0, 0, 0 };
+        ptree_snapshot_inorder(s, ptree_digest, first);
+        assert(first[1] == ptree_snapshot_size(s));
+        sched_yield();
+        ptree_snapshot_inorder(s, ptree_digest, again);
+        assert(first[0] == again[0] && first[1] == again[1]);
+        ptree_check(s->root, 0, UINTPTR_MAX);
+        ptree_snapshot_release(s);
+    }
+    atomic_fetch_add(a->done, 1);
+    ptree_unregister(th);
+    return NULL;
+}
+
+static void test_persistent_tree(void) {
+    static uintptr_t ref[PTREE_KEYS + 1], saved[PTREE_SNAPS][PTREE_KEYS + 1];
+    memset(ref, 0, sizeof(ref));
+    freed_values = 0;
+    PTree *t = ptree_create(cmp_uint, NULL, count_free);
+    EpochThread *th = ptree_register(t);
+    PTreeSnapshot *snaps[PTREE_SNAPS];
+    size_t nsnaps = 0, inserts = 0, size = 0;
+    uint64_t seed = 23;
+    for (int i = 0; i < 16000; ++i) {
+        uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % PTREE_KEYS);
+        if (i % 3) {
+            /* Values change on every insert, so replacements are visible. */
+            uintptr_t v = k * 100000 + (uintptr_t)i;
+            assert(ptree_insert(t, th, UKEY(k), UKEY(v)) == !ref[k]);
+            size += !ref[k];
+            ref[k] = v;
+            inserts++;
+        } else {
+            assert(ptree_remove(t, th, UKEY(k)) == (ref[k] != 0));
+            size -= ref[k] != 0;
+            ref[k] = 0;
+        }
+        assert(ptree_size(t) == size);
+        assert(ptree_get(t, UKEY(k)) == (ref[k] ? UKEY(ref[k]) : NULL));
+        if (i % 2000 == 1999) {
+            snaps[nsnaps] = ptree_snapshot(t, th);
+            memcpy(saved[nsnaps++], ref, sizeof(ref));
+        }
+    }
+    /* Every snapshot still shows the tree as it was when taken. */
+    for (size_t i = 0; i < nsnaps; ++i) {
+        ptree_snapshot_check(snaps[i], saved[i]);
+        ptree_snapshot_release(snaps[i]);
+    }
+    PTreeSnapshot *head = ptree_snapshot(t, th);
+    ptree_snapshot_check(head, ref);
+    ptree_snapshot_release(head);
+    ptree_unregister(th);
+    ptree_destroy(t);
+    /* Each inserted value is released exactly once: replaced, removed or at destroy. */
+    assert(freed_values == inserts);
+
+    /* Readers hold snapshots across yields while one writer keeps updating. */
+    t = ptree_create(cmp_uint, NULL, NULL);
+    th = ptree_register(t);
+    atomic_int done;
+    atomic_init(&done, 0);
+    pthread_t tid[TEST_THREADS - 1];
+    PTreeArgs args = { t, &done };
+    for (int i = 0; i < TEST_THREADS - 1; ++i) pthread_create(&tid[i], NULL, ptree_reader, &args);
+    memset(ref, 0, sizeof(ref));
+    for (int i = 0; atomic_load(&done) < TEST_THREADS - 1; ++i) {
+        uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % PTREE_KEYS);
+        if (i % 3) {
+            ptree_insert(t, th, UKEY(k), UKEY(k * 3));
+            ref[k] = k * 3;
+        } else {
+            ptree_remove(t, th, UKEY(k));
+            ref[k] = 0;
+        }
+    }
+    for (int i = 0; i < TEST_THREADS - 1; ++i) pthread_join(tid[i], NULL);
+    head = ptree_snapshot(t, th);
+    ptree_snapshot_check(head, ref);
+    ptree_snapshot_release(head);
+    ptree_unregister(th);
+    ptree_destroy(t);
+    test_pass("persistent_tree");
+}
+
+/* Real keys stay below the sentinels, which route above everything. */
+static uintptr_t cbst_key_of(const CBSTNode *n) {
+    return n->inf ? UINTPTR_MAX - 2 + n->inf : (uintptr_t)n->key;
+}
+
+/*
+ * Checks that leaves below `n` lie in [lo, hi), that inner nodes route
+ * left below their key, and, when `balanced`, that height hints are exact
+ * and AVL. Counts real leaves into *leaves and returns the subtree height.
+ */
+static int cbst_check(CBSTNode *n, uintptr_t lo, uintptr_t hi, bool balanced, size_t *leaves) {
+    uintptr_t k = cbst_key_of(n);
+    assert(k >= lo && k < hi);
+    if (n->leaf) {
+        *leaves += !n->inf;
+        return 1;
+    }
+    int h0 = cbst_check(cbst_child(n, 0), lo, k, balanced, leaves);
+    int h1 = cbst_check(cbst_child(n, 1), k, hi, balanced, leaves);
+    int h = (h0 > h1 ? h0 : h1) + 1;
+    if (balanced) assert(cbst_height(n) == h && h0 - h1 <= 1 && h1 - h0 <= 1);
+    return h;
+}
+
+static int cbst_check_tree(CBST *t, bool balanced) {
+    size_t leaves = 0;
+    int h = cbst_check(cbst_child(t->root, 0), 0, cbst_key_of(t->root), balanced, &leaves);
+    assert(cbst_child(t->root, 1)->inf == 2 && leaves == cbst_size(t));
+    return h;
+}
+
+/* Same ownership scheme as the concurrent skip list test; values are key * 3. */
+typedef struct {
+    CBST *t;
+    int id;
+    char *present;
+} CBSTArgs;
+
+static void *cbst_worker(void *arg) {
+    CBSTArgs *a = (CBSTArgs *)arg;
+    EpochThread *th = cbst_register(a->t);
+    uint64_t seed = 300 + (uint64_t)a->id;
+    for (int i = 0; i < SET_OPS; ++i) {
+        uint64_t r = test_rand(&seed);
+        uintptr_t k = 1 + (uintptr_t)(r % SET_KEYS);
+        if (k % TEST_THREADS != (uintptr_t)a->id) {
+            void *v = cbst_get(a->t, th, UKEY(k));
+            assert(!v || v == UKEY(k * 3));
+            if (i % 64 == 0) {
+                uintptr_t walk[2] = { 0, 0 };
+                cbst_range(a->t, th, UKEY(k), UKEY(k + 256), count_key, walk);
+            }
+            continue;
+        }
+        if (r & (1u << 20)) {
+            assert(cbst_insert(a->t, th, UKEY(k), UKEY(k * 3)) == !a->present[k]);
+            a->present[k] = 1;
+        } else {
+            assert(cbst_remove(a->t, th, UKEY(k)) == a->present[k]);
+            a->present[k] = 0;
+        }
+        assert(cbst_get(a->t, th, UKEY(k)) == (a->present[k] ? UKEY(k * 3) : NULL));
+    }
+    cbst_unregister(th);
+    return NULL;
+}
+
+static void test_concurrent_tree(void) {
+    static char ref[TREE_KEYS + 2];
+    static uintptr_t values[TREE_KEYS + 2];
+    memset(ref, 0, sizeof(ref));
+    CBST *t = cbst_create(cmp_uint, NULL, NULL);
+    EpochThread *th = cbst_register(t);
+    size_t size = 0;
+    uint64_t seed = 30;
+    for (int i = 0; i < 40000; ++i) {
+        uintptr_t k = 1 + (uintptr_t)(test_rand(&seed) % TREE_KEYS);
+        if (i % 3) {
+            assert(cbst_insert(t, th, UKEY(k), UKEY(k + i)) == !ref[k]);
+            assert(cbst_get(t, th, UKEY(k)) == UKEY(k + i));
+            size += !ref[k];
+            ref[k] = 1;
+            values[k] = k + i;
+        } else {
+            assert(cbst_remove(t, th, UKEY(k)) == ref[k]);
+            assert(!cbst_contains(t, th, UKEY(k)));
+            size -= ref[k];
+            ref[k] = 0;
+        }
+        assert(cbst_size(t) == size);
+        if (i % 4096 == 0) cbst_check_tree(t, true);
+    }
+    cbst_check_tree(t, true);
+    for (uintptr_t k = 0; k <= TREE_KEYS + 1; ++k) {
+        assert(cbst_get(t, th, UKEY(k)) == (ref[k] ? UKEY(values[k]) : NULL));
+    }
+    uintptr_t walk[2] = { 0, 0 };
+    cbst_inorder(t, th, count_key, walk);
+    assert(walk[1] == size);
+    for (uintptr_t lo = 0; lo <= TREE_KEYS; lo += 97) {
+        uintptr_t hi = lo + 300, expect = 0;
+        for (uintptr_t k = lo; k <= hi && k <= TREE_KEYS; ++k) expect += ref[k];
+        walk[0] = walk[1] = 0;
+        assert(cbst_range(t, th, UKEY(lo), UKEY(hi), count_key, walk) == expect && walk[1] == expect);
+    }
+    cbst_unregister(th);
+    cbst_destroy(t);
+
+    /*
+     * Sorted runs stay AVL-shaped, and every key passed to insert is freed
+     * exactly once, whether it was replaced, removed or left for destroy,
+     * however many rotated copies routed by it.
+     */
+    t = cbst_create(cmp_uint, count_free, NULL);
+    th = cbst_register(t);
+    freed_values = 0;
+    for (uintptr_t k = 1; k <= TREE_KEYS; ++k) assert(cbst_insert(t, th, UKEY(k), NULL));
+    int h = cbst_check_tree(t, true);
+    assert(h <= 17);    /* 1.44 * log2(4096) + 1 */
+    for (uintptr_t k = 1; k <= TREE_KEYS; k += 2) assert(!cbst_insert(t, th, UKEY(k), NULL));
+    for (uintptr_t k = TREE_KEYS; k > TREE_KEYS / 2; --k) assert(cbst_remove(t, th, UKEY(k)));
+    cbst_check_tree(t, true);
+    assert(cbst_size(t) == TREE_KEYS / 2);
+    cbst_unregister(th);
+    cbst_destroy(t);
+    assert(freed_values == TREE_KEYS + TREE_KEYS / 2);
+
+    /* Owned keys checked exactly by their writer, everything read by all. */
+    static char present[SET_KEYS + 1];
+    memset(present, 0, sizeof(present));
+    t = cbst_create(cmp_uint, NULL, NULL);
+    pthread_t tid[TEST_THREADS];
+    CBSTArgs args[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; ++i) {
+        args[i] = (CBSTArgs){ t, i, present };
+        pthread_create(&tid[i], NULL, cbst_worker, &args[i]);
+    }
+    for (int i = 0; i < TEST_THREADS; ++i) pthread_join(tid[i], NULL);
+    th = cbst_register(t);
+    size = 0;
+    for (uintptr_t k = 1; k <= SET_KEYS; ++k) {
+        assert(cbst_get(t, th, UKEY(k)) == (present[k] ? UKEY(k * 3) : NULL));
+        size += present[k];
+    }
+    assert(cbst_size(t) == size);
+    cbst_check_tree(t, false);
+    walk[0] = walk[1] = 0;
+    cbst_inorder(t, th, count_key, walk);
+    assert(walk[1] == size);
+    cbst_unregister(th);
+    cbst_destroy(t);
+    test_pass("concurrent_tree");
+}
+
+/*
+ * Balanced tree holding k -> k + offset for every k with ref[k], built
+ * with bst_build_sorted() or, when !built, by single inserts.
+ */
+static BST *join_tree(const char *ref, uintptr_t n, uintptr_t offset, bool built) {
+    void **keys = malloc(n * sizeof(void *)), **values = malloc(n * sizeof(void *));
+    size_t count = 0;
+    for (uintptr_t k = 0; k < n; ++k) {
+        if (!ref[k]) continue;
+        keys[count] = UKEY(k);
+        values[count++] = UKEY(k + offset);
+    }
+    BST *t = built ? bst_build_sorted(cmp_uint, NULL, count_free, keys, values, count)
+                   : bst_create_balanced(cmp_uint, NULL, count_free);
+    assert(t);
+    for (size_t i = 0; !built && i < count; ++i) assert(bst_insert(t, keys[i], values[i]));
+    assert(bst_size(t) == count);
+    bst_check_tree(t);
+    free(keys);
+    free(values);
+    return t;
+}
+
+/* `t` holds exactly the keys k < n with want[k], each mapped to value[k]. */
+static void join_expect(BST *t, const uintptr_t *want, uintptr_t n) {
+    bst_check_tree(t);
+    size_t size = 0;
+    for (uintptr_t k = 0; k < n; ++k) {
+        assert(bst_get(t, UKEY(k)) == (want[k] ? UKEY(want[k]) : NULL));
+        size += want[k] != 0;
+    }
+    assert(bst_size(t) == size);
+}
+
+static void test_tree_join(void) {
+    /* The last size is past BST_PAR_CUTOFF, so the set operations fork. */
+    static const uintptr_t sizes[] = { 64, TREE_KEYS, 1 << 16 };
+    static const int density[][2] = { { 50, 50 }, { 90, 5 }, { 5, 90 }, { 0, 60 }, { 60, 0 } };
+    uint64_t seed = 50;
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        uintptr_t n = sizes[si];
+        char *in_a = malloc(n), *in_b = malloc(n);
+        uintptr_t *want = malloc(n * sizeof(uintptr_t));
+        for (size_t di = 0; di < sizeof(density) / sizeof(density[0]); ++di) {
+            if (si == 2 && di) break;
+            size_t na = 0, nb = 0, both = 0;
+            for (uintptr_t k = 0; k < n; ++k) {
+                in_a[k] = k && (int)(test_rand(&seed) % 100) < density[di][0];
+                in_b[k] = k && (int)(test_rand(&seed) % 100) < density[di][1];
+                na += in_a[k];
+                nb += in_b[k];
+                both += in_a[k] && in_b[k];
+            }
+            for (int op = 0; op < 3; ++op) {
+                /* Values tell the trees apart: a's are k + n, b's are k + 2n. */
+                BST *a = join_tree(in_a, n, n, op != 1), *b = join_tree(in_b, n, 2 * n, op != 2);
+                freed_values = 0;
+                for (uintptr_t k = 0; k < n; ++k) {
+                    bool keep = op == 0 ? in_a[k] || in_b[k] : op == 1 ? in_a[k] && in_b[k] : in_a[k] && !in_b[k];
+                    want[k] = keep ? k + (in_a[k] ? n : 2 * n) : 0;
+                }
+                if (op == 0) assert(bst_union(a, b) && freed_values == both);
+                if (op == 1) assert(bst_intersect(a, b) && freed_values == na + nb - both);
+                if (op == 2) assert(bst_difference(a, b) && freed_values == nb + both);
+                assert(bst_size(b) == 0 && !b->root);
+                join_expect(a, want, n);
+                bst_destroy(a);
+                bst_destroy(b);
+            }
+
+            /* Split at keys below, inside and above the set, then join back. */
+            BST *a = join_tree(in_a, n, n, true);
+            for (uintptr_t k = 0; k < n; ++k) want[k] = in_a[k] ? k + n : 0;
+            for (uintptr_t at = 0; at <= n; at += n / 8 + 1) {
+                BST *hi = bst_split(a, UKEY(at));
+                assert(hi && bst_size(a) + bst_size(hi) == na);
+                bst_check_tree(a);
+                bst_check_tree(hi);
+                if (a->root) assert((uintptr_t)bst_last(a)->key < at);
+                if (hi->root) assert((uintptr_t)bst_first(hi)->key >= at);
+                if (a->root && hi->root) assert(!bst_join(hi, a) && bst_size(a) + bst_size(hi) == na);
+                assert(bst_join(a, hi) && bst_size(hi) == 0);
+                join_expect(a, want, n);
+                bst_destroy(hi);
+            }
+            bst_destroy(a);
+        }
+        free(in_a);
+        free(in_b);
+        free(want);
+    }
+
+    /* Unbalanced trees are refused and left alone. */
+    BST *plain = bst_create(cmp_uint, NULL, NULL), *avl = bst_create_balanced(cmp_uint, NULL, NULL);
+    assert(bst_insert(plain, UKEY(1), NULL) && bst_insert(avl, UKEY(2), NULL));
+    assert(!bst_split(plain, UKEY(1)) && !bst_join(plain, avl) && !bst_union(avl, plain));
+    assert(!bst_union(avl, avl));
+    assert(bst_size(plain) == 1 && bst_size(avl) == 1);
+    bst_destroy(plain);
+    bst_destroy(avl);
+
+    /* bst_build_sorted: empty, ascending, and unsorted or repeated input. */
+    void *keys[TREE_KEYS];
+    BST *t = bst_build_sorted(cmp_uint, NULL, NULL, keys, NULL, 0);
+    assert(t && bst_size(t) == 0 && !t->root && t->balanced);
+    bst_destroy(t);
+    for (uintptr_t k = 0; k < TREE_KEYS; ++k) keys[k] = UKEY(2 * k + 1);
+    for (size_t n = 1; n <= TREE_KEYS; n = n * 3 + 1) {
+        t = bst_build_sorted(cmp_uint, NULL, NULL, keys, keys, n);
+        assert(t && t->balanced && bst_size(t) == n);
+        bst_check_tree(t);
+        uintptr_t walk[2] = { 0, 0 };
+        bst_inorder(t, count_key, walk);
+        assert(walk[1] == n && walk[0] == 2 * n - 1);
+        assert(bst_get(t, keys[n / 2]) == keys[n / 2] && !bst_get(t, UKEY(2 * n)));
+        bst_destroy(t);
+    }
+    keys[7] = keys[3];
+    t = bst_build_sorted(cmp_uint, NULL, NULL, keys, NULL, TREE_KEYS);
+    assert(t && bst_size(t) == TREE_KEYS - 1 && !bst_get(t, UKEY(15)));
+    bst_check_tree(t);
+    bst_destroy(t);
+    test_pass("tree_join");
+}
 
 int main() {
     printf("\n=== Dynamic Example ===\n");
@@ -81,5 +2512,31 @@ int main() {
 
     freeList(head);
 
+    printf("\n=== Tests ===\n");
+    test_list_handle();
+    test_list_bulk();
+    test_unrolled_list();
+    test_intrusive_list();
+    test_lf_queue();
+    test_ring_buffer();
+    test_skip_list();
+    test_radix_trie();
+    test_art();
+    test_frozen_trie();
+    test_trie_rank();
+    test_aho_corasick();
+    test_trie_fuzzy();
+    test_trie_bulk();
+    test_concurrent_trie();
+    test_avl();
+    test_bptree();
+    test_bst_range();
+    test_bst_stats();
+    test_typed_tree();
+    test_frozen_tree();
+    test_persistent_tree();
+    test_concurrent_tree();
+    test_tree_join();
+
     return 0;
 }
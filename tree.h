@@ -29,11 +29,36 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/*
+ * Binary search tree keyed by caller-supplied comparison.
+ *
+ * bst_create() gives a plain BST whose shape follows the insertion order.
+ * bst_create_balanced() gives an AVL tree with the same API: every insert
+ * and remove restores |height(left) - height(right)| <= 1, so the height
+ * stays below 1.45 log2(n) even for sorted input. Destruction and in-order
+ * traversal are iterative, so degenerate plain trees do not overflow the
+ * call stack either.
+ *
+ * Nodes keep a parent pointer, so a BSTNode doubles as a cursor:
+ * bst_lower_bound()/bst_first() position it and bst_next()/bst_prev() step
+ * it in O(1) amortized time with no stack. Cursors survive inserts and
+ * removes of other keys: a remove frees only the removed key's own node.
+ *
+ * Each node also counts the nodes in its subtree, which gives O(log n)
+ * bst_rank(), bst_select() and bst_count_range() on balanced trees.
+ */
+
+/* Upper bound on AVL height: a tree this tall would need > 2^64 nodes. */
+#define BST_MAX_HEIGHT 96
+
 typedef struct BSTNode {
     void *key;
     void *value;
     struct BSTNode *left;
     struct BSTNode *right;
+    struct BSTNode *parent;
+    size_t size;                /* nodes in this subtree, itself included */
+    int height;                 /* AVL height; only maintained when balanced */
 } BSTNode;
 
 typedef int (*bst_cmp_fn)(const void *a, const void *b);
@@ -45,6 +70,7 @@ typedef struct BST {
     bst_free_fn free_key;
     bst_free_fn free_value;
     size_t size;
+    bool balanced;
 } BST;
 
 static inline BST *bst_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
@@ -56,16 +82,32 @@ static inline BST *bst_create(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn
     t->free_key = free_key;
     t->free_value = free_value;
     t->size = 0;
+    t->balanced = false;
+    return t;
+}
+
+static inline BST *bst_create_balanced(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value) {
+    BST *t = bst_create(cmp, free_key, free_value);
+    if (t) t->balanced = true;
     return t;
 }
 
+/* Frees the subtree at `n`, flattening it with right rotations as it goes. */
 static inline void bst_free_node(BST *t, BSTNode *n) {
-    if (!n) return;
-    bst_free_node(t, n->left);
-    bst_free_node(t, n->right);
-    if (t->free_key)   t->free_key(n->key);
-    if (t->free_value) t->free_value(n->value);
-    free(n);
+    while (n) {
+        if (n->left) {
+            BSTNode *l = n->left;
+            n->left = l->right;
+            l->right = n;
+            n = l;
+            continue;
+        }
+        BSTNode *next = n->right;
+        if (t->free_key)   t->free_key(n->key);
+        if (t->free_value) t->free_value(n->value);
+        free(n);
+        n = next;
+    }
 }
 
 static inline void bst_destroy(BST *t) {
@@ -76,9 +118,87 @@ static inline void bst_destroy(BST *t) {
 
 static inline size_t bst_size(const BST *t) { return t ? t->size : 0; }
 
+// =======================================
+// AVL rebalancing
+// =======================================
+
+static inline int bst_height(const BSTNode *n) { return n ? n->height : 0; }
+
+static inline size_t bst_subtree_size(const BSTNode *n) { return n ? n->size : 0; }
+
+static inline void bst_update(BSTNode *n) {
+    int hl = bst_height(n->left), hr = bst_height(n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+    n->size = bst_subtree_size(n->left) + bst_subtree_size(n->right) + 1;
+}
+
+static inline BSTNode *bst_rotate_left(BSTNode *n) {
+    BSTNode *r = n->right;
+    n->right = r->left;
+    if (r->left) r->left->parent = n;
+    r->left = n;
+    r->parent = n->parent;
+    n->parent = r;
+    bst_update(n);
+    bst_update(r);
+    return r;
+}
+
+static inline BSTNode *bst_rotate_right(BSTNode *n) {
+    BSTNode *l = n->left;
+    n->left = l->right;
+    if (l->right) l->right->parent = n;
+    l->right = n;
+    l->parent = n->parent;
+    n->parent = l;
+    bst_update(n);
+    bst_update(l);
+    return l;
+}
+
+/* Restores the AVL invariant at `n` and returns the new subtree root. */
+static inline BSTNode *bst_rebalance(BSTNode *n) {
+    bst_update(n);
+    int balance = bst_height(n->left) - bst_height(n->right);
+    if (balance > 1) {
+        if (bst_height(n->left->left) < bst_height(n->left->right)) {
+            n->left = bst_rotate_left(n->left);
+        }
+        return bst_rotate_right(n);
+    }
+    if (balance < -1) {
+        if (bst_height(n->right->right) < bst_height(n->right->left)) {
+            n->right = bst_rotate_right(n->right);
+        }
+        return bst_rotate_left(n);
+    }
+    return n;
+}
+
+/*
+ * Rebalances the nodes behind links path[depth-1] .. path[0], bottom-up.
+ * Stops once a subtree comes out with its old height, since nothing above
+ * it can have changed.
+ */
+static inline void bst_retrace(BSTNode ***path, size_t depth) {
+    while (depth > 0) {
+        BSTNode **link = path[--depth];
+        int before = (*link)->height;
+        *link = bst_rebalance(*link);
+        if ((*link)->height == before) break;
+    }
+}
+
+// =======================================
+// Operations
+// =======================================
+
 static inline bool bst_insert(BST *t, void *key, void *value) {
     if (!t) return false;
+    BSTNode **path[BST_MAX_HEIGHT];
+    size_t depth = 0;
     BSTNode **cur = &t->root;
+    BSTNode *parent = NULL;
     while (*cur) {
         int c = t->cmp(key, (*cur)->key);
         if (c == 0) {
@@ -88,13 +208,20 @@ static inline bool bst_insert(BST *t, void *key, void *value) {
             (*cur)->value = value;
             return false;
         }
+        if (t->balanced) path[depth++] = cur;
+        parent = *cur;
         cur = (c < 0) ? &(*cur)->left : &(*cur)->right;
     }
     BSTNode *n = (BSTNode *)malloc(sizeof(BSTNode));
     if (!n) return false;
     n->key = key; n->value = value; n->left = n->right = NULL;
+    n->parent = parent;
+    n->height = 1;
+    n->size = 1;
     *cur = n;
     t->size++;
+    for (; parent; parent = parent->parent) parent->size++;
+    if (t->balanced) bst_retrace(path, depth);
     return true;
 }
 
@@ -109,53 +236,173 @@ static inline void *bst_get(const BST *t, const void *key) {
     return NULL;
 }
 
-static inline BSTNode *bst_min_with_parent(BSTNode *n, BSTNode **pp) {
-    *pp = NULL;
-    while (n && n->left) { *pp = n; n = n->left; }
-    return n;
-}
-
 static inline bool bst_remove(BST *t, const void *key) {
     if (!t) return false;
+    BSTNode **path[BST_MAX_HEIGHT];
+    size_t depth = 0;
     BSTNode **link = &t->root;
-    BSTNode *parent = NULL;
     while (*link) {
         int c = t->cmp(key, (*link)->key);
         if (c == 0) break;
-        parent = *link;
+        if (t->balanced) path[depth++] = link;
         link = (c < 0) ? &(*link)->left : &(*link)->right;
     }
     BSTNode *target = *link;
     if (!target) return false;
 
     if (target->left && target->right) {
-        BSTNode *ps = NULL;
-        BSTNode *succ = bst_min_with_parent(target->right, &ps);
-        void *tmpk = target->key; void *tmpv = target->value;
-        target->key = succ->key; target->value = succ->value;
-        succ->key = tmpk; succ->value = tmpv;
-        link = (ps ? &ps->left : &target->right);
-        target = *link;
+        /*
+         * Unlink the in-order successor and move that node into target's
+         * place, so every other key keeps its node and cursors on them
+         * stay valid.
+         */
+        BSTNode **target_link = link;
+        size_t at = depth;
+        if (t->balanced) path[depth++] = link;
+        link = &target->right;
+        while ((*link)->left) {
+            if (t->balanced) path[depth++] = link;
+            link = &(*link)->left;
+        }
+        BSTNode *succ = *link;
+        BSTNode *from = succ->parent == target ? succ : succ->parent;
+        *link = succ->right;
+        if (succ->right) succ->right->parent = succ->parent;
+        succ->left = target->left;
+        succ->right = target->right;
+        succ->left->parent = succ;
+        if (succ->right) succ->right->parent = succ;
+        succ->parent = target->parent;
+        succ->height = target->height;
+        succ->size = target->size;
+        *target_link = succ;
+        /* The path went through target->right, which now belongs to succ. */
+        if (t->balanced && depth > at + 1) path[at + 1] = &succ->right;
+        for (BSTNode *p = from; p; p = p->parent) p->size--;
+    } else {
+        BSTNode *child = target->left ? target->left : target->right;
+        if (child) child->parent = target->parent;
+        *link = child;
+        for (BSTNode *p = target->parent; p; p = p->parent) p->size--;
     }
 
-    BSTNode *child = target->left ? target->left : target->right;
-    *link = child;
-
     if (t->free_key)   t->free_key(target->key);
     if (t->free_value) t->free_value(target->value);
     free(target);
     t->size--;
-    (void)parent;
+    if (t->balanced) bst_retrace(path, depth);
     return true;
 }
 
+/* Perfectly balanced subtree over keys[lo, hi); stops early if out of memory. */
+static inline BSTNode *bst_build_range(void *const *keys, void *const *values,
+                                       size_t lo, size_t hi, bool *ok) {
+    if (lo >= hi || !*ok) return NULL;
+    size_t mid = lo + (hi - lo) / 2;
+    BSTNode *n = (BSTNode *)malloc(sizeof(BSTNode));
+    if (!n) { *ok = false; return NULL; }
+    n->key = keys[mid];
+    n->value = values ? values[mid] : NULL;
+    n->parent = NULL;
+    n->left = bst_build_range(keys, values, lo, mid, ok);
+    n->right = bst_build_range(keys, values, mid + 1, hi, ok);
+    if (n->left) n->left->parent = n;
+    if (n->right) n->right->parent = n;
+    bst_update(n);
+    return n;
+}
+
+/*
+ * Builds a balanced tree from `n` strictly ascending keys in O(n), taking
+ * each middle key as the root of its range. Input that is not sorted is
+ * inserted one key at a time instead. `values` may be NULL.
+ */
+static inline BST *bst_build_sorted(bst_cmp_fn cmp, bst_free_fn free_key, bst_free_fn free_value,
+                                    void *const *keys, void *const *values, size_t n) {
+    BST *t = bst_create_balanced(cmp, free_key, free_value);
+    if (!t) return NULL;
+    for (size_t i = 1; i < n; ++i) {
+        if (cmp(keys[i - 1], keys[i]) >= 0) {
+            for (size_t j = 0; j < n; ++j) bst_insert(t, keys[j], values ? values[j] : NULL);
+            return t;
+        }
+    }
+    bool ok = true;
+    t->root = bst_build_range(keys, values, 0, n, &ok);
+    if (!ok) {
+        /* Keys and values still belong to the caller. */
+        t->free_key = NULL;
+        t->free_value = NULL;
+        bst_destroy(t);
+        return NULL;
+    }
+    t->size = n;
+    return t;
+}
+
 typedef void (*bst_visit_fn)(void *key, void *value, void *user);
 
+// =======================================
+// Ordered iteration
+// =======================================
+
+static inline BSTNode *bst_leftmost(BSTNode *n) {
+    while (n && n->left) n = n->left;
+    return n;
+}
+
+static inline BSTNode *bst_rightmost(BSTNode *n) {
+    while (n && n->right) n = n->right;
+    return n;
+}
+
+static inline BSTNode *bst_first(const BST *t) { return t ? bst_leftmost(t->root) : NULL; }
+static inline BSTNode *bst_last(const BST *t) { return t ? bst_rightmost(t->root) : NULL; }
+
+/* In-order successor, or NULL after the last node. */
+static inline BSTNode *bst_next(const BSTNode *n) {
+    if (!n) return NULL;
+    if (n->right) return bst_leftmost(n->right);
+    while (n->parent && n == n->parent->right) n = n->parent;
+    return n->parent;
+}
+
+/* In-order predecessor, or NULL before the first node. */
+static inline BSTNode *bst_prev(const BSTNode *n) {
+    if (!n) return NULL;
+    if (n->left) return bst_rightmost(n->left);
+    while (n->parent && n == n->parent->left) n = n->parent;
+    return n->parent;
+}
+
+/* First node with key >= `key`, or NULL. */
+static inline BSTNode *bst_lower_bound(const BST *t, const void *key) {
+    if (!t) return NULL;
+    BSTNode *cur = t->root, *best = NULL;
+    while (cur) {
+        if (t->cmp(cur->key, key) >= 0) { best = cur; cur = cur->left; }
+        else cur = cur->right;
+    }
+    return best;
+}
+
+/* First node with key > `key`, or NULL. */
+static inline BSTNode *bst_upper_bound(const BST *t, const void *key) {
+    if (!t) return NULL;
+    BSTNode *cur = t->root, *best = NULL;
+    while (cur) {
+        if (t->cmp(cur->key, key) > 0) { best = cur; cur = cur->left; }
+        else cur = cur->right;
+    }
+    return best;
+}
+
+/* In-order walk of the subtree at `n`, following parent links instead of a stack. */
 static inline void bst_inorder_node(BSTNode *n, bst_visit_fn visit, void *user) {
-    if (!n) return;
-    bst_inorder_node(n->left, visit, user);
-    visit(n->key, n->value, user);
-    bst_inorder_node(n->right, visit, user);
+    BSTNode *last = bst_rightmost(n);
+    for (BSTNode *cur = bst_leftmost(n); cur; cur = cur == last ? NULL : bst_next(cur)) {
+        visit(cur->key, cur->value, user);
+    }
 }
 
 static inline void bst_inorder(const BST *t, bst_visit_fn visit, void *user) {
@@ -163,4 +410,65 @@ static inline void bst_inorder(const BST *t, bst_visit_fn visit, void *user) {
     bst_inorder_node(t->root, visit, user);
 }
 
+/*
+ * Visits the entries with lo <= key <= hi in ascending order and returns
+ * how many there were; `visit` may be NULL to just count. Costs one descent
+ * plus O(k) steps for k matches.
+ */
+static inline size_t bst_range(const BST *t, const void *lo, const void *hi,
+                               bst_visit_fn visit, void *user) {
+    size_t count = 0;
+    for (BSTNode *n = bst_lower_bound(t, lo); n && t->cmp(n->key, hi) <= 0; n = bst_next(n)) {
+        if (visit) visit(n->key, n->value, user);
+        count++;
+    }
+    return count;
+}
+
+// =======================================
+// Order statistics
+// =======================================
+
+/* Number of keys < `key`, or <= `key` when `inclusive`. */
+static inline size_t bst_count_below(const BST *t, const void *key, bool inclusive) {
+    size_t count = 0;
+    for (const BSTNode *cur = t->root; cur; ) {
+        int c = t->cmp(cur->key, key);
+        if (c < 0 || (inclusive && c == 0)) {
+            count += bst_subtree_size(cur->left) + 1;
+            cur = cur->right;
+        } else {
+            cur = cur->left;
+        }
+    }
+    return count;
+}
+
+/* Zero-based position `key` has, or would have, in sorted order. */
+static inline size_t bst_rank(const BST *t, const void *key) {
+    return t ? bst_count_below(t, key, false) : 0;
+}
+
+/* Node holding the k-th smallest key (zero-based), or NULL if k >= size. */
+static inline BSTNode *bst_select(const BST *t, size_t k) {
+    if (!t || k >= t->size) return NULL;
+    BSTNode *cur = t->root;
+    for (;;) {
+        size_t left = bst_subtree_size(cur->left);
+        if (k == left) return cur;
+        if (k < left) {
+            cur = cur->left;
+        } else {
+            k -= left + 1;
+            cur = cur->right;
+        }
+    }
+}
+
+/* Number of keys with lo <= key <= hi, without visiting them. */
+static inline size_t bst_count_range(const BST *t, const void *lo, const void *hi) {
+    if (!t || t->cmp(lo, hi) > 0) return 0;
+    return bst_count_below(t, hi, true) - bst_count_below(t, lo, false);
+}
+
 #endif
@@ -0,0 +1,297 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef TREE_JOIN_H
+#define TREE_JOIN_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "tree.h"
+
+/*
+ * Join-based bulk operations on balanced (AVL) BSTs.
+ *
+ * Everything is built on join(l, k, r), which links two AVL trees with all
+ * keys of l < k < all keys of r in O(|height(l) - height(r)|), and split(),
+ * which cuts a tree at a key in O(log n). bst_union(), bst_intersect() and
+ * bst_difference() split one tree by the other's root, recurse on the two
+ * halves and join the results, for O(m log(n/m + 1)) work on trees of
+ * sizes m <= n instead of O(m log n) for a get/insert loop.
+ *
+ * The two recursive halves are independent, so above BST_PAR_CUTOFF nodes
+ * the left half runs on its own thread, up to BST_PAR_DEPTH levels deep
+ * (2^BST_PAR_DEPTH threads). The comparator and free functions are then
+ * called from several threads at once.
+ *
+ * Operations move nodes between trees instead of copying them: the result
+ * is left in `a` and `b` is left empty. Entries that drop out are freed
+ * with the free functions of the tree they came from; on duplicate keys
+ * `a`'s entry is kept. Both trees must be balanced and share a comparator.
+ */
+
+#ifndef BST_PAR_CUTOFF
+#define BST_PAR_CUTOFF (1 << 14)
+#endif
+
+#ifndef BST_PAR_DEPTH
+#define BST_PAR_DEPTH 3
+#endif
+
+// =======================================
+// Join and split
+// =======================================
+
+/* Makes `l` and `r` the children of `n` and refreshes its height and size. */
+static inline BSTNode *bst_attach(BSTNode *n, BSTNode *l, BSTNode *r) {
+    n->left = l;
+    n->right = r;
+    if (l) l->parent = n;
+    if (r) r->parent = n;
+    bst_update(n);
+    return n;
+}
+
+/* join() for height(l) > height(r) + 1: descends l's right spine. */
+static inline BSTNode *bst_join_right(BSTNode *l, BSTNode *k, BSTNode *r) {
+    BSTNode *c = l->right;
+    if (bst_height(c) <= bst_height(r) + 1) {
+        BSTNode *sub = bst_attach(k, c, r);
+        if (bst_height(sub) <= bst_height(l->left) + 1) return bst_attach(l, l->left, sub);
+        bst_attach(l, l->left, bst_rotate_right(sub));
+        return bst_rotate_left(l);
+    }
+    BSTNode *sub = bst_join_right(c, k, r);
+    bst_attach(l, l->left, sub);
+    return bst_height(sub) <= bst_height(l->left) + 1 ? l : bst_rotate_left(l);
+}
+
+static inline BSTNode *bst_join_left(BSTNode *l, BSTNode *k, BSTNode *r) {
+    BSTNode *c = r->left;
+    if (bst_height(c) <= bst_height(l) + 1) {
+        BSTNode *sub = bst_attach(k, l, c);
+        if (bst_height(sub) <= bst_height(r->right) + 1) return bst_attach(r, sub, r->right);
+        bst_attach(r, bst_rotate_left(sub), r->right);
+        return bst_rotate_right(r);
+    }
+    BSTNode *sub = bst_join_left(l, k, c);
+    bst_attach(r, sub, r->right);
+    return bst_height(sub) <= bst_height(r->right) + 1 ? r : bst_rotate_right(r);
+}
+
+/* AVL tree of l, k, r where all keys of l < k->key < all keys of r. */
+static inline BSTNode *bst_join_nodes(BSTNode *l, BSTNode *k, BSTNode *r) {
+    if (bst_height(l) > bst_height(r) + 1) return bst_join_right(l, k, r);
+    if (bst_height(r) > bst_height(l) + 1) return bst_join_left(l, k, r);
+    return bst_attach(k, l, r);
+}
+
+/* Detaches the largest node of `n`; the rest goes to *rest. */
+static inline BSTNode *bst_split_last(BSTNode *n, BSTNode **rest) {
+    if (!n->right) {
+        *rest = n->left;
+        n->left = NULL;
+        return n;
+    }
+    BSTNode *r;
+    BSTNode *last = bst_split_last(n->right, &r);
+    *rest = bst_join_nodes(n->left, n, r);
+    return last;
+}
+
+/* Join without a middle key. */
+static inline BSTNode *bst_join2(BSTNode *l, BSTNode *r) {
+    if (!l) return r;
+    if (!r) return l;
+    BSTNode *rest;
+    BSTNode *k = bst_split_last(l, &rest);
+    return bst_join_nodes(rest, k, r);
+}
+
+/*
+ * Splits `n` into keys < key (*l) and keys > key (*r), and returns the
+ * node holding `key`, detached, or NULL. Subtree roots' parent links are
+ * left for the caller to set.
+ */
+static inline BSTNode *bst_split_node(bst_cmp_fn cmp, BSTNode *n, const void *key,
+                                      BSTNode **l, BSTNode **r) {
+    if (!n) {
+        *l = *r = NULL;
+        return NULL;
+    }
+    int c = cmp(key, n->key);
+    BSTNode *m;
+    if (c == 0) {
+        *l = n->left;
+        *r = n->right;
+        n->left = n->right = NULL;
+        bst_update(n);
+        return n;
+    }
+    if (c < 0) {
+        BSTNode *lr;
+        m = bst_split_node(cmp, n->left, key, l, &lr);
+        *r = bst_join_nodes(lr, n, n->right);
+    } else {
+        BSTNode *rl;
+        m = bst_split_node(cmp, n->right, key, &rl, r);
+        *l = bst_join_nodes(n->left, n, rl);
+    }
+    return m;
+}
+
+static inline void bst_set_root(BST *t, BSTNode *root) {
+    t->root = root;
+    if (root) root->parent = NULL;
+    t->size = bst_subtree_size(root);
+}
+
+/*
+ * Moves the keys >= `key` of `t` into a new tree and returns it; `t`
+ * keeps the keys < `key`. O(log n). NULL if `t` is not balanced or out of
+ * memory, with `t` unchanged.
+ */
+static inline BST *bst_split(BST *t, const void *key) {
+    if (!t || !t->balanced) return NULL;
+    BST *right = bst_create_balanced(t->cmp, t->free_key, t->free_value);
+    if (!right) return NULL;
+    BSTNode *l, *r;
+    BSTNode *m = bst_split_node(t->cmp, t->root, key, &l, &r);
+    if (m) r = bst_join_nodes(NULL, m, r);
+    bst_set_root(t, l);
+    bst_set_root(right, r);
+    return right;
+}
+
+/*
+ * Appends `b` to `a` when every key of `a` is below every key of `b`,
+ * leaving `b` empty. O(log n). False if the ranges overlap or either tree
+ * is not balanced.
+ */
+static inline bool bst_join(BST *a, BST *b) {
+    if (!a || !b || !a->balanced || !b->balanced) return false;
+    if (a->root && b->root && a->cmp(bst_last(a)->key, bst_first(b)->key) >= 0) return false;
+    bst_set_root(a, bst_join2(a->root, b->root));
+    bst_set_root(b, NULL);
+    return true;
+}
+
+// =======================================
+// Set operations
+// =======================================
+
+typedef enum { BST_UNION, BST_INTERSECT, BST_DIFFERENCE } BSTSetOp;
+
+typedef struct BSTSetTask {
+    BST *a, *b;
+    BSTSetOp op;
+    BSTNode *x;                 /* subtree from a */
+    BSTNode *y;                 /* subtree from b */
+    BSTNode *out;
+    int depth;
+} BSTSetTask;
+
+static inline void bst_free_one(BST *t, BSTNode *n) {
+    n->left = n->right = NULL;
+    bst_free_node(t, n);
+}
+
+static inline BSTNode *bst_setop(BST *a, BST *b, BSTSetOp op, BSTNode *x, BSTNode *y, int depth);
+
+static inline void *bst_setop_thread(void *arg) {
+    BSTSetTask *task = (BSTSetTask *)arg;
+    task->out = bst_setop(task->a, task->b, task->op, task->x, task->y, task->depth);
+    return NULL;
+}
+
+/* Runs both halves, the left one on a new thread when they are big enough. */
+static inline void bst_setop_halves(BSTSetTask *left, BSTSetTask *right) {
+    pthread_t tid;
+    size_t work = bst_subtree_size(left->x) + bst_subtree_size(left->y) +
+                  bst_subtree_size(right->x) + bst_subtree_size(right->y);
+    bool forked = left->depth <= BST_PAR_DEPTH && work >= BST_PAR_CUTOFF &&
+                  pthread_create(&tid, NULL, bst_setop_thread, left) == 0;
+    if (!forked) bst_setop_thread(left);
+    bst_setop_thread(right);
+    if (forked) pthread_join(tid, NULL);
+}
+
+static inline BSTNode *bst_setop(BST *a, BST *b, BSTSetOp op, BSTNode *x, BSTNode *y, int depth) {
+    if (!x || !y) {
+        if (op == BST_UNION) return x ? x : y;
+        bst_free_node(b, y);
+        if (op == BST_INTERSECT) { bst_free_node(a, x); x = NULL; }
+        return x;
+    }
+    /* Union and intersection split b by a's root; difference splits a by b's. */
+    BSTNode *pivot = op == BST_DIFFERENCE ? y : x;
+    BSTNode *lo, *hi;
+    BSTNode *m = bst_split_node(a->cmp, op == BST_DIFFERENCE ? x : y, pivot->key, &lo, &hi);
+    BSTSetTask left = { a, b, op, NULL, NULL, NULL, depth + 1 };
+    BSTSetTask right = left;
+    if (op == BST_DIFFERENCE) {
+        left.x = lo;  left.y = y->left;
+        right.x = hi; right.y = y->right;
+    } else {
+        left.x = x->left;  left.y = lo;
+        right.x = x->right; right.y = hi;
+    }
+    bst_setop_halves(&left, &right);
+
+    if (op == BST_UNION) {
+        if (m) bst_free_one(b, m);
+        return bst_join_nodes(left.out, x, right.out);
+    }
+    if (op == BST_INTERSECT) {
+        if (m) {
+            bst_free_one(b, m);
+            return bst_join_nodes(left.out, x, right.out);
+        }
+        bst_free_one(a, x);
+    } else {
+        bst_free_one(b, y);
+        if (m) bst_free_one(a, m);
+    }
+    return bst_join2(left.out, right.out);
+}
+
+static inline bool bst_setop_run(BST *a, BST *b, BSTSetOp op) {
+    if (!a || !b || a == b || !a->balanced || !b->balanced) return false;
+    bst_set_root(a, bst_setop(a, b, op, a->root, b->root, 0));
+    bst_set_root(b, NULL);
+    return true;
+}
+
+/* a = a ∪ b. */
+static inline bool bst_union(BST *a, BST *b) { return bst_setop_run(a, b, BST_UNION); }
+
+/* a = a ∩ b. */
+static inline bool bst_intersect(BST *a, BST *b) { return bst_setop_run(a, b, BST_INTERSECT); }
+
+/* a = a \ b. */
+static inline bool bst_difference(BST *a, BST *b) { return bst_setop_run(a, b, BST_DIFFERENCE); }
+
+#endif
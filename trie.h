@@ -30,6 +30,7 @@
 #include <ctype.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifndef TRIE_ALPHABET
 #define TRIE_ALPHABET 26 /* 'a'..'z' */
@@ -37,18 +38,56 @@
 
 typedef void (*trie_free_fn)(void *p);
 
+struct TrieRank;
+
 typedef struct TrieNode {
     struct TrieNode *child[TRIE_ALPHABET];
     bool terminal;
+    bool pooled;                /* lives in a TrieBlock, not freed on its own */
     void *value;
 } TrieNode;
 
+#ifndef TRIE_BLOCK_NODES
+#define TRIE_BLOCK_NODES 4096
+#endif
+
+/* Contiguous node storage used by trie_build_sorted(). */
+typedef struct TrieBlock {
+    struct TrieBlock *next;
+    size_t used;
+    TrieNode nodes[TRIE_BLOCK_NODES];
+} TrieBlock;
+
 typedef struct Trie {
     TrieNode *root;
     trie_free_fn free_value;
     size_t size;
+    size_t topk;                /* completions cached per node, 0 if unranked */
+    TrieBlock *blocks;
+    TrieNode *teardown;         /* pending nodes of an unfinished trie_destroy_step() */
+    struct TrieRank **ranks;    /* ranked tries only: open-addressed by node */
+    size_t rank_cap, rank_count;
 } Trie;
 
+/*
+ * Per-node autocomplete cache. On a terminal it also holds the word and its
+ * score; `top` lists the best-scoring terminals in the node's subtree
+ * (itself included), best first.
+ */
+typedef struct TrieRank {
+    TrieNode *node;
+    char *word;
+    double score;
+    size_t ntop;
+    struct TrieRank *top[];
+} TrieRank;
+
+typedef struct TrieCompletion {
+    const char *word;
+    double score;
+    void *value;
+} TrieCompletion;
+
 static inline TrieNode *trie_new_node(void) {
     TrieNode *n = (TrieNode *)calloc(1, sizeof(TrieNode));
     return n;
@@ -61,20 +100,162 @@ static inline Trie *trie_create(trie_free_fn free_value) {
     if (!t->root) { free(t); return NULL; }
     t->free_value = free_value;
     t->size = 0;
+    t->topk = 0;
+    t->blocks = NULL;
+    t->teardown = NULL;
+    t->ranks = NULL;
+    t->rank_cap = t->rank_count = 0;
     return t;
 }
 
+// =======================================
+// Rank table
+// =======================================
+
+/*
+ * Ranked tries keep each node's TrieRank in a side table keyed by the node
+ * pointer rather than in TrieNode, so unranked tries pay nothing per node.
+ * Linear probing over a power-of-two array, at most half full.
+ */
+static inline size_t trie_rank_home(const Trie *t, const TrieNode *n) {
+    uint64_t h = (uint64_t)(uintptr_t)n * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h ^ (h >> 32)) & (t->rank_cap - 1);
+}
+
+static inline TrieRank *trie_rank_find(const Trie *t, const TrieNode *n) {
+    if (!t->rank_count) return NULL;
+    for (size_t i = trie_rank_home(t, n);; i = (i + 1) & (t->rank_cap - 1)) {
+        TrieRank *r = t->ranks[i];
+        if (!r || r->node == n) return r;
+    }
+}
+
+static inline bool trie_rank_add(Trie *t, TrieRank *r) {
+    if (2 * (t->rank_count + 1) > t->rank_cap) {
+        size_t old_cap = t->rank_cap, cap = old_cap ? old_cap * 2 : 64;
+        TrieRank **old = t->ranks;
+        TrieRank **ranks = (TrieRank **)calloc(cap, sizeof(TrieRank *));
+        if (!ranks) return false;
+        t->ranks = ranks;
+        t->rank_cap = cap;
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (!old[i]) continue;
+            size_t j = trie_rank_home(t, old[i]->node);
+            while (ranks[j]) j = (j + 1) & (cap - 1);
+            ranks[j] = old[i];
+        }
+        free(old);
+    }
+    size_t i = trie_rank_home(t, r->node);
+    while (t->ranks[i]) i = (i + 1) & (t->rank_cap - 1);
+    t->ranks[i] = r;
+    t->rank_count++;
+    return true;
+}
+
+/* Frees n's entry, if any, shifting later probes back into the hole. */
+static inline void trie_rank_drop(Trie *t, const TrieNode *n) {
+    if (!t->rank_count) return;
+    size_t mask = t->rank_cap - 1, i = trie_rank_home(t, n);
+    while (t->ranks[i] && t->ranks[i]->node != n) i = (i + 1) & mask;
+    if (!t->ranks[i]) return;
+    free(t->ranks[i]->word);
+    free(t->ranks[i]);
+    t->rank_count--;
+    for (size_t j = i;;) {
+        t->ranks[i] = NULL;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!t->ranks[j]) return;
+            size_t home = trie_rank_home(t, t->ranks[j]->node);
+            /* Entry j may move to i unless its home lies cyclically in (i, j]. */
+            if (i <= j ? (home <= i || home > j) : (home <= i && home > j)) break;
+        }
+        t->ranks[i] = t->ranks[j];
+        i = j;
+    }
+}
+
+static inline void trie_rank_clear(Trie *t) {
+    for (size_t i = 0; i < t->rank_cap; ++i) {
+        if (!t->ranks[i]) continue;
+        free(t->ranks[i]->word);
+        free(t->ranks[i]);
+    }
+    free(t->ranks);
+    t->ranks = NULL;
+    t->rank_cap = t->rank_count = 0;
+}
+
+/* Frees one node whose children have already been detached. */
+static inline void trie_release_node(Trie *t, TrieNode *n) {
+    trie_rank_drop(t, n);
+    if (!n->pooled) free(n);
+}
+
+/*
+ * Moves `n` onto the teardown list. Its value is released first, because the
+ * value field is then reused as the list link.
+ */
+static inline void trie_teardown_push(Trie *t, TrieNode *n) {
+    if (n->terminal && t->free_value) t->free_value(n->value);
+    n->terminal = false;
+    n->value = t->teardown;
+    t->teardown = n;
+}
+
+/* Frees up to `budget` nodes from the teardown list; returns how many. */
+static inline size_t trie_teardown_run(Trie *t, size_t budget) {
+    size_t freed = 0;
+    while (t->teardown && freed < budget) {
+        TrieNode *n = t->teardown;
+        t->teardown = (TrieNode *)n->value;
+        for (int i = 0; i < TRIE_ALPHABET; ++i) {
+            if (n->child[i]) trie_teardown_push(t, n->child[i]);
+        }
+        trie_release_node(t, n);
+        freed++;
+    }
+    return freed;
+}
+
+/* Frees the subtree rooted at `n` without recursion. */
 static inline void trie_free_node(Trie *t, TrieNode *n) {
     if (!n) return;
-    for (int i = 0; i < TRIE_ALPHABET; ++i) trie_free_node(t, n->child[i]);
-    if (n->terminal && t->free_value) t->free_value(n->value);
-    free(n);
+    TrieNode *pending = t->teardown;
+    t->teardown = NULL;
+    trie_teardown_push(t, n);
+    trie_teardown_run(t, (size_t)-1);
+    t->teardown = pending;
 }
 
-static inline void trie_destroy(Trie *t) {
-    if (!t) return;
-    trie_free_node(t, t->root);
+/*
+ * Incremental teardown: frees at most `budget` nodes per call so a large trie
+ * can be released in bounded time slices. The first call detaches the whole
+ * trie, after which it may only be passed to further trie_destroy_step()
+ * calls. Returns true once everything, including `t`, has been freed.
+ */
+static inline bool trie_destroy_step(Trie *t, size_t budget) {
+    if (!t) return true;
+    if (t->root) {
+        trie_rank_clear(t);
+        trie_teardown_push(t, t->root);
+        t->root = NULL;
+        t->size = 0;
+    }
+    trie_teardown_run(t, budget);
+    if (t->teardown) return false;
+    while (t->blocks) {
+        TrieBlock *next = t->blocks->next;
+        free(t->blocks);
+        t->blocks = next;
+    }
     free(t);
+    return true;
+}
+
+static inline void trie_destroy(Trie *t) {
+    trie_destroy_step(t, (size_t)-1);
 }
 
 static inline int trie_idx(char ch) {
@@ -83,26 +264,36 @@ static inline int trie_idx(char ch) {
     return (int)(ch - 'a');
 }
 
-static inline bool trie_insert(Trie *t, const char *word, void *value) {
-    if (!t || !word) return false;
+static inline bool trie_rerank(Trie *t, const char *word, const TrieNode *scored, double score);
+
+/* Stores `value` at `word` and returns its node, or NULL on allocation failure. */
+static inline TrieNode *trie_put(Trie *t, const char *word, void *value, bool *added) {
     TrieNode *cur = t->root;
     for (const char *p = word; *p; ++p) {
         int id = trie_idx(*p);
         if (id < 0) continue;
         if (!cur->child[id]) cur->child[id] = trie_new_node();
-        if (!cur->child[id]) return false;
+        if (!cur->child[id]) return NULL;
         cur = cur->child[id];
     }
-    if (!cur->terminal) {
+    *added = !cur->terminal;
+    if (*added) {
         cur->terminal = true;
-        cur->value = value;
         t->size++;
-        return true;
-    } else {
-        if (t->free_value) t->free_value(cur->value);
-        cur->value = value;
-        return false;
+    } else if (t->free_value) {
+        t->free_value(cur->value);
     }
+    cur->value = value;
+    return cur;
+}
+
+static inline bool trie_insert(Trie *t, const char *word, void *value) {
+    if (!t || !word) return false;
+    bool added;
+    TrieNode *n = trie_put(t, word, value, &added);
+    if (!n) return false;
+    if (t->topk && added) trie_rerank(t, word, n, 0.0);
+    return added;
 }
 
 static inline bool trie_contains(const Trie *t, const char *word) {
@@ -175,12 +366,490 @@ static inline bool trie_remove(Trie *t, const char *word) {
         }
         if (!child->terminal && !has_child) {
             parent->child[stack_idx[i]] = NULL;
-            free(child);
+            trie_release_node(t, child);
         } else break;
     }
+    if (t->topk) trie_rerank(t, word, NULL, 0.0);
     return true;
 }
 
 static inline size_t trie_size(const Trie *t) { return t ? t->size : 0; }
 
+// =======================================
+// Bulk loading
+// =======================================
+
+static inline TrieNode *trie_block_node(Trie *t) {
+    TrieBlock *b = t->blocks;
+    if (!b || b->used == TRIE_BLOCK_NODES) {
+        b = (TrieBlock *)calloc(1, sizeof(TrieBlock));
+        if (!b) return NULL;
+        b->next = t->blocks;
+        t->blocks = b;
+    }
+    TrieNode *n = &b->nodes[b->used++];
+    n->pooled = true;
+    return n;
+}
+
+/*
+ * Builds a trie from `n` words in one pass, taking nodes from contiguous
+ * blocks instead of one calloc each. With sorted input each word only walks
+ * the part it does not share with the previous one; unsorted input and
+ * duplicates still work, just with more walking. `values` may be NULL.
+ * Pooled nodes removed later are reclaimed when the trie is destroyed.
+ */
+static inline Trie *trie_build_sorted(const char *const *words, void *const *values, size_t n,
+                                      trie_free_fn free_value) {
+    Trie *t = (Trie *)calloc(1, sizeof(Trie));
+    if (!t) return NULL;
+    t->free_value = free_value;
+    t->root = trie_block_node(t);
+    if (!t->root) { free(t); return NULL; }
+
+    /* path[d] is the node after d letters of the previous word. */
+    size_t cap = 64, prev_len = 0;
+    TrieNode **path = (TrieNode **)malloc(cap * sizeof(TrieNode *));
+    char *prev = (char *)malloc(cap);
+    if (!path || !prev) goto fail;
+    path[0] = t->root;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!words[i]) continue;
+        size_t d = 0;
+        bool shared = true;
+        for (const char *p = words[i]; *p; ++p) {
+            int id = trie_idx(*p);
+            if (id < 0) continue;
+            if (d + 1 >= cap) {
+                cap *= 2;
+                TrieNode **gp = (TrieNode **)realloc(path, cap * sizeof(TrieNode *));
+                if (!gp) goto fail;
+                path = gp;
+                char *gc = (char *)realloc(prev, cap);
+                if (!gc) goto fail;
+                prev = gc;
+            }
+            shared = shared && d < prev_len && prev[d] == (char)id;
+            if (!shared) {
+                TrieNode *cur = path[d];
+                if (!cur->child[id]) {
+                    cur->child[id] = trie_block_node(t);
+                    if (!cur->child[id]) goto fail;
+                }
+                path[d + 1] = cur->child[id];
+                prev[d] = (char)id;
+            }
+            d++;
+        }
+        prev_len = d;
+        TrieNode *end = path[d];
+        void *value = values ? values[i] : NULL;
+        if (end->terminal) {
+            if (free_value) free_value(end->value);
+        } else {
+            end->terminal = true;
+            t->size++;
+        }
+        end->value = value;
+    }
+    free(path);
+    free(prev);
+    return t;
+
+fail:
+    free(path);
+    free(prev);
+    trie_destroy(t);
+    return NULL;
+}
+
+// =======================================
+// Prefix iteration
+// =======================================
+
+/*
+ * Streams the words under a prefix in lexicographic order using an explicit
+ * stack. The word returned by trie_iter_next() is the folded form (lowercase
+ * letters only) and stays valid until the next call. The trie must not be
+ * modified while an iterator is live.
+ */
+typedef struct TrieIter {
+    const TrieNode **nodes;
+    int *next;          /* next child to visit per level, -1 before the node itself */
+    size_t depth, cap;
+    char *word;
+    size_t prefix_len;
+} TrieIter;
+
+static inline bool trie_iter_reserve(TrieIter *it, size_t depth) {
+    if (depth < it->cap) return true;
+    size_t cap = it->cap ? it->cap * 2 : 16;
+    while (cap <= depth) cap *= 2;
+    const TrieNode **nodes = (const TrieNode **)realloc(it->nodes, cap * sizeof(*nodes));
+    if (!nodes) return false;
+    it->nodes = nodes;
+    int *next = (int *)realloc(it->next, cap * sizeof(*next));
+    if (!next) return false;
+    it->next = next;
+    char *word = (char *)realloc(it->word, it->prefix_len + cap + 1);
+    if (!word) return false;
+    it->word = word;
+    it->cap = cap;
+    return true;
+}
+
+/* Positions `it` at `prefix`. Returns false only on allocation failure. */
+static inline bool trie_iter_init(TrieIter *it, const Trie *t, const char *prefix) {
+    memset(it, 0, sizeof(*it));
+    if (!t) return true;
+    if (!prefix) prefix = "";
+    const TrieNode *cur = t->root;
+    size_t len = 0;
+    for (const char *p = prefix; *p; ++p) len += trie_idx(*p) >= 0;
+    it->prefix_len = len;
+    if (!trie_iter_reserve(it, 0)) return false;
+    len = 0;
+    for (const char *p = prefix; *p && cur; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        it->word[len++] = (char)('a' + id);
+        cur = cur->child[id];
+    }
+    if (!cur) return true;
+    it->nodes[0] = cur;
+    it->next[0] = -1;
+    it->depth = 1;
+    return true;
+}
+
+static inline bool trie_iter_next(TrieIter *it, const char **word, void **value) {
+    while (it->depth) {
+        size_t top = it->depth - 1;
+        const TrieNode *n = it->nodes[top];
+        int i = it->next[top];
+        if (i < 0) {
+            it->next[top] = 0;
+            if (n->terminal) {
+                it->word[it->prefix_len + top] = '\0';
+                if (word) *word = it->word;
+                if (value) *value = n->value;
+                return true;
+            }
+            continue;
+        }
+        while (i < TRIE_ALPHABET && !n->child[i]) i++;
+        if (i == TRIE_ALPHABET) {
+            it->depth--;
+            continue;
+        }
+        it->next[top] = i + 1;
+        if (!trie_iter_reserve(it, it->depth)) return false;
+        it->word[it->prefix_len + top] = (char)('a' + i);
+        it->nodes[it->depth] = n->child[i];
+        it->next[it->depth] = -1;
+        it->depth++;
+    }
+    return false;
+}
+
+static inline void trie_iter_destroy(TrieIter *it) {
+    free(it->nodes);
+    free(it->next);
+    free(it->word);
+    memset(it, 0, sizeof(*it));
+}
+
+// =======================================
+// Fuzzy search
+// =======================================
+
+/* Called per match with its folded word; return false to stop the search. */
+typedef bool (*trie_fuzzy_fn)(const char *word, size_t dist, void *value, void *user);
+
+/*
+ * Fills `row` (len + 1 cells) for one more trie letter `c` at depth `depth`,
+ * given the row of its parent. Only the diagonal band of width 2 * max_dist
+ * can stay within the bound; everything else is clamped to max_dist + 1.
+ * Returns the row minimum.
+ */
+static inline size_t trie_fuzzy_row(const size_t *prev, size_t *row, const char *q, size_t len,
+                                    size_t depth, char c, size_t max_dist) {
+    size_t over = max_dist + 1;
+    size_t lo = depth > max_dist ? depth - max_dist : 1;
+    size_t hi = depth + max_dist < len ? depth + max_dist : len;
+    row[0] = depth < over ? depth : over;
+    size_t best = row[0];
+    for (size_t j = 1; j <= len; ++j) {
+        size_t v = over;
+        if (j >= lo && j <= hi) {
+            size_t sub = prev[j - 1] + (q[j - 1] != c);
+            size_t del = prev[j] + 1;
+            size_t ins = row[j - 1] + 1;
+            v = sub < del ? sub : del;
+            if (ins < v) v = ins;
+            if (v > over) v = over;
+        }
+        row[j] = v;
+        if (v < best) best = v;
+    }
+    return best;
+}
+
+/*
+ * Grows the per-level buffers of trie_fuzzy_search() to at least `need`
+ * levels, each row `width` cells. False if out of memory or if the row
+ * array would not fit in size_t; the buffers stay valid either way.
+ */
+static inline bool trie_fuzzy_grow(size_t need, size_t width, size_t *cap, char **buf,
+                                   size_t **rows, const TrieNode ***nodes, int **next) {
+    size_t n = *cap ? *cap : 16;
+    while (n < need) n = n > SIZE_MAX / 2 ? need : n * 2;
+    if (n > SIZE_MAX / sizeof(size_t) / width || n > SIZE_MAX / sizeof(**nodes)) return false;
+    char *b = (char *)realloc(*buf, n);
+    if (!b) return false;
+    *buf = b;
+    size_t *r = (size_t *)realloc(*rows, n * width * sizeof(size_t));
+    if (!r) return false;
+    *rows = r;
+    const TrieNode **nd = (const TrieNode **)realloc((void *)*nodes, n * sizeof(**nodes));
+    if (!nd) return false;
+    *nodes = nd;
+    int *nx = (int *)realloc(*next, n * sizeof(int));
+    if (!nx) return false;
+    *next = nx;
+    *cap = n;
+    return true;
+}
+
+/*
+ * Reports every word within Levenshtein distance `max_dist` of `word`.
+ * The trie is walked depth-first with one DP row per level. A subtree is
+ * skipped as soon as its row minimum exceeds `max_dist`, so only the part
+ * of the trie near the query is visited. Words are compared in folded form,
+ * as trie_idx() sees them. Returns the number of matches reported, or
+ * (size_t)-1 on allocation failure.
+ */
+static inline size_t trie_fuzzy_search(const Trie *t, const char *word, size_t max_dist,
+                                       trie_fuzzy_fn cb, void *user) {
+    if (!t || !word) return 0;
+    size_t len = 0;
+    for (const char *p = word; *p; ++p) len += trie_idx(*p) >= 0;
+    /*
+     * A distance never exceeds the longer of the two words, and no word in
+     * memory reaches SIZE_MAX / 4 letters, so larger bounds mean the same
+     * and capping keeps max_dist + 1 and depth + max_dist from wrapping.
+     */
+    if (max_dist > SIZE_MAX / 4) max_dist = SIZE_MAX / 4;
+    /* No match can be longer than the query plus the allowed insertions. */
+    size_t max_depth = len + max_dist;
+    size_t width = len + 1;
+
+    /* Per-level buffers grow with the depth actually reached, not max_depth. */
+    char *q = (char *)malloc(len + 1);
+    char *buf = NULL;
+    size_t *rows = NULL;
+    const TrieNode **nodes = NULL;
+    int *next = NULL;
+    size_t cap = 0, found = 0;
+    if (!q || !trie_fuzzy_grow(1, width, &cap, &buf, &rows, &nodes, &next)) {
+        found = (size_t)-1;
+        goto out;
+    }
+
+    len = 0;
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id >= 0) q[len++] = (char)('a' + id);
+    }
+    for (size_t j = 0; j <= len; ++j) rows[j] = j <= max_dist ? j : max_dist + 1;
+    if (t->root->terminal && rows[len] <= max_dist) {
+        buf[0] = '\0';
+        found++;
+        if (cb && !cb(buf, rows[len], t->root->value, user)) goto out;
+    }
+
+    nodes[0] = t->root;
+    next[0] = 0;
+    size_t depth = 1;   /* frames on the stack; the top frame is at trie depth depth - 1 */
+    while (depth) {
+        size_t d = depth - 1;
+        const TrieNode *n = nodes[d];
+        int c = next[d];
+        while (c < TRIE_ALPHABET && !n->child[c]) c++;
+        if (c == TRIE_ALPHABET || d == max_depth) {
+            depth--;
+            continue;
+        }
+        next[d] = c + 1;
+        if (d + 2 > cap && !trie_fuzzy_grow(d + 2, width, &cap, &buf, &rows, &nodes, &next)) {
+            found = (size_t)-1;
+            goto out;
+        }
+        const TrieNode *child = n->child[c];
+        size_t *row = rows + (d + 1) * width;
+        char letter = (char)('a' + c);
+        if (trie_fuzzy_row(rows + d * width, row, q, len, d + 1, letter, max_dist) > max_dist) {
+            continue;
+        }
+        buf[d] = letter;
+        if (child->terminal && row[len] <= max_dist) {
+            buf[d + 1] = '\0';
+            found++;
+            if (cb && !cb(buf, row[len], child->value, user)) goto out;
+        }
+        nodes[d + 1] = child;
+        next[d + 1] = 0;
+        depth++;
+    }
+
+out:
+    free(q);
+    free(buf);
+    free(rows);
+    free((void *)nodes);
+    free(next);
+    return found;
+}
+
+// =======================================
+// Ranked autocomplete
+// =======================================
+
+/*
+ * A ranked trie keeps, in every node, the `k` best-scoring words below it,
+ * so trie_top_k() costs the prefix walk plus copying k entries. Updates
+ * rebuild those lists along the word's path, merging each node's children.
+ */
+static inline Trie *trie_create_ranked(trie_free_fn free_value, size_t k) {
+    Trie *t = trie_create(free_value);
+    if (t) t->topk = k ? k : 1;
+    return t;
+}
+
+/* Orders by score, then word, so equal scores list alphabetically. */
+static inline bool trie_rank_better(const TrieRank *a, const TrieRank *b) {
+    if (a->score != b->score) return a->score > b->score;
+    return strcmp(a->word, b->word) < 0;
+}
+
+static inline void trie_rank_offer(TrieRank *r, size_t k, TrieRank *cand) {
+    if (k == 0) return;
+    if (r->ntop == k && !trie_rank_better(cand, r->top[k - 1])) return;
+    size_t pos = r->ntop < k ? r->ntop++ : k - 1;
+    while (pos > 0 && trie_rank_better(cand, r->top[pos - 1])) {
+        r->top[pos] = r->top[pos - 1];
+        pos--;
+    }
+    r->top[pos] = cand;
+}
+
+/* Rebuilds n's top list from its own word and its children's lists. */
+static inline bool trie_rank_node(Trie *t, TrieNode *n) {
+    TrieRank *r = trie_rank_find(t, n);
+    if (!r) {
+        r = (TrieRank *)calloc(1, sizeof(TrieRank) + t->topk * sizeof(TrieRank *));
+        if (!r) return false;
+        r->node = n;
+        if (!trie_rank_add(t, r)) { free(r); return false; }
+    }
+    r->ntop = 0;
+    if (n->terminal && r->word) trie_rank_offer(r, t->topk, r);
+    for (int c = 0; c < TRIE_ALPHABET; ++c) {
+        const TrieRank *cr = n->child[c] ? trie_rank_find(t, n->child[c]) : NULL;
+        if (!cr) continue;
+        for (size_t i = 0; i < cr->ntop; ++i) {
+            TrieRank *cand = cr->top[i];
+            if (r->ntop == t->topk && !trie_rank_better(cand, r->top[t->topk - 1])) break;
+            trie_rank_offer(r, t->topk, cand);
+        }
+    }
+    return true;
+}
+
+/*
+ * Refreshes the cached lists along `word`'s path, deepest first. If `scored`
+ * is the word's terminal, its stored word and score are (re)set first.
+ */
+static inline bool trie_rerank(Trie *t, const char *word, const TrieNode *scored, double score) {
+    size_t len = strlen(word) + 1;
+    TrieNode *local[256];
+    TrieNode **path = len <= 256 ? local : (TrieNode **)malloc(len * sizeof(TrieNode *));
+    if (!path) return false;
+    size_t depth = 0;
+    TrieNode *cur = t->root;
+    path[depth++] = cur;
+    for (const char *p = word; *p; ++p) {
+        int id = trie_idx(*p);
+        if (id < 0) continue;
+        if (!cur->child[id]) break;
+        cur = cur->child[id];
+        path[depth++] = cur;
+    }
+
+    bool ok = true;
+    TrieRank *r = NULL;
+    if (scored && cur == scored) {
+        if (!trie_rank_node(t, cur)) ok = false;
+        else if (!(r = trie_rank_find(t, cur))->word) {
+            char *folded = (char *)malloc(depth);
+            if (!folded) ok = false;
+            else {
+                size_t i = 0;
+                for (const char *p = word; *p; ++p) {
+                    int id = trie_idx(*p);
+                    if (id >= 0) folded[i++] = (char)('a' + id);
+                }
+                folded[i] = '\0';
+                r->word = folded;
+            }
+        }
+        if (ok) r->score = score;
+    }
+    /* A removed word's node may survive as an inner node: drop its entry. */
+    if (!cur->terminal && (r = trie_rank_find(t, cur))) {
+        free(r->word);
+        r->word = NULL;
+    }
+    for (size_t i = depth; i-- > 0;) {
+        if (!trie_rank_node(t, path[i])) ok = false;
+    }
+    if (path != local) free(path);
+    return ok;
+}
+
+/* Inserts or updates `word` with a ranking score (ranked tries only). */
+static inline bool trie_insert_scored(Trie *t, const char *word, void *value, double score) {
+    if (!t || !word || !t->topk) return false;
+    bool added;
+    TrieNode *n = trie_put(t, word, value, &added);
+    if (!n) return false;
+    trie_rerank(t, word, n, score);
+    return added;
+}
+
+/*
+ * Copies up to `k` best completions of `prefix`, best first, into `out` and
+ * returns how many. At most the trie's configured k are available. The word
+ * pointers stay valid until the trie is modified.
+ */
+static inline size_t trie_top_k(const Trie *t, const char *prefix, size_t k, TrieCompletion *out) {
+    if (!t || !t->topk || !prefix || !out) return 0;
+    const TrieNode *cur = t->root;
+    for (const char *p = prefix; *p && cur; ++p) {
+        int id = trie_idx(*p);
+        if (id >= 0) cur = cur->child[id];
+    }
+    const TrieRank *top = cur ? trie_rank_find(t, cur) : NULL;
+    if (!top) return 0;
+    size_t n = k < top->ntop ? k : top->ntop;
+    for (size_t i = 0; i < n; ++i) {
+        const TrieRank *r = top->top[i];
+        out[i].word = r->word;
+        out[i].score = r->score;
+        out[i].value = r->node->value;
+    }
+    return n;
+}
+
 #endif
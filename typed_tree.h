@@ -0,0 +1,254 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef TYPED_TREE_H
+#define TYPED_TREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Type-specialized AVL tree.
+ *
+ *     DS_BST_DECLARE(IntMap, long, double, (a > b) - (a < b))
+ *
+ * declares `IntMap`, `IntMap_node` and IntMap_create/destroy/size/insert/
+ * get/contains/remove/inorder. Keys and values are stored by value in the
+ * node, and `cmp_expr` is pasted into every search loop. It is an int
+ * expression in the keys `a` and `b`, negative/zero/positive like a
+ * comparator. A lookup thus touches one node per level and makes no
+ * indirect calls.
+ *
+ * The tree is always balanced, so its height is bounded and traversals use
+ * a fixed-size stack. get() returns a pointer to the stored value (NULL if
+ * absent), which stays valid until that key is removed: rotations and
+ * removes relink nodes and never move an entry to another node. Keys and
+ * values need no cleanup beyond free() of the node.
+ *
+ * The AVL steps mirror tree.h's bst_rebalance()/bst_retrace() but are
+ * generated per type: BSTNode rotations also maintain parent pointers and
+ * subtree sizes, which these nodes leave out to stay small.
+ */
+
+#define DS_BST_MAX_HEIGHT 96
+
+#define DS_BST_DECLARE(name, KeyT, ValT, cmp_expr)                                     \
+                                                                                       \
+typedef struct name##_node {                                                           \
+    KeyT key;                                                                          \
+    ValT value;                                                                        \
+    struct name##_node *left;                                                          \
+    struct name##_node *right;                                                         \
+    int height;                                                                        \
+} name##_node;                                                                         \
+                                                                                       \
+typedef struct name {                                                                  \
+    name##_node *root;                                                                 \
+    size_t size;                                                                       \
+} name;                                                                                \
+                                                                                       \
+typedef void (*name##_visit_fn)(KeyT key, ValT *value, void *user);                    \
+                                                                                       \
+static inline int name##_cmp(KeyT a, KeyT b) { return (cmp_expr); }                    \
+                                                                                       \
+static inline name *name##_create(void) {                                              \
+    name *t = (name *)malloc(sizeof(name));                                            \
+    if (!t) return NULL;                                                               \
+    t->root = NULL;                                                                    \
+    t->size = 0;                                                                       \
+    return t;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline void name##_destroy(name *t) {                                           \
+    if (!t) return;                                                                    \
+    name##_node *n = t->root;                                                          \
+    while (n) {                                                                        \
+        if (n->left) {                                                                 \
+            name##_node *l = n->left;                                                  \
+            n->left = l->right;                                                        \
+            l->right = n;                                                              \
+            n = l;                                                                     \
+            continue;                                                                  \
+        }                                                                              \
+        name##_node *next = n->right;                                                  \
+        free(n);                                                                       \
+        n = next;                                                                      \
+    }                                                                                  \
+    free(t);                                                                           \
+}                                                                                      \
+                                                                                       \
+static inline size_t name##_size(const name *t) { return t ? t->size : 0; }            \
+                                                                                       \
+static inline int name##_height(const name##_node *n) { return n ? n->height : 0; }    \
+                                                                                       \
+static inline void name##_update(name##_node *n) {                                     \
+    int hl = name##_height(n->left), hr = name##_height(n->right);                     \
+    n->height = (hl > hr ? hl : hr) + 1;                                               \
+}                                                                                      \
+                                                                                       \
+static inline name##_node *name##_rotate_left(name##_node *n) {                        \
+    name##_node *r = n->right;                                                         \
+    n->right = r->left;                                                                \
+    r->left = n;                                                                       \
+    name##_update(n);                                                                  \
+    name##_update(r);                                                                  \
+    return r;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline name##_node *name##_rotate_right(name##_node *n) {                       \
+    name##_node *l = n->left;                                                          \
+    n->left = l->right;                                                                \
+    l->right = n;                                                                      \
+    name##_update(n);                                                                  \
+    name##_update(l);                                                                  \
+    return l;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline name##_node *name##_rebalance(name##_node *n) {                          \
+    name##_update(n);                                                                  \
+    int balance = name##_height(n->left) - name##_height(n->right);                    \
+    if (balance > 1) {                                                                 \
+        if (name##_height(n->left->left) < name##_height(n->left->right)) {            \
+            n->left = name##_rotate_left(n->left);                                     \
+        }                                                                              \
+        return name##_rotate_right(n);                                                 \
+    }                                                                                  \
+    if (balance < -1) {                                                                \
+        if (name##_height(n->right->right) < name##_height(n->right->left)) {          \
+            n->right = name##_rotate_right(n->right);                                  \
+        }                                                                              \
+        return name##_rotate_left(n);                                                  \
+    }                                                                                  \
+    return n;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline void name##_retrace(name##_node ***path, size_t depth) {                 \
+    while (depth > 0) {                                                                \
+        name##_node **link = path[--depth];                                            \
+        int before = (*link)->height;                                                  \
+        *link = name##_rebalance(*link);                                               \
+        if ((*link)->height == before) break;                                          \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+/* True if the key was new; an existing key gets its value replaced. */                \
+static inline bool name##_insert(name *t, KeyT key, ValT value) {                      \
+    if (!t) return false;                                                              \
+    name##_node **path[DS_BST_MAX_HEIGHT];                                             \
+    size_t depth = 0;                                                                  \
+    name##_node **cur = &t->root;                                                      \
+    while (*cur) {                                                                     \
+        int c = name##_cmp(key, (*cur)->key);                                          \
+        if (c == 0) {                                                                  \
+            (*cur)->value = value;                                                     \
+            return false;                                                              \
+        }                                                                              \
+        path[depth++] = cur;                                                           \
+        cur = (c < 0) ? &(*cur)->left : &(*cur)->right;                                \
+    }                                                                                  \
+    name##_node *n = (name##_node *)malloc(sizeof(name##_node));                       \
+    if (!n) return false;                                                              \
+    n->key = key;                                                                      \
+    n->value = value;                                                                  \
+    n->left = n->right = NULL;                                                         \
+    n->height = 1;                                                                     \
+    *cur = n;                                                                          \
+    t->size++;                                                                         \
+    name##_retrace(path, depth);                                                       \
+    return true;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline ValT *name##_get(const name *t, KeyT key) {                              \
+    name##_node *cur = t ? t->root : NULL;                                             \
+    while (cur) {                                                                      \
+        int c = name##_cmp(key, cur->key);                                             \
+        if (c == 0) return &cur->value;                                                \
+        cur = (c < 0) ? cur->left : cur->right;                                        \
+    }                                                                                  \
+    return NULL;                                                                       \
+}                                                                                      \
+                                                                                       \
+static inline bool name##_contains(const name *t, KeyT key) {                          \
+    return name##_get(t, key) != NULL;                                                 \
+}                                                                                      \
+                                                                                       \
+static inline bool name##_remove(name *t, KeyT key) {                                  \
+    if (!t) return false;                                                              \
+    name##_node **path[DS_BST_MAX_HEIGHT];                                             \
+    size_t depth = 0;                                                                  \
+    name##_node **link = &t->root;                                                     \
+    while (*link) {                                                                    \
+        int c = name##_cmp(key, (*link)->key);                                         \
+        if (c == 0) break;                                                             \
+        path[depth++] = link;                                                          \
+        link = (c < 0) ? &(*link)->left : &(*link)->right;                             \
+    }                                                                                  \
+    name##_node *target = *link;                                                       \
+    if (!target) return false;                                                         \
+    if (target->left && target->right) {                                               \
+        /* Move the successor node into target's place, so no other node's */          \
+        /* key or value moves and get() pointers to them stay valid. */                \
+        name##_node **target_link = link;                                              \
+        size_t at = depth;                                                             \
+        path[depth++] = link;                                                          \
+        link = &target->right;                                                         \
+        while ((*link)->left) {                                                        \
+            path[depth++] = link;                                                      \
+            link = &(*link)->left;                                                     \
+        }                                                                              \
+        name##_node *succ = *link;                                                     \
+        *link = succ->right;                                                           \
+        succ->left = target->left;                                                     \
+        succ->right = target->right;                                                   \
+        succ->height = target->height;                                                 \
+        *target_link = succ;                                                           \
+        if (depth > at + 1) path[at + 1] = &succ->right;                               \
+    } else {                                                                           \
+        *link = target->left ? target->left : target->right;                           \
+    }                                                                                  \
+    free(target);                                                                      \
+    t->size--;                                                                         \
+    name##_retrace(path, depth);                                                       \
+    return true;                                                                       \
+}                                                                                      \
+                                                                                       \
+/* In-order walk; `visit` may update the value but not the tree. */                    \
+static inline void name##_inorder(const name *t, name##_visit_fn visit, void *user) {  \
+    if (!t || !visit) return;                                                          \
+    name##_node *stack[DS_BST_MAX_HEIGHT];                                             \
+    size_t top = 0;                                                                    \
+    name##_node *n = t->root;                                                          \
+    while (n || top) {                                                                 \
+        while (n) {                                                                    \
+            stack[top++] = n;                                                          \
+            n = n->left;                                                               \
+        }                                                                              \
+        n = stack[--top];                                                              \
+        visit(n->key, &n->value, user);                                                \
+        n = n->right;                                                                  \
+    }                                                                                  \
+}
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * MIT License
+
+    Copyright (c) 2024 Abenezer L.
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Unrolled linked list of ints. Each node is one cache line (by default)
+ * holding a block of values plus a fill count, so a sequential scan touches
+ * one line per block instead of one per element.
+ */
+#ifndef UNROLLED_NODE_BYTES
+#define UNROLLED_NODE_BYTES 64
+#endif
+
+#define UNROLLED_CAPACITY \
+    ((UNROLLED_NODE_BYTES - sizeof(void *) - sizeof(int)) / sizeof(int))
+
+typedef struct UnrolledNode {
+    struct UnrolledNode *next;
+    int count;
+    int data[UNROLLED_CAPACITY];
+} UnrolledNode;
+
+_Static_assert(sizeof(UnrolledNode) == UNROLLED_NODE_BYTES,
+               "UNROLLED_NODE_BYTES must leave room for a whole number of ints");
+
+typedef struct UnrolledList {
+    UnrolledNode *head;
+    UnrolledNode *tail;
+    size_t size;
+} UnrolledList;
+
+static inline UnrolledNode *unrolled_new_node(void) {
+    UnrolledNode *n = (UnrolledNode *)aligned_alloc(UNROLLED_NODE_BYTES, sizeof(UnrolledNode));
+    if (!n) return NULL;
+    n->next = NULL;
+    n->count = 0;
+    return n;
+}
+
+static inline void unrolled_list_init(UnrolledList *l) {
+    l->head = l->tail = NULL;
+    l->size = 0;
+}
+
+static inline void unrolled_list_destroy(UnrolledList *l) {
+    UnrolledNode *n = l->head;
+    while (n) {
+        UnrolledNode *next = n->next;
+        free(n);
+        n = next;
+    }
+    unrolled_list_init(l);
+}
+
+static inline size_t unrolled_list_size(const UnrolledList *l) { return l->size; }
+
+static inline bool unrolled_list_push_back(UnrolledList *l, int value) {
+    if (!l->tail || l->tail->count == (int)UNROLLED_CAPACITY) {
+        UnrolledNode *n = unrolled_new_node();
+        if (!n) return false;
+        if (l->tail) l->tail->next = n;
+        else l->head = n;
+        l->tail = n;
+    }
+    l->tail->data[l->tail->count++] = value;
+    l->size++;
+    return true;
+}
+
+/* Finds the node holding element `index` and the offset within it. */
+static inline UnrolledNode *unrolled_locate(const UnrolledList *l, size_t index, int *offset) {
+    UnrolledNode *n = l->head;
+    while (n && index >= (size_t)n->count) {
+        index -= (size_t)n->count;
+        n = n->next;
+    }
+    *offset = (int)index;
+    return n;
+}
+
+static inline bool unrolled_list_get(const UnrolledList *l, size_t index, int *out) {
+    int off;
+    UnrolledNode *n = unrolled_locate(l, index, &off);
+    if (!n) return false;
+    *out = n->data[off];
+    return true;
+}
+
+/* Overwrites the element at `index`; false if `index` is out of range. */
+static inline bool unrolled_list_set(UnrolledList *l, size_t index, int value) {
+    int off;
+    UnrolledNode *n = unrolled_locate(l, index, &off);
+    if (!n) return false;
+    n->data[off] = value;
+    return true;
+}
+
+/*
+ * Inserts `value` so that it ends up at position `index` (index == size
+ * appends). A full node is split in half first, leaving room on both sides.
+ */
+static inline bool unrolled_list_insert(UnrolledList *l, size_t index, int value) {
+    if (index > l->size) return false;
+    if (index == l->size) return unrolled_list_push_back(l, value);
+
+    int off;
+    UnrolledNode *n = unrolled_locate(l, index, &off);
+    if (n->count == (int)UNROLLED_CAPACITY) {
+        UnrolledNode *split = unrolled_new_node();
+        if (!split) return false;
+        int half = n->count / 2;
+        split->count = n->count - half;
+        memcpy(split->data, n->data + half, (size_t)split->count * sizeof(int));
+        n->count = half;
+        split->next = n->next;
+        n->next = split;
+        if (l->tail == n) l->tail = split;
+        if (off > half) {
+            off -= half;
+            n = split;
+        }
+    }
+    memmove(n->data + off + 1, n->data + off, (size_t)(n->count - off) * sizeof(int));
+    n->data[off] = value;
+    n->count++;
+    l->size++;
+    return true;
+}
+
+/*
+ * Keeps nodes at least half full after a removal: merge with the successor
+ * when both fit in one node, otherwise borrow from it.
+ */
+static inline void unrolled_rebalance(UnrolledList *l, UnrolledNode *prev, UnrolledNode *n) {
+    const int min_fill = (int)UNROLLED_CAPACITY / 2;
+    if (n->count == 0) {
+        if (prev) prev->next = n->next;
+        else l->head = n->next;
+        if (l->tail == n) l->tail = prev;
+        free(n);
+        return;
+    }
+    UnrolledNode *next = n->next;
+    if (n->count >= min_fill || !next) return;
+    if (n->count + next->count <= (int)UNROLLED_CAPACITY) {
+        memcpy(n->data + n->count, next->data, (size_t)next->count * sizeof(int));
+        n->count += next->count;
+        n->next = next->next;
+        if (l->tail == next) l->tail = n;
+        free(next);
+    } else {
+        int take = (next->count - n->count) / 2;
+        memcpy(n->data + n->count, next->data, (size_t)take * sizeof(int));
+        n->count += take;
+        next->count -= take;
+        memmove(next->data, next->data + take, (size_t)next->count * sizeof(int));
+    }
+}
+
+static inline bool unrolled_list_remove_at(UnrolledList *l, size_t index, int *out) {
+    if (index >= l->size) return false;
+    UnrolledNode *prev = NULL;
+    UnrolledNode *n = l->head;
+    while (index >= (size_t)n->count) {
+        index -= (size_t)n->count;
+        prev = n;
+        n = n->next;
+    }
+    int off = (int)index;
+    if (out) *out = n->data[off];
+    memmove(n->data + off, n->data + off + 1, (size_t)(n->count - off - 1) * sizeof(int));
+    n->count--;
+    l->size--;
+    unrolled_rebalance(l, prev, n);
+    return true;
+}
+
+/* Returns the offset of `value` inside one block, or -1. */
+static inline int unrolled_block_find(const int *data, int count, int value) {
+    int i = 0;
+#ifdef __SSE2__
+    __m128i needle = _mm_set1_epi32(value);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle)));
+        if (mask) return i + __builtin_ctz((unsigned)mask);
+    }
+#endif
+    for (; i < count; ++i) {
+        if (data[i] == value) return i;
+    }
+    return -1;
+}
+
+/* Stores the position of the first element equal to `value` in *index. */
+static inline bool unrolled_list_find(const UnrolledList *l, int value, size_t *index) {
+    size_t base = 0;
+    for (const UnrolledNode *n = l->head; n; n = n->next) {
+        int off = unrolled_block_find(n->data, n->count, value);
+        if (off >= 0) {
+            if (index) *index = base + (size_t)off;
+            return true;
+        }
+        base += (size_t)n->count;
+    }
+    return false;
+}
+
+static inline bool unrolled_list_remove(UnrolledList *l, int value) {
+    UnrolledNode *prev = NULL;
+    for (UnrolledNode *n = l->head; n; prev = n, n = n->next) {
+        int off = unrolled_block_find(n->data, n->count, value);
+        if (off < 0) continue;
+        memmove(n->data + off, n->data + off + 1, (size_t)(n->count - off - 1) * sizeof(int));
+        n->count--;
+        l->size--;
+        unrolled_rebalance(l, prev, n);
+        return true;
+    }
+    return false;
+}
+
+static inline void unrolled_list_print(const UnrolledList *l) {
+    for (const UnrolledNode *n = l->head; n; n = n->next) {
+        for (int i = 0; i < n->count; ++i) printf("%d -> ", n->data[i]);
+    }
+    printf("NULL\n");
+}
+
+#endif